@@ -0,0 +1,381 @@
+"""
+Usage: python3 generate.py <day> [--seed N] [--scale X | --size N[K|M|G]] [-o file]
+
+Makes inputs for the 2023 puzzles that are as big as you like, in the same
+format as the real `input.txt`s. `--scale 1` is about the size of the real
+input, `--scale 1000` about 1000 times that, and `--size 2G` about 2 gigabytes.
+Writes to stdout if there's no `-o`.
+
+The same day, seed and size always give the same bytes, so a slow run can be
+reproduced on another machine without copying gigabytes around. It's Python,
+so a gigabyte takes a few minutes: make it once and keep it.
+
+Days: 01-trebuchet, 02-cube-conundrum, 05-seeds, 07-camelcards, 08-wasteland,
+09-mirage. See each generator for what it can and can't scale.
+"""
+import argparse
+import itertools
+import random
+import re
+import sys
+from typing import Callable, TextIO, TypeAlias
+
+# Size of each day's real `input.txt` in bytes, which is what `--scale 1` means.
+BASE_BYTES: dict[str, int] = {
+    "01-trebuchet":      21568,
+    "02-cube-conundrum": 10236,
+    "05-seeds":          6207,
+    "07-camelcards":     9893,
+    "08-wasteland":      12207,
+    "09-mirage":         21229,
+}
+
+# Lines are joined and written this many at a time so we don't call `write`
+# for every one of them, nor hold a whole gigabyte in memory.
+CHUNK_LINES: int = 4096
+
+generator: TypeAlias = Callable[[random.Random, int, TextIO], None]
+
+
+def write_lines(out: TextIO, n_bytes: int, make_line: Callable[[int], str]) -> None:
+    """
+    Calls `make_line(i)` for `i = 0, 1, 2...` and writes each result followed by
+    a newline, until at least `n_bytes` have been written. Always writes at
+    least one line.
+    """
+    n_written = 0
+    i = 0
+    while True:
+        chunk: list[str] = []
+        for _ in range(CHUNK_LINES):
+            line = make_line(i)
+            chunk.append(line)
+            n_written += len(line) + 1
+            i += 1
+            if n_written >= n_bytes:
+                break
+        chunk.append("")
+        out.write("\n".join(chunk))
+        if n_written >= n_bytes:
+            return
+
+
+"""
+BEGIN: 01-TREBUCHET -*----------------------------------------------------------
+"""
+
+SPELLED: list[str] = [
+    "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
+]
+LOWERCASE: str = "abcdefghijklmnopqrstuvwxyz"
+DIGITS: str = "123456789"
+HAS_DIGIT: re.Pattern = re.compile("[1-9]")
+
+
+def gen_trebuchet(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    e.g. `two65eightbkgqcsn91qxkfvg`: runs of letters, digits and spelled out
+    digits, with at least 1 real digit per line like the real input, since
+    part 1 has nothing to say about lines without one.
+
+    Runs of letters come from a pool made up front, since picking letters one
+    at a time is most of the cost of a gigabyte of these.
+    """
+    runs = ["".join(rng.choices(LOWERCASE, k=rng.randint(1, 6))) for _ in range(1 << 14)]
+    parts = list(DIGITS) + SPELLED + runs
+    # 35% digits, 30% spelled out, 35% letters, spread evenly within each.
+    weights = [0.35 / len(DIGITS)] * len(DIGITS) + [0.30 / len(SPELLED)] * len(SPELLED) \
+        + [0.35 / len(runs)] * len(runs)
+    cum_weights = list(itertools.accumulate(weights))
+
+    counts = range(1, 9)
+    n_written = 0
+    while n_written < n_bytes:
+        # A whole chunk's worth of parts at once, then cut up into lines.
+        lengths = rng.choices(counts, k=CHUNK_LINES)
+        picked = rng.choices(parts, cum_weights=cum_weights, k=sum(lengths))
+        lines: list[str] = []
+        i = 0
+        for n_length in lengths:
+            line = "".join(picked[i:i + n_length])
+            i += n_length
+            if HAS_DIGIT.search(line) is None:
+                line = rng.choice(DIGITS) + line
+            lines.append(line)
+            n_written += len(line) + 1
+            if n_written >= n_bytes:
+                break
+        lines.append("")
+        out.write("\n".join(lines))
+
+
+"""
+END: 01-TREBUCHET -*------------------------------------------------------------
+"""
+
+"""
+BEGIN: 02-CUBE-CONUNDRUM -*-----------------------------------------------------
+"""
+
+COLORS: list[str] = ["red", "green", "blue"]
+
+
+def gen_cube(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    e.g. `Game 1: 4 red, 1 green, 15 blue; 6 green, 2 red, 10 blue`. Game IDs
+    count up from 1 with no limit, counts are 1 to 20 like the real input.
+    """
+    def make_line(i: int) -> str:
+        sets: list[str] = []
+        for _ in range(rng.randint(1, 6)):
+            colors = rng.sample(COLORS, rng.randint(1, 3))
+            sets.append(", ".join(f"{rng.randint(1, 20)} {color}" for color in colors))
+        return f"Game {i + 1}: " + "; ".join(sets)
+
+    write_lines(out, n_bytes, make_line)
+
+
+"""
+END: 02-CUBE-CONUNDRUM -*-------------------------------------------------------
+"""
+
+"""
+BEGIN: 05-SEEDS -*--------------------------------------------------------------
+"""
+
+CATEGORIES: list[str] = [
+    "seed", "soil", "fertilizer", "water", "light", "temperature", "humidity",
+    "location"
+]
+SEED_LIMIT: int = 1 << 32 # Everything in the real input fits in 32 bits.
+
+
+def gen_seeds(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    A `seeds:` line of start and length pairs, then 7 `X-to-Y map:`s of
+    `destination source length` lines, in the real input's order.
+
+    Each map cuts `[0, 2^32)` into pieces and shuffles them, so no two source
+    ranges overlap and no two destination ranges do either, like the real
+    input. Scaling up makes more, smaller pieces and more seed pairs.
+    """
+    n_scale = max(n_bytes / BASE_BYTES["05-seeds"], 1 / 30)
+    n_pairs = max(1, round(10 * n_scale))
+    n_ranges = max(1, round(30 * n_scale))
+
+    seeds: list[str] = []
+    for _ in range(n_pairs):
+        n_start = rng.randrange(SEED_LIMIT - (1 << 28))
+        seeds.append(f"{n_start} {rng.randint(1, 1 << 28)}")
+    out.write("seeds: " + " ".join(seeds) + "\n")
+
+    for src, dst in zip(CATEGORIES, CATEGORIES[1:]):
+        out.write(f"\n{src}-to-{dst} map:\n")
+        cuts = sorted(rng.sample(range(1, SEED_LIMIT), n_ranges))
+        cuts.append(SEED_LIMIT)
+        pieces = [(n_start, n_stop - n_start) for n_start, n_stop in zip([0] + cuts, cuts)]
+        shuffled = pieces[:]
+        rng.shuffle(shuffled)
+        n_dst = 0
+        lines: list[str] = []
+        for n_src, n_length in shuffled:
+            lines.append(f"{n_dst} {n_src} {n_length}")
+            n_dst += n_length
+        # The real input doesn't map every last number, so neither do we.
+        lines = lines[:n_ranges]
+        rng.shuffle(lines)
+        for i in range(0, len(lines), CHUNK_LINES):
+            out.write("\n".join(lines[i:i + CHUNK_LINES]) + "\n")
+
+
+"""
+END: 05-SEEDS -*----------------------------------------------------------------
+"""
+
+"""
+BEGIN: 07-CAMELCARDS -*---------------------------------------------------------
+"""
+
+CARDS: str = "23456789TJQKA"
+
+
+def gen_camelcards(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    e.g. `9A35J 469`: a hand of 5 cards, then a bid from 1 to 1000. Hands are
+    uniformly random so most are high cards or 1 pair, same as the real input.
+    """
+    def make_line(_: int) -> str:
+        return "".join(rng.choices(CARDS, k=5)) + f" {rng.randint(1, 1000)}"
+
+    write_lines(out, n_bytes, make_line)
+
+
+"""
+END: 07-CAMELCARDS -*-----------------------------------------------------------
+"""
+
+"""
+BEGIN: 08-WASTELAND -*----------------------------------------------------------
+"""
+
+LETTERS: str = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+# Names not ending in 'A' or 'Z', which are only for starts and stops.
+MAX_MIDDLE_NODES: int = 26 * 26 * 24
+N_GHOSTS: int = 6
+
+
+def nearest_primes(n_target: int, n_count: int) -> list[int]:
+    """
+    The first `n_count` primes at or above `n_target`.
+    """
+    primes: list[int] = []
+    n_value = max(n_target, 2)
+    while len(primes) < n_count:
+        if all(n_value % n_divisor != 0 for n_divisor in range(2, int(n_value ** 0.5) + 1)):
+            primes.append(n_value)
+        n_value += 1
+    return primes
+
+
+def gen_wasteland(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    A line of `L`s and `R`s, then nodes like `AAA = (BBB, CCC)`.
+
+    Every node ending in `A` (including `AAA`) starts a cycle with exactly 1
+    node ending in `Z` (`ZZZ` for `AAA`), reached after a prime number of steps
+    no matter which way you turn. Each step has 2 twin nodes with the same
+    children, so the instructions pick which twin you're on. That's the shape
+    of the real input and why the least common multiple answers part 2.
+
+    There are only 26^3 node names, so past about 25x the nodes stop growing
+    and the instruction line takes up the rest.
+    """
+    n_scale = max(n_bytes / BASE_BYTES["08-wasteland"], 1 / 10)
+    # Primes so part 2 is the product of the cycle lengths, like the real one.
+    # Leave room for primes a bit above the cap to still fit.
+    n_length = min(max(3, round(46 * n_scale)), MAX_MIDDLE_NODES // (2 * N_GHOSTS) - 64)
+    lengths = nearest_primes(n_length, N_GHOSTS)
+
+    middles = [a + b + c for a in LETTERS for b in LETTERS for c in LETTERS if c not in "AZ"]
+    rng.shuffle(middles)
+    starts = ["AAA"] + rng.sample([a + b + "A" for a in LETTERS for b in LETTERS if a + b != "AA"], N_GHOSTS - 1)
+    stops = ["ZZZ"] + rng.sample([a + b + "Z" for a in LETTERS for b in LETTERS if a + b != "ZZ"], N_GHOSTS - 1)
+
+    lines: list[str] = []
+    n_used = 0
+    for start, stop, n_steps in zip(starts, stops, lengths):
+        # Twins for steps 1 through `n_steps - 1`, then `stop` at `n_steps`.
+        twins = [(middles[n_used + 2 * i], middles[n_used + 2 * i + 1]) for i in range(n_steps - 1)]
+        n_used += 2 * len(twins)
+        lines.append(f"{start} = ({twins[0][0]}, {twins[0][1]})")
+        for (left, right), (next_left, next_right) in zip(twins, twins[1:]):
+            lines.append(f"{left} = ({next_left}, {next_right})")
+            lines.append(f"{right} = ({next_left}, {next_right})")
+        last_left, last_right = twins[-1]
+        lines.append(f"{last_left} = ({stop}, {stop})")
+        lines.append(f"{last_right} = ({stop}, {stop})")
+        # Same children as `start`, so every lap is as long as the first.
+        lines.append(f"{stop} = ({twins[0][0]}, {twins[0][1]})")
+    rng.shuffle(lines)
+
+    n_nodes = sum(len(line) + 1 for line in lines)
+    n_turns = max(round(263 * n_scale), n_bytes - n_nodes - 2)
+    for i in range(0, n_turns, 1 << 16):
+        out.write("".join(rng.choices("LR", k=min(1 << 16, n_turns - i))))
+    out.write("\n\n")
+    for i in range(0, len(lines), CHUNK_LINES):
+        out.write("\n".join(lines[i:i + CHUNK_LINES]) + "\n")
+
+
+"""
+END: 08-WASTELAND -*------------------------------------------------------------
+"""
+
+"""
+BEGIN: 09-MIRAGE -*-------------------------------------------------------------
+"""
+
+N_READINGS: int = 21
+
+
+def gen_mirage(rng: random.Random, n_bytes: int, out: TextIO) -> None:
+    """
+    e.g. `0 3 6 9 12 15`, but with 21 readings per line. Every line is a
+    polynomial of degree 0 to 10 sampled at 0 through 20, so taking differences
+    always reaches all zeroes, and both extrapolations fit in 64 bits.
+
+    Built from binomial coefficients, `sum(a_k * C(x, k))`, so small `a_k`
+    still give the mix of small and huge readings the real input has.
+    """
+    def make_line(_: int) -> str:
+        n_degree = rng.randint(0, 10)
+        coeffs = [rng.randint(-15, 15) for _ in range(n_degree + 1)]
+        readings: list[str] = []
+        for n_x in range(N_READINGS):
+            n_value = 0
+            n_binomial = 1 # C(n_x, k), starting at k = 0.
+            for k, n_coeff in enumerate(coeffs):
+                n_value += n_coeff * n_binomial
+                n_binomial = n_binomial * (n_x - k) // (k + 1)
+            readings.append(str(n_value))
+        return " ".join(readings)
+
+    write_lines(out, n_bytes, make_line)
+
+
+"""
+END: 09-MIRAGE -*---------------------------------------------------------------
+"""
+
+GENERATORS: dict[str, generator] = {
+    "01-trebuchet":      gen_trebuchet,
+    "02-cube-conundrum": gen_cube,
+    "05-seeds":          gen_seeds,
+    "07-camelcards":     gen_camelcards,
+    "08-wasteland":      gen_wasteland,
+    "09-mirage":         gen_mirage,
+}
+
+
+def generate(day: str, out: TextIO, n_seed: int = 2023, n_bytes: int = 0) -> None:
+    """
+    Writes about `n_bytes` of input for `day` to `out`. Defaults to the size of
+    the real input.
+    """
+    n_bytes = n_bytes if n_bytes > 0 else BASE_BYTES[day]
+    # Seed with the day too, so different days don't share random streams.
+    GENERATORS[day](random.Random(f"{day}:{n_seed}"), n_bytes, out)
+
+
+def parse_size(text: str) -> int:
+    """
+    `"512"`, `"64K"`, `"100M"` or `"2G"` to bytes.
+    """
+    suffixes = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    text = text.strip().upper()
+    if text and text[-1] in suffixes:
+        return int(float(text[:-1]) * suffixes[text[-1]])
+    return int(text)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Generate big 2023 puzzle inputs.")
+    parser.add_argument("day", choices=sorted(GENERATORS))
+    parser.add_argument("--seed", type=int, default=2023)
+    size = parser.add_mutually_exclusive_group()
+    size.add_argument("--scale", type=float, default=1.0, help="multiple of the real input's size")
+    size.add_argument("--size", type=parse_size, help="bytes, with an optional K, M or G suffix")
+    parser.add_argument("-o", "--output", help="file to write, instead of stdout")
+    args = parser.parse_args()
+
+    n_bytes = args.size if args.size else round(BASE_BYTES[args.day] * args.scale)
+    if args.output:
+        with open(args.output, "w", newline="\n") as out:
+            generate(args.day, out, args.seed, n_bytes)
+    else:
+        generate(args.day, sys.stdout, args.seed, n_bytes)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
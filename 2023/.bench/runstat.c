@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE /* wait4 */
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+/**
+ * Usage: runstat <timeout seconds> <output file> <command> [args...]
+ *
+ * Runs `command` with its stdout going to `output file`, then prints
+ * `<seconds> <peak rss in KB> <status>` where status is `ok`, `exit N`,
+ * `signal N` or `timeout`.
+ *
+ * `scaling.py` can't just `wait4` for the solvers itself: a forked child's
+ * peak RSS starts at whatever its parent's was, even after `exec`, so every
+ * solver would look at least as big as the Python interpreter. We're tiny, so
+ * the solver's own number is what comes out.
+ */
+
+#define eprintf(msg) fprintf(stderr, __FILE__ ":%i: " msg "\n", __LINE__)
+
+static pid_t child = 0;
+static volatile sig_atomic_t timed_out = 0;
+
+static void on_alarm(int signo) {
+    (void)signo;
+    timed_out = 1;
+    kill(child, SIGKILL);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <timeout seconds> <output file> <command> [args...]\n", argv[0]);
+        return 2;
+    }
+    unsigned timeout = (unsigned)strtoul(argv[1], NULL, 10);
+    int out = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out == -1) {
+        eprintf("Failed to open output file!");
+        return 2;
+    }
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    child = fork();
+    if (child == -1) {
+        eprintf("Failed to fork!");
+        return 2;
+    } else if (child == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(out, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        execvp(argv[3], &argv[3]);
+        _exit(127);
+    }
+    close(out);
+
+    signal(SIGALRM, on_alarm);
+    alarm(timeout);
+    int status;
+    struct rusage usage;
+    while (wait4(child, &status, 0, &usage) == -1) {
+        // Interrupted by our own alarm, the child is being killed so try again.
+        if (errno != EINTR) {
+            eprintf("Failed to wait for child!");
+            return 2;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    alarm(0);
+
+    double seconds = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%.6f %ld ", seconds, usage.ru_maxrss);
+    if (timed_out) {
+        printf("timeout\n");
+    } else if (WIFSIGNALED(status)) {
+        printf("signal %i\n", WTERMSIG(status));
+    } else if (WEXITSTATUS(status) != 0) {
+        printf("exit %i\n", WEXITSTATUS(status));
+    } else {
+        printf("ok\n");
+    }
+    return 0;
+}
@@ -0,0 +1,388 @@
+"""
+Usage: python3 scaling.py [--scales 1,10,100,1000] [--days 01,02...] [--reps N]
+                          [--seed N] [--timeout SECONDS] [--lua PATH]
+                          [--baseline old.csv] [--out DIR]
+
+Builds every C and C++ solver for the days `generate.py` knows, runs each of
+them, and every Lua solver if there's a `lua` to run them with, on generated
+inputs 1x to 1000x the size of the real ones. For every run we report:
+
+    - Throughput in MB/s of input, from the fastest of `--reps` runs.
+    - Peak resident set size, which is where a container that never gives
+      memory back or grows by too little shows up.
+    - The answer, which should be the same for every solver of the same part
+      at the same size. Those that disagree are marked.
+
+Results go to `DIR/scaling.csv`, and `DIR/scaling.png` if matplotlib is
+installed. Give `--baseline` an older `scaling.csv` to mark anything more than
+`--tolerance` (default 10%) slower or bigger than it was.
+
+Generated inputs are kept in `DIR/inputs` so later runs don't pay for them.
+
+The Lua solvers find the repo by looking for `advent-of-code` in the current
+directory's path, so they only work from a checkout with that name.
+"""
+import argparse
+import csv
+import os
+import shutil
+import subprocess
+import sys
+from dataclasses import dataclass
+from typing import Optional
+
+import generate
+
+BENCH_DIR: str = os.path.dirname(os.path.abspath(__file__))
+YEAR_DIR: str = os.path.dirname(BENCH_DIR)
+REPO_DIR: str = os.path.dirname(YEAR_DIR)
+
+# Runs faster than this are mostly process startup, so their throughput is too
+# noisy to call a regression. Likewise a few hundred KB of RSS is just the
+# loader and libc having a different day.
+MIN_COMPARE_SECONDS: float = 0.05
+MIN_COMPARE_RSS_KB: int = 1024
+
+
+@dataclass
+class solver:
+    day: str
+    part: str
+    lang: str
+    source: str # Relative to the day's directory.
+
+    @property
+    def name(self) -> str:
+        return f"{self.day} {self.part} {self.lang}"
+
+
+SOLVERS: list[solver] = [
+    solver("01-trebuchet",      "part1", "cpp", "cpp/part1.cpp"),
+    solver("01-trebuchet",      "part2", "cpp", "cpp/part2.cpp"),
+    solver("01-trebuchet",      "part1", "c",   "c/part1.c"),
+    solver("01-trebuchet",      "part2", "c",   "c/part2.c"),
+    solver("01-trebuchet",      "part1", "lua", "lua/part1.lua"),
+    solver("01-trebuchet",      "part2", "lua", "lua/part2.lua"),
+    solver("02-cube-conundrum", "part1", "cpp", "cpp/part1.cpp"),
+    solver("02-cube-conundrum", "part2", "cpp", "cpp/part2.cpp"),
+    solver("02-cube-conundrum", "part1", "c",   "c/part1.c"),
+    solver("02-cube-conundrum", "part2", "c",   "c/part2.c"),
+    solver("02-cube-conundrum", "part1", "lua", "lua/part1.lua"),
+    solver("02-cube-conundrum", "part2", "lua", "lua/part2.lua"),
+    solver("05-seeds",          "part1", "lua", "lua/part1.lua"),
+    solver("05-seeds",          "part2", "lua", "lua/part2.lua"),
+    solver("07-camelcards",     "part1", "lua", "lua/part1.lua"),
+    solver("07-camelcards",     "part2", "lua", "lua/part2.lua"),
+    solver("08-wasteland",      "part1", "lua", "lua/part1.lua"),
+    solver("08-wasteland",      "part2", "lua", "lua/part2.lua"),
+    solver("09-mirage",         "part1", "lua", "lua/part1.lua"),
+    solver("09-mirage",         "part2", "lua", "lua/part2.lua"),
+]
+
+
+@dataclass
+class result:
+    name: str
+    scale: int
+    n_bytes: int
+    seconds: float
+    rss_kb: int
+    status: str # "ok", "exit N", "signal N", "timeout" or "build failed".
+    answer: str # Last line of output, e.g. "Final answer: 57346".
+
+    @property
+    def mbps(self) -> float:
+        return self.n_bytes / (1 << 20) / self.seconds if self.seconds > 0 else 0.0
+
+
+"""
+BEGIN: BUILDING -*--------------------------------------------------------------
+"""
+
+def build(sol: solver, bin_dir: str) -> Optional[list[str]]:
+    """
+    Compiles a C or C++ solver with optimizations and returns the command to
+    run it, or `None` if it didn't compile. Lua solvers just need `--lua`.
+    """
+    source = os.path.join(YEAR_DIR, sol.day, sol.source)
+    exe = os.path.join(bin_dir, f"{sol.day}-{sol.part}-{sol.lang}")
+    if sol.lang == "cpp":
+        command = [os.environ.get("CXX", "g++"), "-std=c++17", "-O2", "-pthread", f"-I{REPO_DIR}"]
+    elif sol.lang == "c":
+        command = [os.environ.get("CC", "gcc"), "-std=c11", "-O2", f"-I{YEAR_DIR}"]
+    else:
+        return None
+    command += ["-o", exe, source]
+    done = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if done.returncode != 0:
+        print(f"{sol.name}: build failed\n{done.stderr}", file=sys.stderr)
+        return None
+    return [exe]
+
+
+"""
+END: BUILDING -*----------------------------------------------------------------
+"""
+
+"""
+BEGIN: RUNNING -*---------------------------------------------------------------
+"""
+
+def last_line(path: str) -> str:
+    """
+    The last non-empty line of `path`, without reading all of what may be
+    hundreds of megabytes of output.
+    """
+    with open(path, "rb") as file:
+        file.seek(0, os.SEEK_END)
+        file.seek(max(0, file.tell() - 4096))
+        lines = file.read().decode(errors="replace").splitlines()
+    lines = [line.strip() for line in lines if line.strip()]
+    return lines[-1] if lines else ""
+
+
+def run_once(runstat: str, command: list[str], cwd: str, env: dict[str, str], out_path: str,
+             n_timeout: float) -> tuple[float, int, str]:
+    """
+    Runs `command` once under `runstat`, with its output going to `out_path`.
+    Returns the wall time, peak RSS in kilobytes and a status.
+    """
+    done = subprocess.run([runstat, str(max(1, round(n_timeout))), out_path] + command,
+                          cwd=cwd, env=env, stdout=subprocess.PIPE, text=True)
+    if done.returncode != 0:
+        return 0.0, 0, "runstat failed"
+    seconds, rss_kb, status = done.stdout.split(maxsplit=2)
+    return float(seconds), int(rss_kb), status.strip()
+
+
+def input_path(inputs_dir: str, day: str, n_seed: int, n_scale: int) -> str:
+    """
+    Generates the input for `day` at `n_scale` if it isn't there already.
+    """
+    path = os.path.join(inputs_dir, f"{day}.{n_seed}.{n_scale}x.txt")
+    if not os.path.exists(path):
+        partial = path + ".partial"
+        with open(partial, "w", newline="\n") as out:
+            generate.generate(day, out, n_seed, generate.BASE_BYTES[day] * n_scale)
+        os.replace(partial, path)
+    return path
+
+
+def run_solver(sol: solver, command: list[str], path: str, n_scale: int, args: argparse.Namespace) -> result:
+    """
+    Best time of `args.reps` runs, and the highest RSS of any of them. Gives up
+    on the rest as soon as one fails, since they'll only fail again.
+    """
+    cwd = os.path.join(YEAR_DIR, sol.day, os.path.dirname(sol.source))
+    env = dict(os.environ)
+    env["PWD"] = cwd
+    env["LUA_PATH"] = f"./?.lua;{REPO_DIR}/?.lua;;"
+    out_path = os.path.join(args.out, "last_output.txt")
+    n_best = float("inf")
+    n_rss = 0
+    status = "ok"
+    for _ in range(args.reps):
+        n_seconds, n_kb, status = run_once(args.runstat, command + [path], cwd, env, out_path, args.timeout)
+        n_best = min(n_best, n_seconds)
+        n_rss = max(n_rss, n_kb)
+        if status != "ok":
+            break
+    answer = last_line(out_path) if status == "ok" else ""
+    return result(sol.name, n_scale, os.path.getsize(path), n_best, n_rss, status, answer)
+
+
+"""
+END: RUNNING -*-----------------------------------------------------------------
+"""
+
+"""
+BEGIN: REPORTING -*-------------------------------------------------------------
+"""
+
+def answer_number(answer: str) -> str:
+    """
+    Solvers all word their answers differently, but it's always the last thing
+    on the last line.
+    """
+    words = answer.replace(":", " ").split()
+    return words[-1] if words else ""
+
+
+def mark_disagreements(results: list[result]) -> set[tuple[str, int]]:
+    """
+    The `(name, scale)` of every result whose answer isn't what most solvers
+    of the same day and part said at the same scale.
+    """
+    groups: dict[tuple[str, int], list[result]] = {}
+    for res in results:
+        if res.status == "ok":
+            day, part, _ = res.name.split()
+            groups.setdefault((f"{day} {part}", res.scale), []).append(res)
+    marked: set[tuple[str, int]] = set()
+    for group in groups.values():
+        answers = [answer_number(res.answer) for res in group]
+        majority = max(set(answers), key=answers.count)
+        # Without a majority there's no telling who's right, so mark them all.
+        has_majority = answers.count(majority) * 2 > len(answers)
+        for res, answer in zip(group, answers):
+            if answer != majority or not has_majority:
+                marked.add((res.name, res.scale))
+    return marked
+
+
+def load_baseline(path: str) -> dict[tuple[str, int], tuple[float, int]]:
+    baseline: dict[tuple[str, int], tuple[float, int]] = {}
+    with open(path, newline="") as file:
+        for row in csv.DictReader(file):
+            if row["status"] == "ok":
+                baseline[(row["solver"], int(row["scale"]))] = (float(row["mb_per_s"]), int(row["peak_rss_kb"]))
+    return baseline
+
+
+def find_regressions(results: list[result], baseline: dict[tuple[str, int], tuple[float, int]],
+                     n_tolerance: float) -> dict[tuple[str, int], str]:
+    """
+    Everything slower or bigger than `baseline` by more than `n_tolerance`,
+    e.g. `0.10` for 10%, with what got worse.
+    """
+    regressions: dict[tuple[str, int], str] = {}
+    for res in results:
+        key = (res.name, res.scale)
+        if res.status != "ok" or key not in baseline:
+            continue
+        n_mbps, n_rss = baseline[key]
+        worse: list[str] = []
+        if res.seconds >= MIN_COMPARE_SECONDS and res.mbps < n_mbps * (1 - n_tolerance):
+            worse.append(f"{n_mbps:.1f} -> {res.mbps:.1f} MB/s")
+        if res.rss_kb > n_rss * (1 + n_tolerance) + MIN_COMPARE_RSS_KB:
+            worse.append(f"{n_rss} -> {res.rss_kb} KB")
+        if worse:
+            regressions[key] = ", ".join(worse)
+    return regressions
+
+
+def print_result(res: result, notes: list[str]) -> None:
+    print(f"{res.name:<30} {res.scale:>6}x {res.n_bytes / (1 << 20):>9.2f} MB {res.seconds:>9.3f} s "
+          f"{res.mbps:>9.1f} MB/s {res.rss_kb / 1024:>9.1f} MB  {' '.join([res.status] + notes)}")
+
+
+def write_csv(path: str, results: list[result]) -> None:
+    with open(path, "w", newline="") as file:
+        writer = csv.writer(file)
+        writer.writerow(["solver", "scale", "bytes", "seconds", "mb_per_s", "peak_rss_kb", "status", "answer"])
+        for res in results:
+            writer.writerow([res.name, res.scale, res.n_bytes, f"{res.seconds:.6f}", f"{res.mbps:.3f}",
+                             res.rss_kb, res.status, res.answer])
+
+
+def plot(path: str, results: list[result]) -> bool:
+    """
+    Throughput and peak RSS against input size, one line per solver. Returns
+    `False` if there's no matplotlib to do it with.
+    """
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        return False
+    fig, (ax_mbps, ax_rss) = plt.subplots(1, 2, figsize=(14, 6))
+    names = sorted({res.name for res in results})
+    for name in names:
+        runs = [res for res in results if res.name == name and res.status == "ok"]
+        if not runs:
+            continue
+        sizes = [res.n_bytes / (1 << 20) for res in runs]
+        ax_mbps.plot(sizes, [res.mbps for res in runs], marker="o", label=name)
+        ax_rss.plot(sizes, [res.rss_kb / 1024 for res in runs], marker="o", label=name)
+    for ax, label in ((ax_mbps, "throughput (MB/s)"), (ax_rss, "peak RSS (MB)")):
+        ax.set_xscale("log")
+        ax.set_yscale("log")
+        ax.set_xlabel("input size (MB)")
+        ax.set_ylabel(label)
+        ax.grid(True, which="both", alpha=0.3)
+    ax_rss.legend(fontsize="small")
+    fig.tight_layout()
+    fig.savefig(path)
+    return True
+
+
+"""
+END: REPORTING -*---------------------------------------------------------------
+"""
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Run the 2023 solvers on bigger and bigger inputs.")
+    parser.add_argument("--scales", default="1,10,100,1000")
+    parser.add_argument("--days", default="", help="e.g. 01,08; default is every day")
+    parser.add_argument("--reps", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=2023)
+    parser.add_argument("--timeout", type=float, default=120.0, help="seconds per run")
+    parser.add_argument("--lua", default=shutil.which("lua") or "", help="Lua interpreter, if any")
+    parser.add_argument("--baseline", help="older scaling.csv to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.10)
+    parser.add_argument("--out", default=os.path.join(BENCH_DIR, "out"))
+    args = parser.parse_args()
+    args.reps = max(1, args.reps)
+
+    scales = [int(scale) for scale in args.scales.split(",")]
+    days = [day for day in args.days.split(",") if day]
+    wanted = [sol for sol in SOLVERS if not days or any(sol.day.startswith(day) for day in days)]
+    if not args.lua and any(sol.lang == "lua" for sol in wanted):
+        print("No `lua` found, skipping the Lua solvers. Use --lua to point at one.")
+        wanted = [sol for sol in wanted if sol.lang != "lua"]
+
+    bin_dir = os.path.join(args.out, "bin")
+    inputs_dir = os.path.join(args.out, "inputs")
+    os.makedirs(bin_dir, exist_ok=True)
+    os.makedirs(inputs_dir, exist_ok=True)
+
+    args.runstat = os.path.join(bin_dir, "runstat")
+    runstat_c = os.path.join(BENCH_DIR, "runstat.c")
+    if subprocess.run([os.environ.get("CC", "gcc"), "-O2", "-o", args.runstat, runstat_c]).returncode != 0:
+        print("Could not build runstat.c", file=sys.stderr)
+        return 2
+
+    commands: dict[str, Optional[list[str]]] = {}
+    for sol in wanted:
+        commands[sol.name] = [args.lua, sol.source.split("/")[-1]] if sol.lang == "lua" else build(sol, bin_dir)
+
+    results: list[result] = []
+    for n_scale in scales:
+        for sol in wanted:
+            command = commands[sol.name]
+            if command is None:
+                res = result(sol.name, n_scale, 0, 0.0, 0, "build failed", "")
+            else:
+                path = input_path(inputs_dir, sol.day, args.seed, n_scale)
+                res = run_solver(sol, command, path, n_scale, args)
+            print_result(res, [])
+            results.append(res)
+
+    disagreements = mark_disagreements(results)
+    regressions = find_regressions(results, load_baseline(args.baseline), args.tolerance) if args.baseline else {}
+    if disagreements or regressions:
+        print("\nNeeds a look:")
+        for res in results:
+            key = (res.name, res.scale)
+            notes = []
+            if key in disagreements:
+                notes.append(f"answer disagrees: {res.answer}")
+            if key in regressions:
+                notes.append(f"regressed: {regressions[key]}")
+            if notes:
+                print_result(res, notes)
+
+    csv_path = os.path.join(args.out, "scaling.csv")
+    write_csv(csv_path, results)
+    print(f"\nWrote {csv_path}")
+    png_path = os.path.join(args.out, "scaling.png")
+    if plot(png_path, results):
+        print(f"Wrote {png_path}")
+    else:
+        print("No matplotlib, so no plot. The CSV has everything it would show.")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
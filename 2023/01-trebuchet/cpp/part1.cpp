@@ -1,15 +1,21 @@
 #include <cstdio>
-#include <string>
-#include <fstream>
-#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include <crim/mapped_file.hpp>
+#include <crim/out_buffer.hpp>
+#include <crim/parallel_lines.hpp>
+#include <crim/small_dyarray.tcc>
+#include <crim/trace.hpp>
 
 #define eprintf(msg) std::fprintf(stderr, __FILE__ "%i: " msg "\n", __LINE__) 
 
 // Get the leftmost and rightmost digit in the string `line`.
 // @note Named return value optimization is a thing, so can return container by value!
-int match_numbers(const std::string &line) {
-    // Prolly memory intensive but eh
-    std::vector<int> digits;
+int match_numbers(std::string_view line) {
+    // Lines rarely have more than a handful of digits, so this never allocates
+    crim::small_dyarray<int, 16> digits;
     for (auto &c : line) {
         if (std::isdigit(c)) {
             // Adjust for ASCII encoding, need the integral value represented
@@ -20,30 +26,75 @@ int match_numbers(const std::string &line) {
     if (digits.empty()) {
         return 0;
     }
-    // Even if length == 1, digits.size() = 1 so digits.size() - 1 = 0
-    return (digits[0] * 10) + digits[digits.size() - 1];
+    // Even if length == 1, digits.length() = 1 so digits.length() - 1 = 0
+    return (digits[0] * 10) + digits[digits.length() - 1];
+}
+
+// Lines don't depend on each other, so split the file up between threads.
+// Only the answer gets printed, plus how much each thread got through.
+int solve_parallel(const char *name, int threads) {
+    crim::mapped_file file(name);
+    if (!file.is_open()) {
+        eprintf("Could not open input file!");
+        return 1;
+    }
+    crim::parallel_lines lines(file.view(), threads);
+    long long sum;
+    {
+        crim_trace_scope("solve");
+        sum = lines.map_reduce(0LL, [](std::string_view line) {
+            return static_cast<long long>(match_numbers(line));
+        });
+    }
+    crim_trace_scope("print");
+    lines.print_stats(stderr);
+    std::printf("Final answer: %lld\n", sum);
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
-    // Totally safe
-    const char *name = (argc == 2) ? argv[1] : "../part1.txt";
-    // Open file and test if we actually got a handle
-    std::ifstream file(name);
+    // Usage: part1 [-j threads] [--quiet] [file]
+    const char *name = "../part1.txt";
+    int threads = 0; // 0: the old way, one line at a time with every line echoed.
+    bool quiet = false; // Only print the answer, not every line.
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--quiet") == 0 || std::strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else {
+            name = argv[i];
+        }
+    }
+    // Build with `-DCRIM_TRACE` to see these phases in `crim_trace.json`. The
+    // file is mapped, so reading it happens in "solve" as pages get touched.
+    crim_trace_thread_name("main");
+    if (threads > 0) {
+        return solve_parallel(name, threads);
+    }
+    crim::mapped_file file(name);
     if (!file.is_open()) {
         eprintf("Could not open input file!");
         return 1;
     }
-    // Read one line at a time
-    std::string line;
+    // Same text `printf("%i : %s\t%i\n")` gave, but built up in one buffer
+    // and written out in one go instead of formatting and locking every line.
+    crim::out_buffer out;
+    std::string_view line;
     int count = 1; // line number
-    int sum = 0;
-    // Use std::getline as an iterator of sorts
-    while (std::getline(file, line)) {
-        int first_last = match_numbers(line);
-        std::printf("%i : %s\t%i\n", count++, line.c_str(), first_last);
-        sum += first_last;
-    }
-    std::printf("Final answer: %i\n", sum);
-    file.close();
-    return 0;
+    long long sum = 0; // Same as `solve_parallel()`, big inputs go past `INT_MAX`.
+    {
+        crim_trace_scope("solve");
+        while (file.readline(line)) {
+            int first_last = match_numbers(line);
+            if (!quiet) {
+                out.write_int(count).write(" : ").write(line).put('\t').write_int(first_last).put('\n');
+            }
+            count++;
+            sum += first_last;
+        }
+    }
+    crim_trace_scope("print");
+    out.write("Final answer: ").write_int(sum).put('\n');
+    return out.flush() ? 0 : 1;
 }
@@ -1,12 +1,19 @@
 #include <cstdio>
-#include <string>
-#include <fstream>
-#include <array>
-#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include <crim/mapped_file.hpp>
+#include <crim/out_buffer.hpp>
+#include <crim/multi_matcher.hpp>
+#include <crim/parallel_lines.hpp>
+#include <crim/trace.hpp>
 
 #define eprintf(msg) std::fprintf(stderr, __FILE__ "%i: " msg "\n", __LINE__) 
 
-const std::array<const char*, 9> SPELLINGS = {
+// Built once, then each line is a single pass with no allocations. Overlaps
+// like `twone` and `oneight` come out as two matches, which is what we want.
+const crim::multi_matcher SPELLINGS = {
     "one", 
     "two", 
     "three", 
@@ -18,67 +25,100 @@ const std::array<const char*, 9> SPELLINGS = {
     "nine"
 };
 
-// Linear time operations which, when called in the main algorithm,
-// prolly increases time taken quadratically! But it does work...
-int match_spelling(const std::string &test) {
-    for (size_t i = 0; i < SPELLINGS.size(); i++) {
-        // Of type `const char *const &`
-        auto &spelling = SPELLINGS[i];
-        // Check if `spelling` is a subtring of `test`.
-        if (test.find(spelling) != test.npos) {
-            // Add 1 to get the integral value represented by this word
-            return i + 1;
-        }
-    }
-    return 0;
-}
-
-int match_numbers(const std::string &line) {
-    std::vector<int> digits;
-    std::string test = "";
+int match_numbers(std::string_view line) {
+    int first = -1;
+    int last = 0;
+    // Digits aren't in any spelling, so they send us back to the start.
+    crim::multi_matcher::state_type state = SPELLINGS.start;
     for (const char &c : line) {
+        int value = -1;
+        state = SPELLINGS.step(state, c);
         if (std::isdigit(c)) {
             // Adjust for ASCII encoding, remember: (char)'0' != (int)0
-            digits.push_back(c - '0');
-            test.clear();
-            continue;
-        } 
-        // Implied else: assume everything else is a char LMAO
-        test.push_back(c);
-        int value = match_spelling(test);
-        if (value > 0) {
-            digits.push_back(value);
-            // test = test.substr(test.length() - 1);
-            // Reassign to be the latest char
-            test.clear();
-            test = c;
+            value = c - '0';
+        } else if (SPELLINGS.matched(state)) {
+            // None of the spellings ends with another, so this runs once.
+            SPELLINGS.for_each_match(state, [&value](size_t index) {
+                // Add 1 to get the integral value represented by this word
+                value = static_cast<int>(index) + 1;
+            });
+        }
+        if (value >= 0) {
+            first = (first == -1) ? value : first;
+            last = value;
         }
     }
-    if (digits.empty()) {
+    if (first == -1) {
         return 0;
     }
-    return (digits.at(0) * 10) + digits.at(digits.size() - 1);
+    return (first * 10) + last;
+}
+
+// Lines don't depend on each other, so split the file up between threads.
+// Only the answer gets printed, plus how much each thread got through.
+int solve_parallel(const char *name, int threads) {
+    crim::mapped_file file(name);
+    if (!file.is_open()) {
+        eprintf("Could not open input file!");
+        return 1;
+    }
+    crim::parallel_lines lines(file.view(), threads);
+    long long sum;
+    {
+        crim_trace_scope("solve");
+        sum = lines.map_reduce(0LL, [](std::string_view line) {
+            return static_cast<long long>(match_numbers(line));
+        });
+    }
+    crim_trace_scope("print");
+    lines.print_stats(stderr);
+    std::printf("Calibration Value: %lld\n", sum);
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
-    // Totally safe
-    const char *name = (argc == 2) ? argv[1] : "../part2.txt";
-    // Get file handle and validate it
-    std::ifstream file(name);
+    // Usage: part2 [-j threads] [--quiet] [file]
+    const char *name = "../part2.txt";
+    int threads = 0; // 0: the old way, one line at a time with every line echoed.
+    bool quiet = false; // Only print the answer, not every line.
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--quiet") == 0 || std::strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else {
+            name = argv[i];
+        }
+    }
+    // Build with `-DCRIM_TRACE` to see these phases in `crim_trace.json`. The
+    // file is mapped, so reading it happens in "solve" as pages get touched.
+    crim_trace_thread_name("main");
+    if (threads > 0) {
+        return solve_parallel(name, threads);
+    }
+    crim::mapped_file file(name);
     if (!file.is_open()) {
         eprintf("Could not open input file!");
         return 1;
     }
-    // Read one line at a time
-    std::string line;
+    // Same text `printf("%i : %s\t%i\n")` gave, but built up in one buffer
+    // and written out in one go instead of formatting and locking every line.
+    crim::out_buffer out;
+    std::string_view line;
     int count = 1; // line number
-    int sum = 0;
-    while (std::getline(file, line)) {
-        int digits = match_numbers(line);
-        std::printf("%i : %s\t%i\n", count++, line.c_str(), digits);
-        sum += digits;
+    long long sum = 0; // Same as `solve_parallel()`, big inputs go past `INT_MAX`.
+    {
+        crim_trace_scope("solve");
+        while (file.readline(line)) {
+            int digits = match_numbers(line);
+            if (!quiet) {
+                out.write_int(count).write(" : ").write(line).put('\t').write_int(digits).put('\n');
+            }
+            count++;
+            sum += digits;
+        }
     }
-    std::printf("Calibration Value: %i\n", sum);
-    file.close();
-    return 0;
+    crim_trace_scope("print");
+    out.write("Calibration Value: ").write_int(sum).put('\n');
+    return out.flush() ? 0 : 1;
 }
@@ -1,131 +1,117 @@
+#include <cstdlib>
+
+#include <crim/trace.hpp>
+
 #include "part1.hpp"
 
 using namespace std; // I cannot be bothered to deal with C++'s crap today
 
-// Remove first leading whitespace
-// @warning too lazy to error check lmao
-string trim(string src) {
-    char leading_whitespace = src.find_first_of(' ');
-    if (leading_whitespace == 0) {
-        return src.erase(0, 1);
-    }
-    // No leading whitespace so don't try to erase this index
-    return src;
-}
+// Elf's proposed values
+constexpr uint8_t MAX_RED = 12;
+constexpr uint8_t MAX_GREEN = 13;
+constexpr uint8_t MAX_BLUE = 14;
 
-// Inspired by Lua's `string.sub`, cause C++'s `std::string::substr` is stupid.
-// `std::string::substr` has string length as 2nd argument for some reason...
-// @param start inclusive index.
-// @param stop exclusive index. Defaults to remainder of `source`.
-// @warning No error checking! Good luck!
-string substring(const string &source, size_t start, size_t stop = string::npos) {
-    string sub;
-    for (size_t i = start; i < stop && i < source.length(); i++) {
-        sub.push_back(source.at(i));
+// `fits[i]` is 1 if set `i` could come out of Elf's bag, else 0. Never
+// branches, so the compiler does a vector's worth of sets at a time. The
+// `__restrict` saves it checking whether `fits` overlaps the columns first.
+void check_sets(size_t n_sets, const uint8_t *__restrict red, const uint8_t *__restrict green,
+    const uint8_t *__restrict blue, uint8_t *__restrict fits)
+{
+    auto check = [&](size_t i) {
+        fits[i] = (red[i] <= MAX_RED) & (green[i] <= MAX_GREEN) & (blue[i] <= MAX_BLUE);
+    };
+    // Blocks of exactly 16 so even `-O2` vectorizes it, that only does loops
+    // it doesn't need a scalar leftover loop for.
+    size_t i = 0;
+    for (; i + 16 <= n_sets; i += 16) {
+        for (size_t j = i; j < i + 16; j++) {
+            check(j);
+        }
+    }
+    for (; i < n_sets; i++) {
+        check(i);
     }
-    return sub;
 }
 
-// Given a set that was separated from the others via the semicolon,
-// e.g. `"6 red, 1 blue, 3 green;"` or `"2 blue, 1 red, 2 green"`
-Set make_set(const string &set) {
-    Set cubes;
-    size_t start = 0, comma = 0;
-    do {
-        comma = set.find(',', start);
-        string cube = trim(substring(set, start, comma));
-        // index of whitespace in the string
-        size_t space = cube.find(' '); 
-        // everything before space
-        int count = stoi(substring(cube, 0, space)); 
-        // everything after space
-        string color = substring(cube, space + 1); 
-        CUBE_ID id;
-        // This sucks but whatever
-        if (color == "red") {
-            id = CUBE_ID::RED;
-        } else if (color == "green") {
-            id = CUBE_ID::GREEN;
-        } else if (color == "blue") {
-            id = CUBE_ID::BLUE;
-        } else {
-            eprintf("Invalid Cube ID!");
-        }
-        cubes[id].count = count;
-        cubes[id].color = color;
-        start = comma + 1;
-    } while (comma != set.npos);
-    return cubes;
+// Sum of the IDs of games where every set fits.
+long long sum_possible(const GameStore &store, const vector<uint8_t> &fits) {
+    long long sum = 0;
+    for (size_t i = 0; i < store.games(); i++) {
+        uint32_t first = store.set_offsets[i];
+        uint32_t last = store.set_offsets[i + 1];
+        bool possible = memchr(fits.data() + first, 0, last - first) == nullptr;
+        sum += possible ? store.ids[i] : 0;
+    }
+    return sum;
 }
 
-bool check_cube(Set &set, CUBE_ID id) {
-    const Cube &cube = set[id];
-    if (cube.count == 0) {
+bool print_cube(CUBE_ID id, int count, int limit) {
+    if (count == 0) {
         return true;
     }
-    printf("%i %s, ", cube.count, cube.color.c_str());
-    // Compare against Elf's proposed values
-    switch (id) {
-        case CUBE_ID::RED:   return cube.count <= 12;
-        case CUBE_ID::GREEN: return cube.count <= 13;
-        case CUBE_ID::BLUE:  return cube.count <= 14;
-        default:             eprintf("Invalid cube ID value!");
-    }
-    return false;
+    // Views aren't nul terminated so we need the precision.
+    auto color = CUBE_COLORS[static_cast<size_t>(id)];
+    printf("%i %.*s, ", count, static_cast<int>(color.length()), color.data());
+    return count <= limit;
 }
- 
-int tokenize_game(const string &buffer) {
-    // This is a VERY bad idea but it DOES work...
-    // int id = atoi(gameinfo.substr(gameinfo.find(' ') + 1).c_str());
-    
-    // excludes `':'` in resulting substrings, keep this around for later!
-    size_t colon = buffer.find(':'); 
-
-    // substring `"Game <number>"`, exclude whitespace and colon
-    int id = stoi(substring(buffer, buffer.find(' ') + 1, colon)); 
 
-    // remainder of main string past the colon, remove leading whitespace
-    string results = trim(substring(buffer, colon + 1));
-
-    // scanf family format reference: https://en.cppreference.com/w/c/io/fscanf
-    // sscanf(number.c_str(), "Game %d", &game.id);
-
-    printf("Game: %i\n", id);
-    size_t start = 0, semi = 0; // keep track of substring indexes
-    int count = 1;
-    do {
-        semi = results.find(';', start);
-        // Indiv set: `"6 red, 1 blue, 3 green;"` or `"2 blue, 1 red, 2 green"`
-        Set set = make_set(trim(substring(results, start, semi)));
-        printf("\tSet %i: ", count++);
-        bool fits = check_cube(set, CUBE_ID::RED)
-                 && check_cube(set, CUBE_ID::GREEN)
-                 && check_cube(set, CUBE_ID::BLUE);
+// Every set up to the first one that doesn't fit, if any.
+void print_game(const GameStore &store, size_t game) {
+    printf("Game: %u\n", store.ids[game]);
+    uint32_t first = store.set_offsets[game];
+    uint32_t last = store.set_offsets[game + 1];
+    for (uint32_t i = first; i < last; i++) {
+        printf("\tSet %u: ", i - first + 1);
+        bool fits = print_cube(CUBE_ID::RED, store.red[i], MAX_RED)
+                 && print_cube(CUBE_ID::GREEN, store.green[i], MAX_GREEN)
+                 && print_cube(CUBE_ID::BLUE, store.blue[i], MAX_BLUE);
         printf("\n");
-        start = semi + 1;
         if (!fits) {
             printf("\tGame does not fit Elf's criteria!\n");
-            // id = 0; // uncomment this to verify if all sets being printed
-            return 0;
+            return;
         }
-    } while (semi != results.npos);
-    return id;
-} 
+    }
+}
 
 int main(int argc, char *argv[]) {
+    // Usage: part1 [--quiet] [file]
+    const char *name = "../part1.txt";
+    bool quiet = false; // Only print the answer, not every set.
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0 || strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else {
+            name = argv[i];
+        }
+    }
+    crim_trace_thread_name("main");
     // Game numbers, comma separated elems, semicolon separated sets
-    ifstream file((argc == 2) ? argv[1] : "../part1.txt");
+    crim::mapped_file file(name);
     if (!file.is_open()) {
         eprintf("Failed to open input file!");
         return 1;
     }
-    int sum = 0; // sum of valid games
-    string buffer; // a line ends at first newline char
-    // Fill buffer w/ contents of line, sans newline
-    while (getline(file, buffer)) {
-        sum += tokenize_game(buffer);
+    GameStore store;
+    {
+        crim_trace_scope("parse");
+        if (!tokenize_games(file.view(), store)) {
+            eprintf("Malformed input, no answer!");
+            return 1;
+        }
+    }
+    long long sum; // sum of valid games
+    {
+        crim_trace_scope("solve");
+        vector<uint8_t> fits(store.sets());
+        check_sets(store.sets(), store.red.data(), store.green.data(), store.blue.data(), fits.data());
+        sum = sum_possible(store, fits);
+    }
+    crim_trace_scope("print");
+    if (!quiet) {
+        for (size_t i = 0; i < store.games(); i++) {
+            print_game(store, i);
+        }
     }
-    printf("Sum: %i\n", sum);
-    file.close();
+    printf("Sum: %lld\n", sum);
     return 0;
 }
@@ -1,33 +1,158 @@
 #pragma once
-#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
-#include <fstream>
-#include <string>
+#include <cstring>
+#include <string_view>
 #include <vector>
 
+#include <crim/keyword_table.tcc>
+#include <crim/mapped_file.hpp>
+#include <crim/parse_int.tcc>
+
 #define eprintf(msg) std::fprintf(stderr, __FILE__ ":%i: " msg "\n", __LINE__)
 
 // Use behaviour of enums to our advantage to determine the count
 enum class CUBE_ID {RED, GREEN, BLUE, COUNT};
 
-struct Cube {
-    std::string color = "(empty)"; // one of "red", "blue" or "green"
-    int count = 0; // default ot 0 so we don't get garbage
-};
+// Same order as `CUBE_ID`, so a keyword's index is its ID. Hashed at compile time.
+constexpr auto CUBE_COLORS = crim::make_keyword_table("red", "green", "blue");
 
-// Results of a bunch of cubes
-struct Set {
-private:
-    // Each set only ever has 3 cubes
-    std::array<Cube, static_cast<size_t>(CUBE_ID::COUNT)> m_buffer;
-public:
-    // Read and write access to the buffer for convinience
-    Cube &operator[](CUBE_ID key) {
-        return m_buffer[static_cast<size_t>(key)]; // lol this is ugly as hell
-    };
-};
+// Every game of the input, one column per field instead of one struct per
+// game, so each part is a straight run over a few arrays. Sets are stored
+// back to back and games only say where theirs start.
+struct GameStore {
+    std::vector<std::uint32_t> ids; // integral part of `"Game 1"`, `"Game 2"`, etc.
+    // Game `i` has sets `[set_offsets[i], set_offsets[i + 1])`, so there's
+    // one more of these than there are games.
+    std::vector<std::uint32_t> set_offsets{0};
+    // One per set, 0 if the color didn't come up. Counts past 255 are errors.
+    std::vector<std::uint8_t> red;
+    std::vector<std::uint8_t> green;
+    std::vector<std::uint8_t> blue;
+
+    std::size_t games() const {
+        return ids.size();
+    }
 
-struct Game {
-    int id; // integral part of `"Game 1"`, `"Game 2"`, `"Game 11"`, etc.
-    std::vector<Set> sets; // Elf will "shuffle" an unknown amount of times
+    std::size_t sets() const {
+        return red.size();
+    }
 };
+
+inline const char *skip_spaces(const char *p_iter, const char *p_end) {
+    while (p_iter < p_end && (*p_iter == ' ' || *p_iter == '\r')) {
+        p_iter++;
+    }
+    return p_iter;
+}
+
+/**
+ * @brief   Reads every `"Game <id>: <count> <color>, ...; ...\n"` line of
+ *          `text` straight into `store`, going over each byte once. Nothing
+ *          is allocated per line, the columns just grow now and then.
+ *
+ * @return  `false` if anything didn't look like that, so don't trust the
+ *          answer. What we could make out of those lines is still stored.
+ */
+inline bool tokenize_games(std::string_view text, GameStore &store) {
+    // Real inputs are about 150 bytes and 5 sets a game, so this is plenty.
+    store.ids.reserve(store.ids.size() + text.size() / 128);
+    store.set_offsets.reserve(store.set_offsets.size() + text.size() / 128);
+    store.red.reserve(store.red.size() + text.size() / 24);
+    store.green.reserve(store.green.size() + text.size() / 24);
+    store.blue.reserve(store.blue.size() + text.size() / 24);
+
+    bool ok = true;
+    const char *p_iter = text.data();
+    const char *p_end = p_iter + text.size();
+    while (p_iter < p_end) {
+        const char *p_line = p_iter;
+        // `"Game <id>:"`, so skip to the first digit
+        while (p_iter < p_end && *p_iter != '\n' && !(*p_iter >= '0' && *p_iter <= '9')) {
+            p_iter++;
+        }
+        if (p_iter == p_end || *p_iter == '\n') {
+            // Blank lines are fine, anything else without an ID isn't.
+            if (skip_spaces(p_line, p_iter) != p_iter) {
+                eprintf("Invalid game ID!");
+                ok = false;
+            }
+            p_iter++;
+            continue;
+        }
+        std::uint32_t id = 0;
+        p_iter = crim::parse_uint(p_iter, p_end, id);
+        if (p_iter == nullptr || *p_iter != ':') {
+            eprintf("Invalid game ID!");
+            ok = false;
+            p_iter = static_cast<const char *>(std::memchr(p_line, '\n', static_cast<std::size_t>(p_end - p_line)));
+            p_iter = (p_iter == nullptr) ? p_end : p_iter + 1;
+            continue;
+        }
+        p_iter++;
+        store.ids.push_back(id);
+
+        // Comma separated cubes, semicolon separated sets, until the newline
+        std::uint8_t counts[static_cast<std::size_t>(CUBE_ID::COUNT)] = {0, 0, 0};
+        for (;;) {
+            p_iter = skip_spaces(p_iter, p_end);
+            std::uint8_t count = 0;
+            bool has_count = true;
+            const char *p_digits = p_iter;
+            p_iter = crim::parse_uint(p_iter, p_end, count);
+            if (p_iter == nullptr) {
+                ok = false;
+                p_iter = p_digits;
+                while (p_iter < p_end && *p_iter >= '0' && *p_iter <= '9') {
+                    p_iter++;
+                }
+                if (p_iter == p_digits) {
+                    // e.g. `"Game 1: red"` or `"Game 1: ; ;"`, skip this cube
+                    eprintf("Missing cube count!");
+                    has_count = false;
+                } else {
+                    eprintf("Cube count doesn't fit in a byte!");
+                    count = 255;
+                }
+            }
+            p_iter = skip_spaces(p_iter, p_end);
+            const char *p_color = p_iter;
+            while (p_iter < p_end && *p_iter >= 'a' && *p_iter <= 'z') {
+                p_iter++;
+            }
+            std::string_view color(p_color, static_cast<std::size_t>(p_iter - p_color));
+            CUBE_ID cube = CUBE_COLORS.to_enum(color, CUBE_ID::COUNT);
+            if (cube == CUBE_ID::COUNT) {
+                // Nothing at all after a missing count was already reported.
+                if (has_count || !color.empty()) {
+                    eprintf("Invalid Cube ID!");
+                }
+                ok = false;
+            } else if (has_count) {
+                counts[static_cast<std::size_t>(cube)] = count;
+            }
+            p_iter = skip_spaces(p_iter, p_end);
+            char next = (p_iter < p_end) ? *p_iter++ : '\n';
+            if (next == ',') {
+                continue;
+            }
+            store.red.push_back(counts[static_cast<std::size_t>(CUBE_ID::RED)]);
+            store.green.push_back(counts[static_cast<std::size_t>(CUBE_ID::GREEN)]);
+            store.blue.push_back(counts[static_cast<std::size_t>(CUBE_ID::BLUE)]);
+            counts[0] = counts[1] = counts[2] = 0;
+            if (next == ';') {
+                continue;
+            }
+            if (next != '\n') {
+                eprintf("Expected ',', ';' or a newline!");
+                ok = false;
+                p_iter = static_cast<const char *>(std::memchr(p_iter, '\n', static_cast<std::size_t>(p_end - p_iter)));
+                p_iter = (p_iter == nullptr) ? p_end : p_iter + 1;
+            }
+            break;
+        }
+        store.set_offsets.push_back(static_cast<std::uint32_t>(store.sets()));
+    }
+    return ok;
+}
@@ -0,0 +1,67 @@
+#include <cstdlib>
+
+#include <crim/trace.hpp>
+
+#include "part1.hpp"
+
+using namespace std; // I cannot be bothered to deal with C++'s crap today
+
+// Fewest cubes of each color that could've played a game, i.e. the most of
+// each color any one of its sets showed.
+struct MinimumCubes {
+    uint8_t red = 0;
+    uint8_t green = 0;
+    uint8_t blue = 0;
+
+    long long power() const {
+        return static_cast<long long>(red) * green * blue;
+    }
+};
+
+MinimumCubes minimum_cubes(const GameStore &store, size_t game) {
+    MinimumCubes cubes;
+    for (uint32_t i = store.set_offsets[game]; i < store.set_offsets[game + 1]; i++) {
+        cubes.red = max(cubes.red, store.red[i]);
+        cubes.green = max(cubes.green, store.green[i]);
+        cubes.blue = max(cubes.blue, store.blue[i]);
+    }
+    return cubes;
+}
+
+int main(int argc, char *argv[]) {
+    // Usage: part2 [--quiet] [file]
+    const char *name = "../part2.txt";
+    bool quiet = false; // Only print the answer, not every game.
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0 || strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else {
+            name = argv[i];
+        }
+    }
+    crim_trace_thread_name("main");
+    crim::mapped_file file(name);
+    if (!file.is_open()) {
+        eprintf("Failed to open input file!");
+        return 1;
+    }
+    GameStore store;
+    {
+        crim_trace_scope("parse");
+        if (!tokenize_games(file.view(), store)) {
+            eprintf("Malformed input, no answer!");
+            return 1;
+        }
+    }
+    crim_trace_scope("solve");
+    long long sum = 0; // sum of all games' cube power
+    for (size_t i = 0; i < store.games(); i++) {
+        MinimumCubes cubes = minimum_cubes(store, i);
+        if (!quiet) {
+            printf("Game %u: %i red, %i green, %i blue\n", store.ids[i], cubes.red, cubes.green, cubes.blue);
+        }
+        sum += cubes.power();
+    }
+    printf("Total Cube Power: %lld\n", sum);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/* -*- C++ -*- */
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/dyarray.tcc>
+#include <crim/memory.tcc>
+
+#include "bench.hpp"
+
+/**
+ * Usage: allocator [--reps N] [--warmup N] [filter]
+ *
+ * `crim::allocator` against `std::allocator`, on their own and underneath
+ * both `crim::dyarray` and `std::vector`. `std::allocator` goes first in every
+ * table so it's what the ratios are against.
+ *
+ * The container runs are where `crim::allocator::reallocate` shows up:
+ * `crim::dyarray` grows trivially relocatable elements in place with
+ * `realloc` when it can, but only if its allocator has one.
+ */
+
+static constexpr size_t N_BLOCKS = 1 << 12;
+static constexpr size_t N_INTS = 1 << 20;
+
+// Allocates `N_BLOCKS` blocks of `n_count` ints, then frees them all.
+template<class AllocT>
+void alloc_blocks(size_t n_count) {
+    AllocT alloc;
+    std::vector<int *> blocks(N_BLOCKS);
+    for (size_t i = 0; i < N_BLOCKS; i++) {
+        blocks[i] = alloc.allocate(n_count);
+        bench::do_not_optimize(blocks[i]);
+    }
+    for (size_t i = 0; i < N_BLOCKS; i++) {
+        alloc.deallocate(blocks[i], n_count);
+    }
+}
+
+template<class ArrayT>
+void push_ints() {
+    ArrayT values;
+    for (size_t i = 0; i < N_INTS; i++) {
+        values.push_back(static_cast<int>(i));
+    }
+    bench::do_not_optimize(values);
+}
+
+template<class ArrayT>
+std::optional<ArrayT> make_ints() {
+    std::optional<ArrayT> values(std::in_place);
+    values->reserve(N_INTS);
+    for (size_t i = 0; i < N_INTS; i++) {
+        values->push_back(static_cast<int>(i));
+    }
+    return values;
+}
+
+int main(int argc, char *argv[]) {
+    bench::suite suite("crim::allocator vs std::allocator", argc, argv);
+
+    for (size_t n_count : {4, 64, 1024, 65536}) {
+        std::string title = "allocate and deallocate " + std::to_string(n_count * sizeof(int)) + " bytes, per block";
+        suite.group(title.c_str());
+        suite.run("std::allocator<int>", N_BLOCKS, [n_count]() {
+            alloc_blocks<std::allocator<int>>(n_count);
+        });
+        suite.run("crim::allocator<int>", N_BLOCKS, [n_count]() {
+            alloc_blocks<crim::allocator<int>>(n_count);
+        });
+    }
+
+    suite.group("push_back 2^20 ints, per element");
+    suite.run("std::vector, std::allocator", N_INTS, push_ints<std::vector<int>>);
+    suite.run("std::vector, crim::allocator", N_INTS, push_ints<std::vector<int, crim::allocator<int>>>);
+    suite.run("crim::dyarray, std::allocator", N_INTS, push_ints<crim::dyarray<int, std::allocator<int>>>);
+    suite.run("crim::dyarray, crim::allocator", N_INTS, push_ints<crim::dyarray<int, crim::allocator<int>>>);
+
+    suite.group("destroy 2^20 ints, per array");
+    suite.run("std::vector, std::allocator", 1, make_ints<std::vector<int>>,
+        [](std::optional<std::vector<int>> &values) { values.reset(); });
+    suite.run("std::vector, crim::allocator", 1, make_ints<std::vector<int, crim::allocator<int>>>,
+        [](std::optional<std::vector<int, crim::allocator<int>>> &values) { values.reset(); });
+    suite.run("crim::dyarray, std::allocator", 1, make_ints<crim::dyarray<int, std::allocator<int>>>,
+        [](std::optional<crim::dyarray<int, std::allocator<int>>> &values) { values.reset(); });
+    suite.run("crim::dyarray, crim::allocator", 1, make_ints<crim::dyarray<int, crim::allocator<int>>>,
+        [](std::optional<crim::dyarray<int, crim::allocator<int>>> &values) { values.reset(); });
+    return 0;
+}
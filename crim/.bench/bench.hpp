@@ -0,0 +1,271 @@
+#pragma once
+
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -*- C++ -*- */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BENCH_USE_TSC
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> /* __rdtsc, _mm_lfence, _ReadWriteBarrier */
+#else
+#include <x86intrin.h> /* __rdtsc, _mm_lfence */
+#endif
+#endif
+
+/**
+ * A tiny microbenchmark harness, just enough to compare crim with the standard
+ * library without dragging in Google Benchmark.
+ *
+ * Every benchmark is run a few times untimed to warm up the caches, the heap
+ * and the branch predictors, then timed over and over. We report the median,
+ * which shrugs off the odd interrupt, and the 99th percentile, which doesn't.
+ * Times are per operation, where you say how many operations one run does.
+ *
+ * Usage of any suite built on this: `<suite> [--reps N] [--warmup N] [filter]`
+ * where only benchmarks whose name contains `filter` are run.
+ */
+namespace bench {
+
+/**
+ * BEGIN: OPTIMIZATION BARRIERS -*----------------------------------------------
+ */
+
+/**
+ * @brief   Makes the compiler believe `value` is read, so whatever computed it
+ *          can't be thrown away. Same idea as Google Benchmark's
+ *          `DoNotOptimize`. Costs nothing at runtime.
+ */
+template<class T>
+inline void do_not_optimize(const T &value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    static volatile const void *p_sink;
+    p_sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r"(&value) : "memory");
+#endif
+}
+
+// Makes the compiler assume all memory was read and written right here.
+inline void clobber_memory() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/**
+ * END: OPTIMIZATION BARRIERS -*------------------------------------------------
+ */
+
+/**
+ * BEGIN: TIMER -*--------------------------------------------------------------
+ */
+
+/**
+ * @brief   Reads the CPU's timestamp counter where there is one, which takes a
+ *          couple dozen cycles, against hundreds for some `steady_clock`s.
+ *          Ticks are turned into nanoseconds by timing a busy loop against
+ *          `steady_clock` once at startup.
+ *
+ * @note    Assumes an invariant TSC, which ticks at the same rate whatever the
+ *          core's clock speed. Anything from the last 15 years has one.
+ */
+class tsc_timer {
+private:
+    double m_nnspertick;
+    std::uint64_t m_noverhead; // Ticks between 2 back to back `now()`s.
+
+public:
+    tsc_timer() : m_nnspertick{calibrate()}, m_noverhead{measure_overhead()} {}
+
+    static std::uint64_t now() {
+#ifdef BENCH_USE_TSC
+        // Don't let the read drift into, or out of, the code being timed.
+        _mm_lfence();
+        std::uint64_t n_ticks = __rdtsc();
+        _mm_lfence();
+        return n_ticks;
+#else
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Less the cost of reading the timer itself, so an empty body is ~0.
+    double to_ns(std::uint64_t n_ticks) const {
+        n_ticks = (n_ticks > m_noverhead) ? n_ticks - m_noverhead : 0;
+        return static_cast<double>(n_ticks) * m_nnspertick;
+    }
+
+    double ns_per_tick() const {
+        return m_nnspertick;
+    }
+
+    double overhead_ns() const {
+        return static_cast<double>(m_noverhead) * m_nnspertick;
+    }
+
+private:
+    static double calibrate() {
+#ifdef BENCH_USE_TSC
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
+        std::uint64_t n_start = now();
+        while (clock::now() - start < std::chrono::milliseconds(50)) {
+            // Spin so the core is awake and at speed.
+        }
+        std::uint64_t n_stop = now();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        return elapsed.count() / static_cast<double>(n_stop - n_start);
+#else
+        return 1.0;
+#endif
+    }
+
+    // The fastest of many tries, since anything slower was interrupted.
+    static std::uint64_t measure_overhead() {
+        std::uint64_t n_best = ~std::uint64_t(0);
+        for (int i = 0; i < 1000; i++) {
+            std::uint64_t n_start = now();
+            clobber_memory();
+            std::uint64_t n_stop = now();
+            n_best = std::min(n_best, n_stop - n_start);
+        }
+        return n_best;
+    }
+};
+
+/**
+ * END: TIMER -*----------------------------------------------------------------
+ */
+
+/**
+ * BEGIN: SUITE -*--------------------------------------------------------------
+ */
+
+struct result {
+    std::string name;
+    double median; // All in nanoseconds per operation.
+    double p99;
+    double best;
+};
+
+// Nearest-rank percentile of sorted samples, so p99 of 30 runs is the slowest.
+inline double percentile(const std::vector<double> &sorted, double n_percent) {
+    size_t n_rank = static_cast<size_t>(n_percent / 100.0 * static_cast<double>(sorted.size()) + 0.999999);
+    n_rank = (n_rank == 0) ? 1 : n_rank;
+    return sorted[std::min(n_rank, sorted.size()) - 1];
+}
+
+/**
+ * @brief   A named set of benchmarks, printed as they finish. Benchmarks are
+ *          grouped, and everything in a group is compared against the first
+ *          thing that ran in it.
+ */
+class suite {
+private:
+    tsc_timer m_timer;
+    size_t m_nreps;
+    size_t m_nwarmup;
+    const char *m_filter;
+    std::string m_group; // Printed before the first benchmark that runs in it.
+    double m_nbaseline; // Median of the first benchmark in this group.
+
+public:
+    suite(const char *title, int argc, char *argv[])
+        : m_nreps{30}
+        , m_nwarmup{3}
+        , m_filter{""}
+        , m_nbaseline{0.0}
+    {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+                m_nreps = strtoul(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+                m_nwarmup = strtoul(argv[++i], NULL, 10);
+            } else {
+                m_filter = argv[i];
+            }
+        }
+        m_nreps = (m_nreps == 0) ? 1 : m_nreps;
+#ifdef BENCH_USE_TSC
+        const char *clock = "TSC";
+#else
+        const char *clock = "steady_clock";
+#endif
+        printf("%s: %zu runs after %zu warmup, %s at %.3f ns/tick, %.1f ns overhead subtracted\n", title,
+            m_nreps, m_nwarmup, clock, m_timer.ns_per_tick(), m_timer.overhead_ns());
+    }
+
+    // Starts a new table, whose first benchmark is what the rest compare to.
+    void group(const char *title) {
+        m_group = title;
+        m_nbaseline = 0.0;
+    }
+
+    /**
+     * @brief   Times `body()`, which should do `n_ops` operations.
+     */
+    template<class BodyFn>
+    void run(const char *name, size_t n_ops, BodyFn body) {
+        run(name, n_ops, []() { return 0; }, [&body](int &) { body(); });
+    }
+
+    /**
+     * @brief   Times `body(state)` where `state = setup()` for every run. Only
+     *          `body` is timed, so `setup` can build whatever it's going to
+     *          copy, move or destroy. Whatever is left in `state` is destroyed
+     *          after the timer stops.
+     */
+    template<class SetupFn, class BodyFn>
+    void run(const char *name, size_t n_ops, SetupFn setup, BodyFn body) {
+        if (strstr(name, m_filter) == NULL) {
+            return;
+        }
+        n_ops = (n_ops == 0) ? 1 : n_ops;
+        std::vector<double> samples;
+        samples.reserve(m_nreps);
+        for (size_t i = 0; i < m_nwarmup + m_nreps; i++) {
+            auto state = setup();
+            clobber_memory();
+            std::uint64_t n_start = tsc_timer::now();
+            body(state);
+            clobber_memory();
+            std::uint64_t n_stop = tsc_timer::now();
+            do_not_optimize(state);
+            if (i >= m_nwarmup) {
+                samples.push_back(m_timer.to_ns(n_stop - n_start) / static_cast<double>(n_ops));
+            }
+        }
+        std::sort(samples.begin(), samples.end());
+        report(result{name, percentile(samples, 50), percentile(samples, 99), samples.front()});
+    }
+
+private:
+    void report(const result &res) {
+        if (m_nbaseline == 0.0) {
+            m_nbaseline = res.median;
+            printf("\n%s\n", m_group.c_str());
+            printf("%-40s %15s %15s %15s %8s\n", "", "median", "p99", "best", "ratio");
+        }
+        printf("%-40s %12.2f ns %12.2f ns %12.2f ns %7.3fx\n", res.name.c_str(), res.median, res.p99, res.best,
+            res.median / m_nbaseline);
+    }
+};
+
+/**
+ * END: SUITE -*----------------------------------------------------------------
+ */
+
+}; // namespace bench
@@ -0,0 +1,135 @@
+/* -*- C++ -*- */
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/base_string.tcc>
+#include <crim/dyarray.tcc>
+
+#include "bench.hpp"
+
+/**
+ * Usage: dyarray [--reps N] [--warmup N] [filter]
+ *
+ * `crim::dyarray` against `std::vector`, for `int`s and for strings that are
+ * too long for the short string buffer. `std::vector` goes first in every
+ * table, so a ratio under 1 means `crim::dyarray` was faster.
+ *
+ * `crim::dyarray::resize` sets the capacity, not the length, so it's up
+ * against `std::vector::reserve`: both reallocate and move every element.
+ *
+ * Pushing and copying are timed per element. Moving, growing and destroying
+ * are per array, since `realloc` and `free` of a big block can be nearly free
+ * no matter how many elements are in it.
+ */
+
+static constexpr size_t N_INTS = 1 << 20;
+static constexpr size_t N_STRINGS = 1 << 16;
+
+const char LONG_STRING[] = "This string is long enough to need the heap!";
+
+// Either kind of element, from an index.
+template<class ElemT>
+ElemT make_elem(size_t i) {
+    if constexpr (std::is_integral_v<ElemT>) {
+        return static_cast<ElemT>(i);
+    } else {
+        return ElemT(LONG_STRING);
+    }
+}
+
+template<class ArrayT>
+ArrayT make_array(size_t n_count) {
+    using ElemT = std::decay_t<decltype(*std::declval<ArrayT &>().begin())>;
+    ArrayT values;
+    values.reserve(n_count);
+    for (size_t i = 0; i < n_count; i++) {
+        values.push_back(make_elem<ElemT>(i));
+    }
+    return values;
+}
+
+template<class ElemT>
+void grow(std::vector<ElemT> &values, size_t n_capacity) {
+    values.reserve(n_capacity);
+}
+
+template<class ElemT>
+void grow(crim::dyarray<ElemT> &values, size_t n_capacity) {
+    values.resize(n_capacity);
+}
+
+// Source to copy or move from, and somewhere to put it that isn't timed when
+// it's destroyed.
+template<class ArrayT>
+struct copy_state {
+    ArrayT source;
+    std::optional<ArrayT> dest;
+};
+
+template<class ArrayT>
+void run_all(bench::suite &suite, const char *name, size_t n_count, int n_group) {
+    using ElemT = std::decay_t<decltype(*std::declval<ArrayT &>().begin())>;
+    std::string title = name;
+    switch (n_group) {
+    case 0:
+        suite.run((title + " push_back").c_str(), n_count, [n_count]() {
+            ArrayT values;
+            for (size_t i = 0; i < n_count; i++) {
+                values.push_back(make_elem<ElemT>(i));
+            }
+            bench::do_not_optimize(values);
+        });
+        break;
+    case 1:
+        suite.run((title + " copy").c_str(), n_count, [n_count]() {
+            return copy_state<ArrayT>{make_array<ArrayT>(n_count), std::nullopt};
+        }, [](copy_state<ArrayT> &state) {
+            state.dest.emplace(state.source);
+        });
+        break;
+    case 2:
+        suite.run((title + " move").c_str(), 1, [n_count]() {
+            return copy_state<ArrayT>{make_array<ArrayT>(n_count), std::nullopt};
+        }, [](copy_state<ArrayT> &state) {
+            state.dest.emplace(std::move(state.source));
+        });
+        break;
+    case 3:
+        suite.run((title + " grow 2x").c_str(), 1, [n_count]() {
+            return make_array<ArrayT>(n_count);
+        }, [n_count](ArrayT &values) {
+            grow(values, n_count * 2);
+        });
+        break;
+    case 4:
+        suite.run((title + " destroy").c_str(), 1, [n_count]() {
+            return std::optional<ArrayT>(make_array<ArrayT>(n_count));
+        }, [](std::optional<ArrayT> &values) {
+            values.reset();
+        });
+        break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bench::suite suite("crim::dyarray vs std::vector", argc, argv);
+    const char *ops[] = {
+        "push_back, per element", "copy, per element", "move, per array",
+        "grow 2x (resize vs reserve), per array", "destroy, per array"
+    };
+    for (int i = 0; i < 5; i++) {
+        suite.group((std::string(ops[i]) + ", 2^20 ints").c_str());
+        run_all<std::vector<int>>(suite, "std::vector<int>", N_INTS, i);
+        run_all<crim::dyarray<int>>(suite, "crim::dyarray<int>", N_INTS, i);
+    }
+    for (int i = 0; i < 5; i++) {
+        suite.group((std::string(ops[i]) + ", 2^16 heap strings").c_str());
+        run_all<std::vector<std::string>>(suite, "std::vector<std::string>", N_STRINGS, i);
+        run_all<std::vector<crim::cstring>>(suite, "std::vector<crim::cstring>", N_STRINGS, i);
+        run_all<crim::dyarray<crim::cstring>>(suite, "crim::dyarray<crim::cstring>", N_STRINGS, i);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/* -*- C++ -*- */
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/base_string.tcc>
+#include <crim/dystring.tcc>
+
+#include "bench.hpp"
+
+/**
+ * Usage: strings [--reps N] [--warmup N] [filter]
+ *
+ * `std::string` against `crim::cstring`, which has a short string buffer, and
+ * `crim::string`, which is a `crim::dystring` and always uses the heap.
+ * `std::string` goes first in every table so it's what the ratios are against.
+ *
+ * Everything is timed per string, over a batch of `N_STRINGS`, except pushing
+ * which is per character.
+ */
+
+static constexpr size_t N_STRINGS = 1 << 14;
+static constexpr size_t N_CHARS = 1 << 20;
+
+const char SHORT_STRING[] = "fits inline"; // 11 chars, inline for cstring and std::string
+const char LONG_STRING[] = "This string is long enough to need the heap!";
+
+// Each string type spells appending a character differently.
+void push(std::string &text, char ch) {
+    text.push_back(ch);
+}
+
+void push(crim::cstring &text, char ch) {
+    text.push_back(ch);
+}
+
+void push(crim::string &text, char ch) {
+    text += ch;
+}
+
+// Batch of strings to copy or move from, and where the results go. Only the
+// copies and moves are timed, not destroying any of them.
+template<class StringT>
+struct batch_state {
+    std::vector<StringT> source;
+    std::vector<std::optional<StringT>> dest;
+};
+
+template<class StringT>
+batch_state<StringT> make_batch(const char *text) {
+    batch_state<StringT> state;
+    state.source.reserve(N_STRINGS);
+    for (size_t i = 0; i < N_STRINGS; i++) {
+        state.source.emplace_back(text);
+    }
+    state.dest.resize(N_STRINGS);
+    return state;
+}
+
+template<class StringT>
+void construct(const char *text) {
+    for (size_t i = 0; i < N_STRINGS; i++) {
+        StringT copy(text);
+        bench::do_not_optimize(copy);
+    }
+}
+
+template<class StringT>
+void copy(batch_state<StringT> &state) {
+    for (size_t i = 0; i < N_STRINGS; i++) {
+        state.dest[i].emplace(state.source[i]);
+    }
+}
+
+template<class StringT>
+void run_group(bench::suite &suite, const char *name, int n_group) {
+    std::string title = name;
+    auto make_short = []() { return make_batch<StringT>(SHORT_STRING); };
+    auto make_long = []() { return make_batch<StringT>(LONG_STRING); };
+    switch (n_group) {
+    case 0:
+        suite.run((title + " short").c_str(), N_STRINGS, []() { construct<StringT>(SHORT_STRING); });
+        break;
+    case 1:
+        suite.run((title + " long").c_str(), N_STRINGS, []() { construct<StringT>(LONG_STRING); });
+        break;
+    case 2:
+        suite.run((title + " push").c_str(), N_CHARS, []() {
+            StringT text("");
+            for (size_t i = 0; i < N_CHARS; i++) {
+                push(text, static_cast<char>('a' + i % 26));
+            }
+            bench::do_not_optimize(text);
+        });
+        break;
+    case 3:
+        suite.run((title + " copy short").c_str(), N_STRINGS, make_short, copy<StringT>);
+        break;
+    case 4:
+        suite.run((title + " copy long").c_str(), N_STRINGS, make_long, copy<StringT>);
+        break;
+    case 5:
+        suite.run((title + " move long").c_str(), N_STRINGS, make_long, [](batch_state<StringT> &state) {
+            for (size_t i = 0; i < N_STRINGS; i++) {
+                state.dest[i].emplace(std::move(state.source[i]));
+            }
+        });
+        break;
+    case 6:
+        suite.run((title + " reserve 4096").c_str(), N_STRINGS, make_long, [](batch_state<StringT> &state) {
+            for (size_t i = 0; i < N_STRINGS; i++) {
+                state.source[i].reserve(4096);
+            }
+        });
+        break;
+    case 7:
+        suite.run((title + " destroy long").c_str(), N_STRINGS, make_long, [](batch_state<StringT> &state) {
+            state.source.clear();
+        });
+        break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bench::suite suite("crim::cstring and crim::string vs std::string", argc, argv);
+    const char *groups[] = {
+        "construct and destroy short, per string", "construct and destroy long, per string",
+        "push, per char", "copy short, per string", "copy long, per string", "move long, per string",
+        "resize (reserve) long, per string", "destroy long, per string"
+    };
+    for (int i = 0; i < 8; i++) {
+        suite.group(groups[i]);
+        run_group<std::string>(suite, "std::string", i);
+        run_group<crim::cstring>(suite, "crim::cstring", i);
+        run_group<crim::string>(suite, "crim::string", i);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+
+#include "../base_string.tcc"
+#include "../dystring.tcc"
+
+/**
+ * Usage: append [megabytes]
+ *
+ * Builds one big string of `megabytes` (default 64) out of 4 KB lines and then
+ * out of 8 byte tokens, like when slurping a whole puzzle input. Compares
+ * `crim::cstring`, `crim::string` and `std::string`, with and without
+ * reserving up front, plus the old way of pushing back one char at a time.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+static char chunk[4096];
+
+// Length plus a few characters, so the compiler can't throw the string away.
+template<class StringT>
+long long checksum(const StringT &s)
+{
+    const char *p = s.c_str();
+    size_t n = s.length();
+    return static_cast<long long>(n) + p[0] + p[n / 2] + p[n - 1];
+}
+
+long long cstring_push_back(size_t n_total, size_t n_piece)
+{
+    crim::cstring s;
+    for (size_t i = 0; i + n_piece <= n_total; i += n_piece) {
+        for (size_t j = 0; j < n_piece; j++) {
+            s.push_back(chunk[j]);
+        }
+    }
+    return checksum(s);
+}
+
+template<class StringT>
+long long append_pieces(size_t n_total, size_t n_piece)
+{
+    StringT s;
+    for (size_t i = 0; i + n_piece <= n_total; i += n_piece) {
+        s.append(chunk, n_piece);
+    }
+    return checksum(s);
+}
+
+template<class StringT>
+long long reserve_pieces(size_t n_total, size_t n_piece)
+{
+    StringT s;
+    s.reserve(n_total);
+    for (size_t i = 0; i + n_piece <= n_total; i += n_piece) {
+        s.append(chunk, n_piece);
+    }
+    return checksum(s);
+}
+
+// Appending ourselves onto ourselves has to survive the reallocation.
+bool self_append_test()
+{
+    crim::cstring s = "Hi mom! ";
+    crim::string t = "Hi mom! ";
+    for (int i = 0; i < 5; i++) {
+        s.append(s);
+        t += t;
+    }
+    std::string expected = "Hi mom! ";
+    for (int i = 0; i < 5; i++) {
+        expected += expected;
+    }
+    return s.c_str() == expected && t.c_str() == expected;
+}
+
+void run_bench(const char *name, long long (*fn)(size_t, size_t), size_t n_total, size_t n_piece)
+{
+    auto start = bench_clock::now();
+    long long sum = fn(n_total, n_piece);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    double mbps = (n_total / (1024.0 * 1024.0)) / elapsed.count();
+    std::printf("%-28s %9.3f s %9.1f MB/s (checksum %lld)\n", name, elapsed.count(), mbps, sum);
+}
+
+void run_suite(size_t n_total, size_t n_piece)
+{
+    std::printf("\n%zu MB in pieces of %zu bytes\n\n", n_total / (1024 * 1024), n_piece);
+    run_bench("crim::cstring push_back", cstring_push_back, n_total, n_piece);
+    run_bench("crim::cstring append", append_pieces<crim::cstring>, n_total, n_piece);
+    run_bench("crim::cstring reserve", reserve_pieces<crim::cstring>, n_total, n_piece);
+    run_bench("crim::string append", append_pieces<crim::string>, n_total, n_piece);
+    run_bench("crim::string reserve", reserve_pieces<crim::string>, n_total, n_piece);
+    run_bench("std::string append", append_pieces<std::string>, n_total, n_piece);
+    run_bench("std::string reserve", reserve_pieces<std::string>, n_total, n_piece);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n_megabytes = (argc == 2) ? std::strtoul(argv[1], NULL, 10) : 0;
+    if (n_megabytes == 0) {
+        n_megabytes = 64;
+    }
+    for (size_t i = 0; i < sizeof(chunk); i++) {
+        chunk[i] = (i % 64 == 63) ? '\n' : 'a' + static_cast<char>(i % 26);
+    }
+    std::printf("self append: %s\n", self_append_test() ? "ok" : "FAILED");
+    size_t n_total = n_megabytes * 1024 * 1024;
+    // Untimed, so the first contender doesn't pay for faulting in the heap.
+    append_pieces<std::string>(n_total, sizeof(chunk));
+    run_suite(n_total, sizeof(chunk));
+    run_suite(n_total, 8);
+    return 0;
+}
@@ -0,0 +1,232 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../impl/char_traits.tcc"
+
+/**
+ * Usage: char_traits [megabytes]
+ *
+ * Checks every `crim::impl::simd` version of find, compare, length and search
+ * against libc on random inputs, then times them on short (15 byte), medium
+ * (256 byte) and long (64 KB) inputs. Each run chews through `megabytes`
+ * (default 256) in total. The plain loops from `crim::impl::char_traits` are
+ * there too, as that's what we'd get with no specialization at all, and
+ * "picked" is whatever `crim::char_traits<char>` actually ended up using.
+ *
+ * Note that glibc already picks its own SSE2/AVX2/EVEX `memchr` and friends at
+ * load time, so "libc" is a high bar on Linux. MSVC's and MinGW's much less so.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+using scalar = crim::impl::char_traits<char>;
+namespace simd = crim::impl::simd;
+
+struct variant {
+    const char *name;
+    simd::find_fn find;
+    simd::compare_fn compare;
+    simd::length_fn length;
+    simd::search_fn search;
+};
+
+const char *scalar_find(const char *p, size_t n, char ch)
+{
+    return scalar::find(p, n, ch);
+}
+
+int scalar_compare(const char *p_lhs, const char *p_rhs, size_t n)
+{
+    return scalar::compare(p_lhs, p_rhs, n);
+}
+
+size_t scalar_length(const char *p)
+{
+    return scalar::length(p);
+}
+
+const char *scalar_search(const char *p_hay, size_t n_hay, const char *p_needle, size_t n_needle)
+{
+    return scalar::search(p_hay, n_hay, p_needle, n_needle);
+}
+
+std::vector<variant> get_variants()
+{
+    std::vector<variant> variants;
+    variants.push_back({"scalar", scalar_find, scalar_compare, scalar_length, scalar_search});
+    variants.push_back({"libc", simd::libc::find, simd::libc::compare, simd::libc::length, simd::libc::search});
+#if defined(CRIM_CHAR_TRAITS_USE_SIMD)
+    variants.push_back({"sse2", simd::sse2::find, simd::sse2::compare, simd::sse2::length, simd::sse2::search});
+    if (simd::avx2::supported()) {
+        variants.push_back({"avx2", simd::avx2::find, simd::avx2::compare, simd::avx2::length, simd::avx2::search});
+    }
+#endif
+    const simd::dispatch_table &picked = simd::dispatch();
+    variants.push_back({"picked", picked.find, picked.compare, picked.length, picked.search});
+    return variants;
+}
+
+int sign(int n)
+{
+    return (n > 0) - (n < 0);
+}
+
+// Small alphabet so that searches actually get partial matches to reject.
+void fill_random(std::mt19937 &rng, char *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        p[i] = 'a' + static_cast<char>(rng() % 4);
+    }
+}
+
+const char *naive_search(const char *p_hay, size_t n_hay, const char *p_needle, size_t n_needle)
+{
+    for (size_t i = 0; i + n_needle <= n_hay; i++) {
+        if (std::memcmp(p_hay + i, p_needle, n_needle) == 0) {
+            return p_hay + i;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Every length from 0 to 200 at every alignment within a 32 byte block, with
+ * the interesting byte placed at random (or nowhere). Returns the number of
+ * mismatches, so 0 is good.
+ */
+int check_variant(const variant &v)
+{
+    std::mt19937 rng(2023);
+    std::vector<char> buf(512);
+    std::vector<char> other(512);
+    int n_failed = 0;
+    for (size_t n = 0; n <= 200; n++) {
+        for (size_t offset = 0; offset < 32; offset++) {
+            char *p = buf.data() + offset;
+            char *q = other.data() + offset;
+            fill_random(rng, p, n);
+            std::memcpy(q, p, n);
+
+            // The needle is either somewhere in there or nowhere at all.
+            size_t n_at = (n == 0) ? 0 : rng() % (n + 1);
+            if (n_at < n) {
+                p[n_at] = 'z';
+            }
+            if (v.find(p, n, 'z') != ((n_at < n) ? p + n_at : nullptr)) {
+                n_failed++;
+            }
+
+            // `q` differs from `p` by at most one byte, either way round.
+            std::memcpy(q, p, n);
+            if (n_at < n) {
+                q[n_at] = (rng() % 2 == 0) ? 'A' : '\xff';
+            }
+            // Plain `char` is usually signed, so the generic traits (which
+            // only know `lt`) put '\xff' before 'A'. `memcmp` doesn't.
+            bool b_signed = (v.compare == scalar_compare && n_at < n && q[n_at] < 0);
+            if (!b_signed && sign(v.compare(p, q, n)) != sign(std::memcmp(p, q, n))) {
+                n_failed++;
+            }
+
+            p[n] = '\0';
+            if (v.length(p) != std::strlen(p)) {
+                n_failed++;
+            }
+
+            size_t n_needle = rng() % 9;
+            size_t n_from = (n > n_needle) ? rng() % (n - n_needle + 1) : 0;
+            const char *p_needle = (rng() % 2 == 0 && n >= n_needle) ? p + n_from : "abcdabcd";
+            if (v.search(p, n, p_needle, n_needle) != naive_search(p, n, p_needle, n_needle)) {
+                n_failed++;
+            }
+        }
+    }
+    return n_failed;
+}
+
+/**
+ * Each input is `n_size` bytes and the thing we look for (if any) is right at
+ * the end, so every function has to go through all of it.
+ */
+struct inputs {
+    std::vector<char> hay;
+    std::vector<char> copy;
+    size_t n_size;
+    size_t n_count; // How many times to repeat to hit the total.
+};
+
+inputs make_inputs(size_t n_size, size_t n_total)
+{
+    std::mt19937 rng(n_size);
+    inputs in;
+    in.n_size = n_size;
+    in.n_count = n_total / n_size;
+    in.hay.resize(n_size + 1);
+    fill_random(rng, in.hay.data(), n_size);
+    std::memcpy(in.hay.data() + n_size - 8, "dcbazzzz", 8);
+    in.hay[n_size] = '\0';
+    in.copy = in.hay;
+    in.copy[n_size - 1] = 'y';
+    return in;
+}
+
+// The pointer games stop the compiler from hoisting calls out of the loop.
+template<class Fn>
+double time_loop(const inputs &in, Fn fn, long long &sum)
+{
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < in.n_count; i++) {
+        const char *volatile p_hay = in.hay.data();
+        sum += fn(p_hay);
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    return (in.n_size * in.n_count) / (1024.0 * 1024.0 * 1024.0) / elapsed.count();
+}
+
+void run_bench(const variant &v, const inputs &in)
+{
+    long long sum = 0;
+    double find = time_loop(in, [&](const char *p) {
+        return v.find(p, in.n_size, 'z') - p;
+    }, sum);
+    double compare = time_loop(in, [&](const char *p) {
+        return v.compare(p, in.copy.data(), in.n_size);
+    }, sum);
+    double length = time_loop(in, [&](const char *p) {
+        return static_cast<long long>(v.length(p));
+    }, sum);
+    double search = time_loop(in, [&](const char *p) {
+        return v.search(p, in.n_size, "dcbaz", 5) - p;
+    }, sum);
+    std::printf("%-8s %10.2f %10.2f %10.2f %10.2f   (checksum %lld)\n",
+        v.name, find, compare, length, search, sum);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n_megabytes = (argc == 2) ? std::strtoul(argv[1], NULL, 10) : 0;
+    if (n_megabytes == 0) {
+        n_megabytes = 256;
+    }
+    std::vector<variant> variants = get_variants();
+    std::printf("dispatch() picked: %s\n\n", simd::dispatch().name);
+    for (const variant &v : variants) {
+        int n_failed = check_variant(v);
+        std::printf("check %-8s %s (%i mismatches)\n", v.name, (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    }
+
+    size_t n_total = n_megabytes * 1024 * 1024;
+    const size_t sizes[] = {15, 256, 64 * 1024};
+    for (size_t n_size : sizes) {
+        inputs in = make_inputs(n_size, n_total);
+        std::printf("\n%zu byte inputs, GB/s\n\n", n_size);
+        std::printf("%-8s %10s %10s %10s %10s\n", "", "find", "compare", "length", "search");
+        for (const variant &v : variants) {
+            run_bench(v, in);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../base_string.tcc"
+#include "../dyarray.tcc"
+
+#if !defined(_WIN32)
+#include <sys/resource.h> /* getrusage */
+#include <sys/wait.h> /* waitpid */
+#include <unistd.h> /* fork */
+#endif
+
+/**
+ * Usage: short_strings [count]
+ *
+ * Stores `count` (default 10 million) short tokens like the ones we get from
+ * puzzle inputs: node names, card hands, color words and the like. All of them
+ * fit in a `crim::cstring` but the longer ones don't fit in a `std::string`.
+ * Each contender runs in its own child process so we get a clean peak RSS.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+static const char *const colors[] = {"red", "green", "blue"};
+static const char cards[] = "23456789TJQKA";
+
+// Writes the `i`th token to `p_buffer`, between 3 and 22 characters long.
+void make_token(size_t i, char *p_buffer, size_t n_size)
+{
+    switch (i % 4) {
+    case 0: // Node names, e.g. "AAA".
+        std::snprintf(p_buffer, n_size, "%c%c%c",
+            'A' + int(i % 26), 'A' + int(i / 26 % 26), 'A' + int(i / 676 % 26));
+        break;
+    case 1: // Card hand and bid, e.g. "32T3K 765".
+        std::snprintf(p_buffer, n_size, "%c%c%c%c%c %zu",
+            cards[i % 13], cards[i / 13 % 13], cards[i / 7 % 13],
+            cards[i / 3 % 13], cards[i / 11 % 13], i % 1000);
+        break;
+    case 2: // Color word, e.g. "12 green".
+        std::snprintf(p_buffer, n_size, "%zu %s", i % 20, colors[i % 3]);
+        break;
+    default: // Whole handful of cubes, e.g. "Game 42: 3 blue, 4 red".
+        std::snprintf(p_buffer, n_size, "Game %zu: %zu %s, %zu %s",
+            i % 100, i % 20, colors[i % 3], i / 3 % 20, colors[(i + 1) % 3]);
+        break;
+    }
+}
+
+template<class ArrayT>
+long long store_tokens(size_t count)
+{
+    ArrayT tokens;
+    char buffer[64];
+    for (size_t i = 0; i < count; i++) {
+        make_token(i, buffer, sizeof(buffer));
+        tokens.emplace_back(buffer);
+    }
+    long long sum = 0;
+    for (const auto &s : tokens) {
+        sum += s.length();
+    }
+    return sum;
+}
+
+#if !defined(_WIN32)
+void run_bench(const char *name, size_t n_elemsize, long long (*fn)(size_t), size_t count)
+{
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        return;
+    } else if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    auto start = bench_clock::now();
+    long long sum = fn(count);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // Linux reports `ru_maxrss` in kilobytes.
+    std::printf("%-32s %2zu bytes %8.3f s %8.1f MB peak RSS (checksum %lld)\n",
+        name, n_elemsize, elapsed.count(), usage.ru_maxrss / 1024.0, sum);
+    std::fflush(stdout);
+    _exit(0);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#if defined(_WIN32)
+    (void)argc;
+    (void)argv;
+    std::printf("This benchmark needs fork() and getrusage().\n");
+#else
+    size_t count = (argc == 2) ? std::strtoul(argv[1], NULL, 10) : 0;
+    if (count == 0) {
+        count = 10000000;
+    }
+    std::printf("%zu short strings\n\n", count);
+    run_bench("crim::dyarray<crim::cstring>", sizeof(crim::cstring),
+        store_tokens<crim::dyarray<crim::cstring>>, count);
+    run_bench("std::vector<std::string>", sizeof(std::string),
+        store_tokens<std::vector<std::string>>, count);
+    run_bench("crim::dyarray<std::string>", sizeof(std::string),
+        store_tokens<crim::dyarray<std::string>>, count);
+#endif
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* -*- C -*- */
+#include <stdio.h>
+
+/* -*- C++ -*- */
+#include <list>
+#include <string>
+#include <type_traits>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/arena.tcc>
+#include <crim/base_string.tcc>
+#include <crim/dyarray.tcc>
+#include <crim/dystring.tcc>
+
+/* -*-  READFILE TEST -*- */
+#include "readfile.hpp"
+/* -*-                -*- */
+
+// Every line, and the array of lines itself, lives in the same arena.
+using arena_string = crim::dystring<char, crim::arena_allocator<char>>;
+using arena_lines = crim::dyarray<arena_string, crim::arena_allocator<arena_string>>;
+using arena_cstring = crim::base_string<char, crim::char_traits<char>, crim::arena_allocator<char>>;
+
+// Same as `readline` in `crim_readfile.cpp`, but allocates from `buffer`.
+arena_string readline(FILE *stream, crim::arena &buffer) {
+    arena_string in_buffer(buffer);
+    int c;
+    while ((c = fgetc(stream)) != EOF && c != '\r' && c != '\n') {
+        in_buffer.append(static_cast<char>(c));
+    }
+    if (c == '\r' && (c = fgetc(stream)) != EOF) {
+        if (c != '\n' && ungetc(c, stream) == EOF) {
+            perror("Failed to read CRLF line ending!");
+        }
+    }
+    return in_buffer;
+}
+
+// Same as `readfile` in `crim_readfile.cpp`, but allocates from `buffer`.
+arena_lines readfile(const char *fname, crim::arena &buffer) {
+    arena_lines contents(buffer);
+    FILE *infile = fopen(fname, "r");
+    if (infile == NULL) {
+        perror("fopen");
+        return contents;
+    }
+    while (!feof(infile)) {
+        contents.push_back(readline(infile, buffer));
+    }
+    fclose(infile);
+    return contents;
+}
+
+void print_stats(const char *when, const crim::arena &buffer) {
+    printf("%s: used %zu / capacity %zu bytes\n", when, buffer.used(), buffer.capacity());
+}
+
+// Copies and moves between strings should carry the arena along.
+void cstring_test(crim::arena &buffer) {
+    arena_cstring s("Hi mom!", buffer);
+    arena_cstring t("This is a very long string that won't fit on the stack!", buffer);
+    arena_cstring u = t; // copy-constructor
+    arena_cstring v; // no arena yet
+    v = crim::rvalue_cast(s); // move-assignment, takes `s`'s arena
+    v = "Another string that is long enough to need the heap.";
+    printf("{t}: \"%s\"\n{u}: \"%s\"\n{v}: \"%s\"\n", t.c_str(), u.c_str(), v.c_str());
+    printf("same arena? %s\n\n", (v.get_allocator() == t.get_allocator()) ? "true" : "false");
+}
+
+// `std` containers compare allocators too, and need ours found through ADL.
+void std_test(crim::arena &buffer) {
+    using std_string = std::basic_string<char, std::char_traits<char>, crim::arena_allocator<char>>;
+    using std_list = std::list<int, crim::arena_allocator<int>>;
+    std_string s("This is a very long string that won't fit in the SSO buffer!", buffer);
+    std_string t(buffer);
+    t = std::move(s); // move-assignment
+    std_list a({1, 2, 3}, buffer);
+    std_list b({4, 5, 6}, buffer);
+    a.splice(a.end(), b);
+    printf("{t}: \"%s\"\nspliced %zu elements\n\n", t.c_str(), a.size());
+}
+
+int main(int argc, char *argv[]) {
+    const char *fname = (argc == 2) ? argv[1] : FALLBACK "segfault.txt";
+    crim::arena buffer;
+    cstring_test(buffer);
+    std_test(buffer);
+    print_stats("after cstring_test", buffer);
+    buffer.reset();
+
+    // Read the same file a few times, resetting in between. After the first
+    // round the arena shouldn't need to grow at all.
+    for (int round = 1; round <= 3; round++) {
+        {
+            arena_lines contents = readfile(fname, buffer);
+            int padding = get_digits(contents.length());
+            for (size_t i = 0; round == 1 && i < contents.length(); i++) {
+                printf("%*zu: %s\n", padding, i + 1, contents[i].c_str());
+            }
+            printf("round %i: %zu lines, ", round, contents.length());
+            print_stats("before reset", buffer);
+        }
+        buffer.reset();
+    }
+    return 0;
+}
@@ -1,7 +1,12 @@
 #include <stdio.h>
+#include <string.h>
 
 #include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
 
+#include <crim/base_string.tcc>
 #include <crim/dyarray.tcc>
 #include <crim/dystring.tcc>
 
@@ -65,10 +70,54 @@ void crim_dyarray_string_test() {
     printf("\n");
 }
 
+// Elements that refer back into the array itself must survive a reallocation.
+void crim_dyarray_append_test() {
+    crim::dyarray<crim::string> v;
+    v.reserve(2).emplace_back("This string is long enough to live on the heap!");
+    v.emplace_back(v[0]).emplace_back(v[1]); // 3rd one has to reallocate
+    printf("capacity after reserve(2) and 3 emplace_back: %zu\n", v.capacity());
+    std::vector<crim::string> w = {"Hi mom!", "Hello there!"};
+    v.append_range(w.begin(), w.end());
+    v.append_range(v.begin(), v.end()); // doubles our own contents
+    for (const auto *p = v.begin(); p < v.end(); p++) {
+        printf("v[%td]: \"%s\"\n", p - v.begin(), p->c_str());
+    }
+    printf("length %zu, capacity %zu\n\n", v.length(), v.capacity());
+}
+
+// Growing should move strings bytewise, and `std::vector` should move them too.
+void crim_dyarray_relocate_test() {
+    printf("relocatable? int: %i, crim::string: %i, crim::cstring: %i, std::string: %i\n",
+        crim::is_trivially_relocatable_v<int>,
+        crim::is_trivially_relocatable_v<crim::string>,
+        crim::is_trivially_relocatable_v<crim::cstring>,
+        crim::is_trivially_relocatable_v<std::string>);
+    printf("nothrow move? crim::string: %i, crim::cstring: %i\n",
+        std::is_nothrow_move_constructible_v<crim::string>,
+        std::is_nothrow_move_constructible_v<crim::cstring>);
+
+    crim::dyarray<crim::cstring> v;
+    std::vector<crim::cstring> w;
+    for (int i = 0; i < 100; i++) {
+        // Every 3rd one is too long for the stack buffer.
+        const char *s = (i % 3 == 0) ? "This one is long enough to go on the heap!" : "Short!";
+        v.emplace_back(s);
+        w.emplace_back(s);
+    }
+    v.resize(50); // shrink, the other half has to be destroyed
+    size_t n_same = 0;
+    for (size_t i = 0; i < v.length(); i++) {
+        n_same += (strcmp(v[i].c_str(), w[i].c_str()) == 0);
+    }
+    printf("%zu of %zu match after growing and shrinking\n\n", n_same, v.length());
+}
+
 int main() {
     crim_string_move_test();
     crim_string_copy_test();
     crim_dyarray_int_test();
     crim_dyarray_string_test();
+    crim_dyarray_append_test();
+    crim_dyarray_relocate_test();
     return 0;
 }
@@ -0,0 +1,133 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/base_string.tcc>
+#include <crim/dyarray.tcc>
+
+/**
+ * Usage: crim_dyarray_bench [count]
+ *
+ * Pushes `count` (default 100 million) ints through `crim::dyarray` and
+ * `std::vector` side by side, with and without reserving up front.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+// Sum of every element, so the compiler can't throw the arrays away.
+template<class ArrayT>
+long long checksum(const ArrayT &values) {
+    long long sum = 0;
+    for (int i : values) {
+        sum += i;
+    }
+    return sum;
+}
+
+template<class ArrayT>
+long long bench_push_back(size_t count) {
+    ArrayT values;
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(static_cast<int>(i));
+    }
+    return checksum(values);
+}
+
+template<class ArrayT>
+long long bench_emplace_back(size_t count) {
+    ArrayT values;
+    for (size_t i = 0; i < count; i++) {
+        values.emplace_back(static_cast<int>(i));
+    }
+    return checksum(values);
+}
+
+template<class ArrayT>
+long long bench_reserve(size_t count) {
+    ArrayT values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(static_cast<int>(i));
+    }
+    return checksum(values);
+}
+
+// Appends the same 4096 ints over and over.
+long long bench_dyarray_append(size_t count) {
+    std::vector<int> chunk(4096);
+    for (size_t i = 0; i < chunk.size(); i++) {
+        chunk[i] = static_cast<int>(i);
+    }
+    crim::dyarray<int> values;
+    for (size_t i = 0; i + chunk.size() <= count; i += chunk.size()) {
+        values.append_range(chunk.data(), chunk.data() + chunk.size());
+    }
+    return checksum(values);
+}
+
+long long bench_vector_insert(size_t count) {
+    std::vector<int> chunk(4096);
+    for (size_t i = 0; i < chunk.size(); i++) {
+        chunk[i] = static_cast<int>(i);
+    }
+    std::vector<int> values;
+    for (size_t i = 0; i + chunk.size() <= count; i += chunk.size()) {
+        values.insert(values.end(), chunk.begin(), chunk.end());
+    }
+    return checksum(values);
+}
+
+// Strings too long for the stack buffer, so every one owns a heap block. Growth
+// relocates `crim::cstring` bytewise but has to move each `std::string`.
+template<class ArrayT>
+long long bench_strings(size_t count) {
+    ArrayT values;
+    for (size_t i = 0; i < count; i++) {
+        values.emplace_back("This string is long enough to need the heap!");
+    }
+    long long sum = 0;
+    for (const auto &s : values) {
+        sum += s.length();
+    }
+    return sum;
+}
+
+void run_bench(const char *name, long long (*fn)(size_t), size_t count) {
+    auto start = bench_clock::now();
+    long long sum = fn(count);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    double mops = (count / 1e6) / elapsed.count();
+    printf("%-32s %9.3f s %9.1f M/s (checksum %lld)\n", name, elapsed.count(), mops, sum);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (count == 0) {
+        count = 100000000;
+    }
+    printf("%zu ints\n\n", count);
+    // Untimed, so the first contender doesn't pay for faulting in the heap.
+    bench_push_back<std::vector<int>>(count);
+    run_bench("crim::dyarray push_back", bench_push_back<crim::dyarray<int>>, count);
+    run_bench("std::vector push_back", bench_push_back<std::vector<int>>, count);
+    run_bench("crim::dyarray emplace_back", bench_emplace_back<crim::dyarray<int>>, count);
+    run_bench("std::vector emplace_back", bench_emplace_back<std::vector<int>>, count);
+    run_bench("crim::dyarray reserve", bench_reserve<crim::dyarray<int>>, count);
+    run_bench("std::vector reserve", bench_reserve<std::vector<int>>, count);
+    run_bench("crim::dyarray append_range", bench_dyarray_append, count);
+    run_bench("std::vector insert", bench_vector_insert, count);
+
+    count /= 10;
+    printf("\n%zu heap strings\n\n", count);
+    bench_strings<std::vector<std::string>>(count);
+    run_bench("crim::dyarray<crim::cstring>", bench_strings<crim::dyarray<crim::cstring>>, count);
+    run_bench("std::vector<crim::cstring>", bench_strings<std::vector<crim::cstring>>, count);
+    run_bench("std::vector<std::string>", bench_strings<std::vector<std::string>>, count);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <random>
+#include <string_view>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/keyword_table.tcc>
+
+/**
+ * Usage: crim_keyword_table [millions]
+ *
+ * Checks lookups in a few `crim::keyword_table`s, then does `millions`
+ * (default 100) million random lookups in each, against a chain of `==`. The
+ * 3 colors are the ones `make_set` in `2023/02-cube-conundrum/cpp/part1.cpp`
+ * looks up.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+enum class color {red, green, blue, none};
+
+constexpr auto COLORS = crim::make_keyword_table("red", "green", "blue");
+constexpr auto DIGITS = crim::make_keyword_table("one", "two", "three", "four", "five", "six", "seven", "eight", "nine");
+constexpr auto C_KEYWORDS = crim::make_keyword_table(
+    "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if", "int",
+    "long", "register", "return", "short", "signed", "sizeof", "static",
+    "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while");
+
+// All of this happens in the compiler.
+static_assert(COLORS.to_enum("green", color::none) == color::green);
+static_assert(COLORS.to_enum("purple", color::none) == color::none);
+static_assert(DIGITS.find("seven") == 6);
+static_assert(C_KEYWORDS.find("volatile") == 30);
+static_assert(!C_KEYWORDS.contains("class"));
+
+// Also at runtime: every keyword finds itself, near misses find nothing.
+template<class TableT>
+bool check_table(const char *name, const TableT &table) {
+    int n_failed = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        std::string_view keyword = table[i];
+        n_failed += (table.find(keyword) != i);
+        n_failed += table.contains(keyword.substr(1));
+        n_failed += table.contains(keyword.substr(0, keyword.size() - 1));
+    }
+    n_failed += table.contains("");
+    printf("%-12s %2zu keywords, %s (%i mismatches)\n", name, table.size(),
+        (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed == 0;
+}
+
+color if_chain(std::string_view word) {
+    if (word == "red") {
+        return color::red;
+    } else if (word == "green") {
+        return color::green;
+    } else if (word == "blue") {
+        return color::blue;
+    }
+    return color::none;
+}
+
+color hashed(std::string_view word) {
+    return COLORS.to_enum(word, color::none);
+}
+
+// What a chain of `==` over a bigger set amounts to.
+template<class TableT>
+size_t linear_scan(const TableT &table, std::string_view word) {
+    for (size_t i = 0; i < table.size(); i++) {
+        if (word == table[i]) {
+            return i;
+        }
+    }
+    return TableT::npos;
+}
+
+// Lookups per word come from `words`, repeated. `fn` returns an index or npos.
+template<class Fn>
+void run_bench(const char *name, const std::vector<std::string_view> &words, size_t n_count, Fn fn) {
+    auto start = bench_clock::now();
+    size_t n_found = 0;
+    size_t n_checksum = 0;
+    for (size_t i = 0; i < n_count; i++) {
+        size_t n_index = static_cast<size_t>(fn(words[i & 1023]));
+        n_found += (n_index != static_cast<size_t>(-1));
+        n_checksum += n_index;
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    printf("%-20s %7.3f s %6.2f ns/lookup (found %zu, checksum %zu)\n", name,
+        elapsed.count(), elapsed.count() * 1e9 / n_count, n_found, n_checksum);
+}
+
+// Mostly keywords, plus a few near misses.
+template<class TableT>
+std::vector<std::string_view> random_words(const TableT &table, const char *const *p_misses, size_t n_misses) {
+    std::mt19937 rng(2023);
+    std::vector<std::string_view> words;
+    for (size_t i = 0; i < 1024; i++) {
+        size_t n_roll = rng() % (table.size() + n_misses);
+        words.push_back((n_roll < table.size()) ? table[n_roll] : p_misses[n_roll - table.size()]);
+    }
+    return words;
+}
+
+int main(int argc, char *argv[]) {
+    bool b_ok = check_table("colors", COLORS);
+    b_ok = check_table("digits", DIGITS) && b_ok;
+    b_ok = check_table("C keywords", C_KEYWORDS) && b_ok;
+    if (!b_ok) {
+        return 1;
+    }
+
+    size_t n_millions = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (n_millions == 0) {
+        n_millions = 100;
+    }
+    // Random order so the branch predictor can't learn the chain.
+    size_t n_count = n_millions * 1000000;
+    const char *misses[] = {"grey", "rod", "blues", "twelve", "fiver", "inte", "structs", "voidd"};
+    std::vector<std::string_view> words = random_words(COLORS, misses, 2);
+    printf("\n3 colors\n");
+    run_bench("if chain", words, n_count, [](std::string_view word) {
+        color id = if_chain(word);
+        return (id == color::none) ? COLORS.npos : static_cast<size_t>(id);
+    });
+    run_bench("crim::keyword_table", words, n_count, [](std::string_view word) {
+        color id = hashed(word);
+        return (id == color::none) ? COLORS.npos : static_cast<size_t>(id);
+    });
+
+    words = random_words(DIGITS, misses + 2, 3);
+    printf("\n9 spelled digits\n");
+    run_bench("linear scan", words, n_count, [](std::string_view word) {
+        return linear_scan(DIGITS, word);
+    });
+    run_bench("crim::keyword_table", words, n_count, [](std::string_view word) {
+        return DIGITS.find(word);
+    });
+
+    words = random_words(C_KEYWORDS, misses + 5, 3);
+    printf("\n32 C keywords\n");
+    run_bench("linear scan", words, n_count, [](std::string_view word) {
+        return linear_scan(C_KEYWORDS, word);
+    });
+    run_bench("crim::keyword_table", words, n_count, [](std::string_view word) {
+        return C_KEYWORDS.find(word);
+    });
+    return 0;
+}
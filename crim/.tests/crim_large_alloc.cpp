@@ -0,0 +1,89 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+// Every `crim::allocator` request of 16 MB or more gets mapped in.
+#define CRIM_ALLOCATOR_USE_MMAP
+#define CRIM_ALLOCATOR_MMAP_THRESHOLD (16 * 1024 * 1024)
+#include <crim/memory.tcc>
+#include <crim/dyarray.tcc>
+
+#if !defined(_WIN32)
+#include <sys/resource.h> /* getrusage */
+#include <sys/wait.h> /* waitpid */
+#include <unistd.h> /* fork */
+#endif
+
+/**
+ * Usage: crim_large_alloc [count]
+ *
+ * Pushes `count` (default 200 million) ints one by one, so the buffer keeps
+ * doubling in size. Each contender runs in its own child process so we get a
+ * clean peak RSS for each of them.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+template<class ArrayT>
+long long push_ints(size_t count) {
+    ArrayT values;
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(static_cast<int>(i));
+    }
+    long long sum = 0;
+    for (int i : values) {
+        sum += i;
+    }
+    return sum;
+}
+
+#if !defined(_WIN32)
+void run_bench(const char *name, long long (*fn)(size_t), size_t count, bool b_stats) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return;
+    } else if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    auto start = bench_clock::now();
+    long long sum = fn(count);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // Linux reports `ru_maxrss` in kilobytes.
+    printf("%-36s %9.3f s %8.1f MB peak RSS (checksum %lld)\n",
+        name, elapsed.count(), usage.ru_maxrss / 1024.0, sum);
+    if (b_stats) {
+        crim::large_alloc::report(stdout);
+    }
+    fflush(stdout);
+    _exit(0);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#if defined(_WIN32)
+    (void)argc;
+    (void)argv;
+    printf("This benchmark needs fork() and getrusage().\n");
+#else
+    size_t count = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (count == 0) {
+        count = 200000000;
+    }
+    printf("%zu ints, %zu MB of payload\n\n", count, count * sizeof(int) / (1024 * 1024));
+    run_bench("std::vector<int>", push_ints<std::vector<int>>, count, false);
+    run_bench("crim::dyarray<int, std::allocator>", push_ints<crim::dyarray<int, std::allocator<int>>>, count, false);
+    run_bench("crim::dyarray<int> (mremap)", push_ints<crim::dyarray<int>>, count, true);
+#endif
+    return 0;
+}
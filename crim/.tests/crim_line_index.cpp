@@ -0,0 +1,207 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/dystring.tcc>
+#include <crim/dyarray.tcc>
+#include <crim/mapped_file.hpp>
+#include <crim/line_index.hpp>
+
+/* -*-  READFILE TEST -*- */
+#include "readfile.hpp"
+/* -*-                -*- */
+
+/**
+ * Usage: crim_line_index [file | megabytes]
+ *
+ * Without a file, we generate a synthetic one of `megabytes` (default 64) so
+ * every reader below gets the exact same input.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+struct result {
+    size_t lines; // How many lines the reader saw.
+    size_t bytes; // Sum of line lengths, to check readers agree.
+};
+
+// Same as `readline` in `crim_readfile.cpp`, minus the nul char append.
+crim::string crim_readline(FILE *stream) {
+    crim::string in_buffer;
+    int c;
+    while ((c = fgetc(stream)) != EOF && c != '\r' && c != '\n') {
+        in_buffer.push_back(static_cast<char>(c));
+    }
+    if (c == '\r' && (c = fgetc(stream)) != EOF) {
+        if (c != '\n' && ungetc(c, stream) == EOF) {
+            in_buffer.clear();
+        }
+    }
+    return in_buffer;
+}
+
+// Same as `readline` in `std_readfile.cpp`, minus the nul char append.
+std::string std_readline(FILE *stream) {
+    std::string in;
+    int c;
+    while ((c = fgetc(stream)) != EOF && c != '\r' && c != '\n') {
+        in.push_back(c);
+    }
+    if (c == '\r' && (c = fgetc(stream)) != EOF) {
+        if (c != '\n' && ungetc(c, stream) == EOF) {
+            in.clear();
+        }
+    }
+    return in;
+}
+
+// `crim_readfile.cpp`: `fgetc` into `crim::dyarray<crim::string>`.
+result bench_crim_readfile(const char *fname) {
+    crim::dyarray<crim::string> contents;
+    FILE *infile = fopen(fname, "r");
+    while (!feof(infile)) {
+        contents.push_back(crim_readline(infile));
+    }
+    fclose(infile);
+    result res{contents.length(), 0};
+    for (const auto &line : contents) {
+        res.bytes += line.length();
+    }
+    return res;
+}
+
+// `std_readfile.cpp` with `STD_READFILE_USE_FILEPTR`.
+result bench_std_readfile(const char *fname) {
+    std::vector<std::string> contents;
+    FILE *infile = fopen(fname, "r");
+    while (!feof(infile)) {
+        contents.push_back(std_readline(infile));
+    }
+    fclose(infile);
+    result res{contents.size(), 0};
+    for (const auto &line : contents) {
+        res.bytes += line.length();
+    }
+    return res;
+}
+
+// `std_readfile.cpp` without `STD_READFILE_USE_FILEPTR`.
+result bench_std_getline(const char *fname) {
+    std::vector<std::string> contents;
+    std::ifstream infile(fname);
+    for (std::string line; std::getline(infile, line);) {
+        contents.push_back(std::move(line));
+    }
+    result res{contents.size(), 0};
+    for (const auto &line : contents) {
+        res.bytes += line.length();
+    }
+    return res;
+}
+
+// One `mapped_file::readline` at a time, no index.
+result bench_mapped_readline(const char *fname) {
+    crim::mapped_file file(fname);
+    result res{0, 0};
+    std::string_view line;
+    while (file.readline(line)) {
+        res.lines++;
+        res.bytes += line.size();
+    }
+    return res;
+}
+
+// Map the file then index all of it in one go.
+result bench_line_index(const char *fname) {
+    crim::mapped_file file(fname);
+    crim::line_index index(file.view());
+    result res{index.size(), 0};
+    for (const auto &span : index) {
+        res.bytes += span.length;
+    }
+    return res;
+}
+
+void run_bench(const char *name, result (*fn)(const char *), const char *fname, size_t filesize) {
+    auto start = bench_clock::now();
+    result res = fn(fname);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    double mbps = (filesize / (1024.0 * 1024.0)) / elapsed.count();
+    printf("%-24s %10zu lines %12zu bytes %9.3f s %9.1f MB/s\n",
+        name, res.lines, res.bytes, elapsed.count(), mbps);
+}
+
+// Lines of 0 to 99 lowercase letters so we get a decent mix of short/long.
+bool generate_file(const char *fname, size_t megabytes) {
+    FILE *outfile = fopen(fname, "w");
+    if (outfile == NULL) {
+        perror("fopen");
+        return false;
+    }
+    unsigned seed = 12345;
+    char buffer[128];
+    for (size_t written = 0; written < megabytes * 1024 * 1024; /* Empty */) {
+        seed = seed * 1103515245 + 12345;
+        size_t length = (seed >> 16) % 100;
+        for (size_t i = 0; i < length; i++) {
+            buffer[i] = 'a' + (i * 7 + seed) % 26;
+        }
+        buffer[length++] = '\n';
+        fwrite(buffer, 1, length, outfile);
+        written += length;
+    }
+    fclose(outfile);
+    return true;
+}
+
+// `line_index` has to agree with plain `readline` on every single span.
+bool verify(const char *fname) {
+    crim::mapped_file file(fname);
+    crim::line_index index(file.view());
+    std::string_view line;
+    size_t i = 0;
+    for (/* Empty */; file.readline(line); i++) {
+        if (i >= index.size() || index[i] != line) {
+            printf("Mismatch at line %zu!\n", i + 1);
+            return false;
+        }
+    }
+    return i == index.size();
+}
+
+int main(int argc, char *argv[]) {
+    char *endp = NULL;
+    size_t megabytes = (argc == 2) ? strtoul(argv[1], &endp, 10) : 64;
+    // Anything that isn't purely a number is treated as a file name.
+    bool generated = (argc != 2) || (*endp == '\0' && megabytes > 0);
+    const char *fname = generated ? "bin/line_index_bench.txt" : argv[1];
+    if (generated && !generate_file(fname, megabytes)) {
+        return 1;
+    }
+    crim::mapped_file file(fname);
+    if (!file.is_open()) {
+        return 1;
+    }
+    size_t filesize = file.size();
+    printf("%s: %zu bytes, verified? %s\n", fname, filesize, verify(fname) ? "true" : "false");
+
+    // The `feof` based readers see 1 extra empty line at the very end.
+    run_bench("crim_readfile (fgetc)", bench_crim_readfile, fname, filesize);
+    run_bench("std_readfile (fgetc)", bench_std_readfile, fname, filesize);
+    run_bench("std::getline", bench_std_getline, fname, filesize);
+    run_bench("mapped_file::readline", bench_mapped_readline, fname, filesize);
+    run_bench("crim::line_index", bench_line_index, fname, filesize);
+    if (generated) {
+        remove(fname);
+    }
+    return 0;
+}
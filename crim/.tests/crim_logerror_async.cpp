@@ -0,0 +1,192 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#define CRIM_LOGERROR_USE_ASYNC
+#include <crim/logerror.hpp>
+
+/**
+ * Usage: crim_logerror_async [count]
+ *
+ * Sends `stderr` to `crim_logerror_async.log` and checks that with
+ * `CRIM_LOGERROR_USE_ASYNC` every message from every thread makes it there in
+ * order, or is counted as dropped, that long messages get cut short and that
+ * threads that exit give their rings back. Then has 4 threads log `count`
+ * (default 100000) messages each, and times that against the plain `fprintf`
+ * the default backend does.
+ *
+ * The log is deleted at the end, unless something failed.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+using crim::impl::async_logger;
+
+constexpr const char *LOG_PATH = "crim_logerror_async.log";
+constexpr int N_THREADS = 4;
+
+int check(bool b_ok, const char *what) {
+    if (!b_ok) {
+        printf("FAILED: %s\n", what);
+    }
+    return b_ok ? 0 : 1;
+}
+
+// Every line of the log so far.
+std::vector<std::string> read_log() {
+    crim::logerror_flush();
+    fflush(stderr);
+    std::vector<std::string> lines;
+    FILE *p_file = fopen(LOG_PATH, "r");
+    if (p_file == nullptr) {
+        return lines;
+    }
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), p_file) != nullptr) {
+        lines.emplace_back(buffer);
+    }
+    fclose(p_file);
+    return lines;
+}
+
+// Small bursts with a flush in between never fill a ring, so nothing drops.
+int check_order() {
+    int n_failed = 0;
+    const int n_bursts = 10;
+    const int n_burst = 16;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < N_THREADS; t++) {
+        threads.emplace_back([t]() {
+            char info[64];
+            for (int i = 0; i < n_bursts * n_burst; i++) {
+                snprintf(info, sizeof(info), "order t%i m%i", t, i);
+                crim::logerror_fmt(__FILE__, __LINE__, "check", "order", info);
+                if (i % n_burst == n_burst - 1) {
+                    crim::logerror_flush();
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> next(N_THREADS, 0);
+    bool b_ordered = true;
+    for (const std::string &line : read_log()) {
+        int t, i;
+        if (sscanf(line.c_str(), "\tcheck::order(): order t%i m%i", &t, &i) == 2) {
+            b_ordered = b_ordered && t >= 0 && t < N_THREADS && i == next[t];
+            next[t] = i + 1;
+        }
+    }
+    n_failed += check(b_ordered, "every thread's messages in order");
+    for (int t = 0; t < N_THREADS; t++) {
+        n_failed += check(next[t] == n_bursts * n_burst, "every message made it");
+    }
+    n_failed += check(async_logger::dropped() == 0, "nothing dropped");
+    return n_failed;
+}
+
+// One thread going flat out will outrun the drainer, so some get dropped.
+int check_drops() {
+    int n_failed = 0;
+    const int n_count = 20000;
+    std::size_t n_before = async_logger::dropped();
+    for (int i = 0; i < n_count; i++) {
+        crim::logerror_lit("drops\n");
+    }
+    std::size_t n_dropped = async_logger::dropped() - n_before;
+    int n_written = 0;
+    bool b_reported = false;
+    for (const std::string &line : read_log()) {
+        n_written += (line == "drops\n");
+        b_reported = b_reported || (line.find("dropped") != std::string::npos);
+    }
+    n_failed += check(n_written + n_dropped == n_count, "written plus dropped is everything");
+    n_failed += check(n_dropped == 0 || b_reported, "drops get reported");
+    return n_failed;
+}
+
+int check_truncate() {
+    std::string text = "long " + std::string(1000, 'x') + "\n";
+    crim::logerror_lit(text.c_str());
+    for (const std::string &line : read_log()) {
+        if (line.compare(0, 5, "long ") == 0) {
+            return check(line.size() == sizeof(crim::impl::log_ring::slot::text)
+                && line.compare(line.size() - 4, 4, "...\n") == 0, "long messages get cut short");
+        }
+    }
+    return check(false, "long message made it");
+}
+
+// Threads come and go but we only ever need as many rings as were alive at once.
+int check_rings() {
+    for (int n_round = 0; n_round < 10; n_round++) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < N_THREADS; t++) {
+            threads.emplace_back([]() {
+                crim::logerror_lit("rings\n");
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+    // Plus 1 for the main thread, from `check_drops()`.
+    return check(async_logger::rings() <= N_THREADS + 1, "exited threads give their rings back");
+}
+
+template<class LogFn>
+double time_threads(int n_count, LogFn log) {
+    auto start = bench_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < N_THREADS; t++) {
+        threads.emplace_back([n_count, log]() {
+            for (int i = 0; i < n_count; i++) {
+                log();
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double, std::nano> elapsed = bench_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(n_count) * N_THREADS);
+}
+
+int main(int argc, char *argv[]) {
+    if (freopen(LOG_PATH, "w", stderr) == nullptr) {
+        printf("Could not open %s!\n", LOG_PATH);
+        return 1;
+    }
+    int n_failed = check_order() + check_drops() + check_truncate() + check_rings();
+    printf("logerror checks: %s (%i failures)\n\n", (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    if (n_failed != 0) {
+        return 1;
+    }
+
+    int n_count = (argc == 2) ? atoi(argv[1]) : 100000;
+    double n_sync = time_threads(n_count, []() {
+        fprintf(stderr, "%s:%i:\n\t%s::%s(): %s\n", __FILE__, __LINE__, "bench", "sync", "message");
+    });
+    std::size_t n_before = async_logger::dropped();
+    double n_async = time_threads(n_count, []() {
+        crim::logerror_fmt(__FILE__, __LINE__, "bench", "async", "message");
+    });
+    std::size_t n_dropped = async_logger::dropped() - n_before;
+    crim::logerror_flush();
+
+    printf("%i threads x %i messages\n", N_THREADS, n_count);
+    printf("fprintf(stderr) %8.1f ns/message\n", n_sync);
+    printf("async           %8.1f ns/message (%zu dropped)\n", n_async, n_dropped);
+    remove(LOG_PATH);
+    return 0;
+}
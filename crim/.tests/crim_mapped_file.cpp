@@ -0,0 +1,83 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <string_view>
+#include <type_traits>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/mapped_file.hpp>
+#include <crim/input.hpp>
+
+/* -*-  READFILE TEST -*- */
+#include "readfile.hpp"
+/* -*-                -*- */
+
+// Writes `contents` to a temporary file so we can map it back in.
+bool write_file(const char *fname, const char *contents, size_t length) {
+    FILE *outfile = fopen(fname, "wb");
+    if (outfile == NULL) {
+        perror("fopen");
+        return false;
+    }
+    fwrite(contents, 1, length, outfile);
+    fclose(outfile);
+    return true;
+}
+
+// LF, CRLF, lone CR and a final line without any line ending at all.
+void line_ending_test() {
+    const char contents[] = "LF\nCRLF\r\nlone CR\r\r\nno line ending";
+    const char *fname = "bin/line_endings.txt";
+    if (!write_file(fname, contents, sizeof(contents) - 1)) {
+        return;
+    }
+    crim::mapped_file file(fname);
+    printf("mapped? %s\n", file.is_mapped() ? "true" : "false");
+    std::string_view line;
+    for (int i = 1; file.readline(line); i++) {
+        printf("%i: \"%.*s\" (%zu)\n", i, (int)line.size(), line.data(), line.size());
+    }
+    printf("\n");
+    remove(fname);
+}
+
+// Same lines as `crim_readfile.cpp`, but copied into `crim::cstring`.
+void cstring_test(const char *fname) {
+    crim::mapped_file file(fname);
+    if (!file.is_open()) {
+        return;
+    }
+    int lineno = 1;
+    while (!file.eof()) {
+        crim::cstring line = crim::readline(file);
+        printf("%i: %s (%zu)\n", lineno++, line.c_str(), line.length());
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    line_ending_test();
+    cstring_test(FALLBACK "loremipsum.txt");
+
+    // Pass "-" and pipe a file in to test the `read(2)` fallback.
+    const char *fname = (argc == 2) ? argv[1] : FALLBACK "segfault.txt";
+    crim::mapped_file file(fname);
+    if (!file.is_open()) {
+        fprintf(stderr, "Failed to open '%s'.\n", fname);
+        return 1;
+    }
+    printf("%s: %zu bytes, mapped? %s\n", fname, file.size(), file.is_mapped() ? "true" : "false");
+    std::string_view line;
+    int count = 0;
+    while (file.readline(line)) {
+        count++;
+    }
+    int padding = get_digits(count);
+    file.rewind();
+    for (int i = 1; file.readline(line); i++) {
+        printf("%*i: %.*s\n", padding, i, (int)line.size(), line.data());
+    }
+    return 0;
+}
@@ -0,0 +1,219 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/multi_matcher.hpp>
+
+/**
+ * Usage: crim_multi_matcher [megabytes] [file]
+ *
+ * First checks `crim::multi_matcher` against brute force on random text. Then
+ * generates a synthetic Advent of Code 2023 day 1 calibration file of
+ * `megabytes` (default 1024) and solves part 2 on it twice: the old way from
+ * `2023/01-trebuchet/cpp/part2.cpp`, and with the automaton. If `file` is
+ * given the input is saved there too, so you can feed it to the solvers.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+const char *SPELLINGS[] = {"one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+
+struct match {
+    size_t keyword;
+    size_t offset;
+
+    bool operator==(const match &other) const {
+        return keyword == other.keyword && offset == other.offset;
+    }
+};
+
+// Every (keyword, offset) pair, ordered the same way `scan()` reports them:
+// by where they end, then longest first.
+std::vector<match> brute_force(const std::vector<std::string_view> &keywords, std::string_view text) {
+    std::vector<match> matches;
+    for (size_t n_end = 1; n_end <= text.size(); n_end++) {
+        std::vector<match> here;
+        for (size_t i = 0; i < keywords.size(); i++) {
+            std::string_view keyword = keywords[i];
+            bool b_dupe = false;
+            for (size_t j = 0; j < i; j++) {
+                b_dupe = b_dupe || keywords[j] == keyword;
+            }
+            if (b_dupe || keyword.empty() || keyword.size() > n_end) {
+                continue;
+            }
+            if (text.substr(n_end - keyword.size(), keyword.size()) == keyword) {
+                here.push_back(match{i, n_end - keyword.size()});
+            }
+        }
+        for (size_t i = 0; i < here.size(); i++) {
+            for (size_t j = i + 1; j < here.size(); j++) {
+                if (here[j].offset < here[i].offset) {
+                    std::swap(here[i], here[j]);
+                }
+            }
+        }
+        matches.insert(matches.end(), here.begin(), here.end());
+    }
+    return matches;
+}
+
+bool check_keywords(const char *name, std::vector<std::string_view> keywords, const char *alphabet) {
+    crim::multi_matcher matcher(keywords.data(), keywords.size());
+    std::mt19937 rng(2023);
+    size_t n_alphabet = std::string_view(alphabet).size();
+    int n_failed = 0;
+    for (int n_trial = 0; n_trial < 500; n_trial++) {
+        std::string text;
+        size_t n_length = rng() % 64;
+        for (size_t i = 0; i < n_length; i++) {
+            text.push_back(alphabet[rng() % n_alphabet]);
+        }
+        std::vector<match> found;
+        matcher.scan(text, [&found](size_t n_keyword, size_t n_offset) {
+            found.push_back(match{n_keyword, n_offset});
+        });
+        if (found != brute_force(keywords, text)) {
+            n_failed++;
+        }
+    }
+    printf("%-12s %2zu states, %s (%i mismatches)\n", name, matcher.states(),
+        (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed == 0;
+}
+
+// Mostly lowercase noise with digits and spellings mixed in, 5 to 50 chars.
+std::string make_calibration(size_t n_bytes) {
+    std::mt19937 rng(1);
+    std::string text;
+    text.reserve(n_bytes + 64);
+    while (text.size() < n_bytes) {
+        size_t n_line = 5 + rng() % 46;
+        size_t n_start = text.size();
+        while (text.size() - n_start < n_line) {
+            unsigned n_roll = rng() % 16;
+            if (n_roll == 0) {
+                text.push_back(static_cast<char>('1' + rng() % 9));
+            } else if (n_roll == 1) {
+                text += SPELLINGS[rng() % 9];
+            } else {
+                text.push_back(static_cast<char>('a' + rng() % 26));
+            }
+        }
+        text.push_back('\n');
+    }
+    return text;
+}
+
+/* -*- THE OLD WAY -*- */
+
+int match_spelling(const std::string &test) {
+    for (size_t i = 0; i < 9; i++) {
+        if (test.find(SPELLINGS[i]) != test.npos) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+int old_match_numbers(std::string_view line) {
+    std::vector<int> digits;
+    std::string test = "";
+    for (const char &c : line) {
+        if (isdigit(c)) {
+            digits.push_back(c - '0');
+            test.clear();
+            continue;
+        }
+        test.push_back(c);
+        int value = match_spelling(test);
+        if (value > 0) {
+            digits.push_back(value);
+            test.clear();
+            test = c;
+        }
+    }
+    if (digits.empty()) {
+        return 0;
+    }
+    return (digits.at(0) * 10) + digits.at(digits.size() - 1);
+}
+
+/* -*- THE NEW WAY -*- */
+
+int new_match_numbers(const crim::multi_matcher &matcher, std::string_view line) {
+    int first = -1;
+    int last = 0;
+    crim::multi_matcher::state_type state = matcher.start;
+    for (const char &c : line) {
+        int value = -1;
+        state = matcher.step(state, c);
+        if (isdigit(c)) {
+            value = c - '0';
+        } else if (matcher.matched(state)) {
+            matcher.for_each_match(state, [&value](size_t index) {
+                value = static_cast<int>(index) + 1;
+            });
+        }
+        if (value >= 0) {
+            first = (first == -1) ? value : first;
+            last = value;
+        }
+    }
+    return (first == -1) ? 0 : (first * 10) + last;
+}
+
+template<class Fn>
+void run_bench(const char *name, std::string_view text, Fn match_numbers) {
+    auto start = bench_clock::now();
+    long long sum = 0;
+    size_t n_start = 0;
+    while (n_start < text.size()) {
+        size_t n_endl = text.find('\n', n_start);
+        sum += match_numbers(text.substr(n_start, n_endl - n_start));
+        n_start = n_endl + 1;
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    double mbps = (text.size() / (1024.0 * 1024.0)) / elapsed.count();
+    printf("%-20s %9.3f s %9.1f MB/s (calibration value %lld)\n", name, elapsed.count(), mbps, sum);
+}
+
+int main(int argc, char *argv[]) {
+    bool b_ok = true;
+    b_ok = check_keywords("textbook", {"he", "she", "his", "hers"}, "hers") && b_ok;
+    b_ok = check_keywords("nested", {"a", "aa", "aaa", "b", "ab", "", "aa"}, "ab") && b_ok;
+    b_ok = check_keywords("trebuchet", std::vector<std::string_view>(SPELLINGS, SPELLINGS + 9), "onetwhrfuivsxg1") && b_ok;
+    if (!b_ok) {
+        return 1;
+    }
+
+    size_t n_megabytes = (argc >= 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (n_megabytes == 0) {
+        n_megabytes = 1024;
+    }
+    std::string text = make_calibration(n_megabytes * 1024 * 1024);
+    if (argc >= 3) {
+        FILE *file = fopen(argv[2], "wb");
+        if (file == NULL || fwrite(text.data(), 1, text.size(), file) != text.size()) {
+            fprintf(stderr, "Could not write '%s'!\n", argv[2]);
+            return 1;
+        }
+        fclose(file);
+    }
+    printf("\n%zu MB of calibration lines\n\n", text.size() / (1024 * 1024));
+    crim::multi_matcher matcher(SPELLINGS, 9);
+    run_bench("std::string::find", text, old_match_numbers);
+    run_bench("crim::multi_matcher", text, [&matcher](std::string_view line) {
+        return new_match_numbers(matcher, line);
+    });
+    return 0;
+}
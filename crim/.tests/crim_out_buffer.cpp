@@ -0,0 +1,142 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <climits>
+#include <random>
+#include <string>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/out_buffer.hpp>
+
+/**
+ * Usage: crim_out_buffer [lines]
+ *
+ * Checks that `crim::out_buffer::write_int` gives the same text as `printf`,
+ * and that a tiny buffer that flushes all the time loses nothing. Then writes
+ * `lines` (default 10 million) trebuchet-style lines to `/dev/null`, with
+ * `printf` and with `crim::out_buffer`.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+template<class IntT>
+int check_format(IntT value, const char *fmt) {
+    char expected[32];
+    char actual[32] = {0};
+    snprintf(expected, sizeof(expected), fmt, value);
+    size_t n_length = 0;
+    if (value < 0) {
+        actual[n_length++] = '-';
+        n_length += crim::out_buffer::format_uint(actual + 1, 0ULL - static_cast<unsigned long long>(value));
+    } else {
+        n_length += crim::out_buffer::format_uint(actual, static_cast<unsigned long long>(value));
+    }
+    if (strcmp(expected, actual) != 0 || n_length != strlen(expected)) {
+        printf("MISMATCH: printf '%s', format_uint '%s'\n", expected, actual);
+        return 1;
+    }
+    return 0;
+}
+
+// Everything written to `n_fd` so far, from the start.
+std::string read_back(int n_fd) {
+    std::string text;
+    char buffer[4096];
+    lseek(n_fd, 0, SEEK_SET);
+    ssize_t n_read;
+    while ((n_read = read(n_fd, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, static_cast<size_t>(n_read));
+    }
+    return text;
+}
+
+int check_buffer() {
+    int n_failed = 0;
+    n_failed += check_format(0, "%i");
+    n_failed += check_format(INT_MIN, "%i");
+    n_failed += check_format(INT_MAX, "%i");
+    n_failed += check_format(LLONG_MIN, "%lld");
+    n_failed += check_format(LLONG_MAX, "%lld");
+    n_failed += check_format(ULLONG_MAX, "%llu");
+    for (unsigned long long n_power = 1; n_power <= 1000000000000000000ULL; n_power *= 10) {
+        n_failed += check_format(n_power - 1, "%llu");
+        n_failed += check_format(n_power, "%llu");
+        n_failed += check_format(n_power + 1, "%llu");
+    }
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 100000; i++) {
+        long long n_value = static_cast<long long>(rng() >> (rng() % 64));
+        n_failed += check_format((rng() % 2 == 0) ? n_value : -n_value, "%lld");
+    }
+
+    // A 64 byte buffer flushes every few lines, which should change nothing.
+    FILE *p_file = tmpfile();
+    std::string expected;
+    {
+        crim::out_buffer out(fileno(p_file), 1);
+        for (int i = -500; i < 500; i++) {
+            char line[64];
+            snprintf(line, sizeof(line), "%i : %s\t%i\n", i, "abcdefghij" + (i & 7), i * 31);
+            expected += line;
+            out.write_int(i).write(" : ").write("abcdefghij" + (i & 7)).put('\t').write_int(i * 31).put('\n');
+        }
+        // Bigger than the whole buffer, so it skips it.
+        std::string big(1000, 'x');
+        expected += big;
+        out.write(big);
+        n_failed += !out.flush();
+        n_failed += (out.capacity() != 64);
+    }
+    n_failed += (read_back(fileno(p_file)) != expected);
+    fclose(p_file);
+
+    printf("out_buffer checks: %s (%i failures)\n\n", (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed;
+}
+
+template<class Fn>
+double time_it(Fn fn) {
+    auto start = bench_clock::now();
+    fn();
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    if (check_buffer() != 0) {
+        return 1;
+    }
+    int n_lines = (argc == 2) ? atoi(argv[1]) : 10000000;
+    const char *lines[] = {"two65eightbkgqcsn91qxkfvg", "43qsrrlxxq", "five562", "sjtwonesix6cqbv4"};
+
+    FILE *p_null = fopen("/dev/null", "w");
+    if (p_null == NULL) {
+        fprintf(stderr, "Could not open /dev/null!\n");
+        return 1;
+    }
+    double n_printf = time_it([&]() {
+        for (int i = 0; i < n_lines; i++) {
+            fprintf(p_null, "%i : %s\t%i\n", i + 1, lines[i & 3], (i * 7919) % 100);
+        }
+        fflush(p_null);
+    });
+
+    double n_buffer = time_it([&]() {
+        crim::out_buffer out(fileno(p_null));
+        for (int i = 0; i < n_lines; i++) {
+            out.write_int(i + 1).write(" : ").write(lines[i & 3]).put('\t').write_int((i * 7919) % 100).put('\n');
+        }
+    });
+    fclose(p_null);
+
+    printf("%i lines to /dev/null\n", n_lines);
+    printf("fprintf          %7.3f s %7.1f ns/line\n", n_printf, n_printf * 1e9 / n_lines);
+    printf("crim::out_buffer %7.3f s %7.1f ns/line (%.2fx)\n", n_buffer, n_buffer * 1e9 / n_lines, n_printf / n_buffer);
+    return 0;
+}
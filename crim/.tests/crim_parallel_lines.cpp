@@ -0,0 +1,169 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/mapped_file.hpp>
+#include <crim/parallel_lines.hpp>
+
+/**
+ * Usage: crim_parallel_lines [megabytes | file] [max threads]
+ *
+ * Solves Advent of Code 2023 day 1 part 1 on `file`, or on `megabytes`
+ * (default 1024) of generated calibration lines, with 1, 2, 4... threads up to
+ * `max threads` (default: every core). Each run has to agree with the serial
+ * answer, both for the plain sum and for an order-dependent checksum.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+std::string make_calibration(size_t n_bytes) {
+    std::mt19937 rng(1);
+    std::string text;
+    text.reserve(n_bytes + 64);
+    while (text.size() < n_bytes) {
+        size_t n_line = 5 + rng() % 46;
+        for (size_t i = 0; i < n_line; i++) {
+            text.push_back((rng() % 8 == 0) ? '0' + rng() % 10 : 'a' + rng() % 26);
+        }
+        text.push_back('\n');
+    }
+    return text;
+}
+
+long long first_last(std::string_view line) {
+    int first = -1;
+    int last = 0;
+    for (char c : line) {
+        if (isdigit(c)) {
+            first = (first == -1) ? c - '0' : first;
+            last = c - '0';
+        }
+    }
+    return (first == -1) ? 0 : (first * 10) + last;
+}
+
+/**
+ * Polynomial hash of the answers, so swapping any two lines changes it, unlike
+ * a sum. Carrying `1000003^count` along makes combining two runs associative,
+ * which is all `map_reduce` needs to split the work up.
+ */
+struct ordered_hash {
+    unsigned long long hash;
+    unsigned long long power;
+};
+
+ordered_hash hash_line(std::string_view line) {
+    return ordered_hash{static_cast<unsigned long long>(first_last(line)), 1000003};
+}
+
+ordered_hash ordered(ordered_hash lhs, ordered_hash rhs) {
+    return ordered_hash{lhs.hash * rhs.power + rhs.hash, lhs.power * rhs.power};
+}
+
+/**
+ * Every mix of line endings, including a lone CR, has to give the same lines
+ * as `crim::mapped_file::readline`. Chunks of a few bytes put boundaries
+ * everywhere, even between a CR and its LF.
+ */
+bool check_line_endings() {
+    const char text[] = "a1b\r2c3\nx4y\n\r\n5\r\r6\r\n7z\n\n8\r";
+    FILE *p_file = tmpfile();
+    if (p_file == nullptr || fwrite(text, 1, sizeof(text) - 1, p_file) != sizeof(text) - 1 || fflush(p_file) != 0) {
+        fprintf(stderr, "Could not write a temporary file!\n");
+        return false;
+    }
+    crim::mapped_file file;
+    bool b_open = file.open(fileno(p_file));
+    fclose(p_file);
+    if (!b_open) {
+        fprintf(stderr, "Could not open the temporary file!\n");
+        return false;
+    }
+    std::string_view line;
+    long long n_expected = 0;
+    size_t n_lines = 0;
+    while (file.readline(line)) {
+        n_expected += first_last(line);
+        n_lines++;
+    }
+    size_t n_counted = 0;
+    long long n_serial = 0;
+    crim::parallel_lines::for_each_line(file.view(), [&](std::string_view line) {
+        n_serial += first_last(line);
+        n_counted++;
+    });
+    bool b_ok = (n_serial == n_expected && n_counted == n_lines);
+    for (size_t n_chunksize = 1; n_chunksize <= 8; n_chunksize++) {
+        crim::parallel_lines lines(file.view(), 3, n_chunksize);
+        b_ok = b_ok && lines.map_reduce(0LL, first_last) == n_expected;
+    }
+    printf("line endings: %zu lines, answer %lld, %s\n\n", n_lines, n_expected,
+        b_ok ? "same as readline" : "WRONG ANSWER");
+    return b_ok;
+}
+
+int main(int argc, char *argv[]) {
+    std::string generated;
+    crim::mapped_file file;
+    std::string_view text;
+    size_t n_megabytes = (argc >= 2) ? strtoul(argv[1], NULL, 10) : 1024;
+    if (argc >= 2 && n_megabytes == 0) {
+        if (!file.open(argv[1])) {
+            fprintf(stderr, "Could not open '%s'!\n", argv[1]);
+            return 1;
+        }
+        text = file.view();
+    } else {
+        generated = make_calibration(n_megabytes * 1024 * 1024);
+        text = generated;
+    }
+    size_t n_maxthreads = (argc >= 3) ? strtoul(argv[2], NULL, 10) : std::thread::hardware_concurrency();
+    n_maxthreads = (n_maxthreads == 0) ? 1 : n_maxthreads;
+
+    // Serial reference, no threads involved at all.
+    long long n_expected = 0;
+    ordered_hash expected_hash = {0, 1};
+    crim::parallel_lines::for_each_line(text, [&](std::string_view line) {
+        n_expected += first_last(line);
+    });
+    crim::parallel_lines::for_each_line(text, [&](std::string_view line) {
+        expected_hash = ordered(expected_hash, hash_line(line));
+    });
+    printf("%.1f MB, answer %lld, %zu hardware threads\n\n",
+        text.size() / (1024.0 * 1024.0), n_expected, static_cast<size_t>(std::thread::hardware_concurrency()));
+
+    double n_baseline = 0.0;
+    bool b_ok = true;
+    // Doubling each time, but always ending on exactly the maximum, e.g. 4 then 6.
+    for (size_t n_threads = 1; n_threads != 0; n_threads = (n_threads == n_maxthreads) ? 0
+            : (n_threads * 2 < n_maxthreads) ? n_threads * 2 : n_maxthreads) {
+        crim::parallel_lines lines(text, n_threads);
+        auto start = bench_clock::now();
+        long long n_sum = lines.map_reduce(0LL, first_last);
+        std::chrono::duration<double> elapsed = bench_clock::now() - start;
+
+        ordered_hash hash = lines.map_reduce(ordered_hash{0, 1}, hash_line, ordered);
+        // `init` only counts once, even when it isn't 0.
+        long long n_offset = lines.map_reduce(1000LL, first_last);
+        bool b_match = (n_sum == n_expected && hash.hash == expected_hash.hash && n_offset == n_expected + 1000);
+        b_ok = b_ok && b_match;
+        n_baseline = (n_threads == 1) ? elapsed.count() : n_baseline;
+        printf("%3zu threads: %8.3f s %9.1f MB/s, %5.2fx speedup, %s\n", n_threads, elapsed.count(),
+            (text.size() / (1024.0 * 1024.0)) / elapsed.count(), n_baseline / elapsed.count(),
+            b_match ? "same answer" : "WRONG ANSWER");
+        // Stats are from the checksum run, which does the same amount of work.
+        lines.print_stats(stdout);
+        printf("\n");
+    }
+    b_ok = check_line_endings() && b_ok;
+    return b_ok ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/parse_int.tcc>
+#include <crim/string_view.tcc>
+
+/**
+ * Usage: crim_parse_int [megabytes]
+ *
+ * Checks `crim::parse_uint`, `crim::parse_int` and `crim::extract_all_ints`
+ * against `crim::string_view::to_integer` on random strings, and around the
+ * limits of every integer type. Then pulls every number out of `megabytes`
+ * (default 64) of generated lines shaped like `2023/05-seeds` and
+ * `2023/09-mirage` inputs, the old way and the new way.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+template<class IntT>
+int check_against_to_integer(const std::string &text) {
+    IntT expected = 0;
+    IntT actual = 0;
+    bool b_expected = crim::string_view(text.data(), text.size()).to_integer(expected);
+    bool b_actual = crim::parse_int(text, actual);
+    if (b_expected != b_actual || (b_expected && expected != actual)) {
+        printf("MISMATCH for '%s': to_integer %s %lld, parse_int %s %lld\n", text.c_str(),
+            b_expected ? "ok" : "fail", static_cast<long long>(expected),
+            b_actual ? "ok" : "fail", static_cast<long long>(actual));
+        return 1;
+    }
+    return 0;
+}
+
+template<class IntT>
+int check_all(const std::string &text) {
+    return check_against_to_integer<IntT>(text);
+}
+
+template<class IntT, class Next, class... Rest>
+int check_all(const std::string &text) {
+    return check_against_to_integer<IntT>(text) + check_all<Next, Rest...>(text);
+}
+
+int check_text(const std::string &text) {
+    return check_all<unsigned char, signed char, unsigned short, short, unsigned, int,
+        unsigned long long, long long>(text);
+}
+
+// One digit at a time, the obvious way, to check `extract_all_ints` with.
+std::vector<long long> slow_extract(const std::string &text) {
+    std::vector<long long> numbers;
+    for (size_t i = 0; i < text.size(); /* Empty */) {
+        if (!isdigit(static_cast<unsigned char>(text[i]))) {
+            i++;
+            continue;
+        }
+        bool b_negative = (i > 0 && text[i - 1] == '-');
+        long long n_value = 0;
+        while (i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) {
+            n_value = n_value * 10 + (text[i++] - '0');
+        }
+        numbers.push_back(b_negative ? -n_value : n_value);
+    }
+    return numbers;
+}
+
+int check_parse() {
+    int n_failed = 0;
+    // Right around every limit, with and without leading zeros and signs.
+    const char *edges[] = {
+        "0", "9", "10", "127", "128", "255", "256", "32767", "32768", "65535", "65536",
+        "2147483647", "2147483648", "4294967295", "4294967296",
+        "9223372036854775807", "9223372036854775808", "18446744073709551615",
+        "18446744073709551616", "99999999999999999999", "12345678", "123456789",
+        "1234567812345678", "12345678123456781", "00000000000000000000000255",
+        "0000000000000000000000000256",
+    };
+    for (const char *edge : edges) {
+        for (const char *sign : {"", "-", "+", "--", "-+"}) {
+            n_failed += check_text(std::string(sign) + edge);
+            n_failed += check_text(std::string(sign) + edge + "x");
+        }
+    }
+    n_failed += check_text("");
+    n_failed += check_text("-");
+    n_failed += check_text("x1");
+
+    std::mt19937 rng(1);
+    const char alphabet[] = "0123456789-+ x:";
+    for (int i = 0; i < 200000; i++) {
+        std::string text;
+        size_t n_length = rng() % 26;
+        bool b_digits_only = (rng() % 2 == 0);
+        for (size_t j = 0; j < n_length; j++) {
+            text.push_back(b_digits_only ? '0' + rng() % 10 : alphabet[rng() % (sizeof(alphabet) - 1)]);
+        }
+        n_failed += check_text(text);
+
+        std::vector<long long> actual;
+        crim::extract_all_ints(text, actual);
+        // Past 18 characters `slow_extract` could overflow, so skip those.
+        if (n_length < 19 && actual != slow_extract(text)) {
+            printf("MISMATCH for extract_all_ints('%s')\n", text.c_str());
+            n_failed++;
+        }
+    }
+
+    // Pointer version stops at the first non-digit and says where.
+    const char number[] = "1234567890123 rest";
+    unsigned long long n_value = 0;
+    const char *p_end = crim::parse_uint(number, number + sizeof(number) - 1, n_value);
+    n_failed += (p_end != number + 13 || n_value != 1234567890123ull);
+
+    // Too big for the type is skipped, not split.
+    std::vector<unsigned char> bytes;
+    crim::extract_all_ints(std::string_view("1 300 2, -3"), bytes);
+    n_failed += (bytes != std::vector<unsigned char>{1, 2, 3});
+
+    printf("parse checks: %s (%i failures)\n\n", (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed;
+}
+
+std::string make_numbers(size_t n_bytes) {
+    std::mt19937_64 rng(1);
+    std::string text;
+    text.reserve(n_bytes + 256);
+    while (text.size() < n_bytes) {
+        if (rng() % 2 == 0) {
+            // Seed map line: 3 numbers up to 10 digits.
+            for (int i = 0; i < 3; i++) {
+                text += std::to_string(rng() % 4294967296ull);
+                text.push_back(i == 2 ? '\n' : ' ');
+            }
+        } else {
+            // Mirage line: 21 numbers, small and growing, some negative.
+            long long n_value = static_cast<long long>(rng() % 30) - 10;
+            for (int i = 0; i < 21; i++) {
+                text += std::to_string(n_value);
+                text.push_back(i == 20 ? '\n' : ' ');
+                n_value = n_value * 2 + static_cast<long long>(rng() % 7) - 3;
+            }
+        }
+    }
+    return text;
+}
+
+// Just adds everything up, so we time the parsing and not a `std::vector`.
+struct number_sink {
+    using value_type = long long;
+
+    long long n_sum = 0;
+    size_t n_count = 0;
+
+    void push_back(long long n_value) {
+        n_sum += n_value;
+        n_count++;
+    }
+};
+
+template<class Fn>
+void run_bench(const char *name, const std::string &text, Fn fn) {
+    number_sink out;
+    auto start = bench_clock::now();
+    fn(out);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    printf("%-24s %8.3f s %9.1f MB/s %7.2f ns/number  [%zu numbers, sum %lld]\n", name, elapsed.count(),
+        (text.size() / (1024.0 * 1024.0)) / elapsed.count(), elapsed.count() * 1e9 / out.n_count,
+        out.n_count, out.n_sum);
+}
+
+int main(int argc, char *argv[]) {
+    if (check_parse() != 0) {
+        return 1;
+    }
+    size_t n_megabytes = (argc == 2) ? strtoul(argv[1], NULL, 10) : 64;
+    std::string text = make_numbers(n_megabytes * 1024 * 1024);
+    printf("%.1f MB of seeds/mirage-like lines\n\n", text.size() / (1024.0 * 1024.0));
+
+    // What `cube-conundrum` used to do: copy each token out, then `stoll` it.
+    run_bench("stoll(substr(...))", text, [&](number_sink &out) {
+        size_t n_start = 0;
+        for (size_t i = 0; i <= text.size(); i++) {
+            if (i == text.size() || text[i] == ' ' || text[i] == '\n') {
+                if (i > n_start) {
+                    out.push_back(std::stoll(text.substr(n_start, i - n_start)));
+                }
+                n_start = i + 1;
+            }
+        }
+    });
+
+    run_bench("strtoll", text, [&](number_sink &out) {
+        const char *p_iter = text.c_str();
+        const char *p_end = p_iter + text.size();
+        while (p_iter < p_end) {
+            char *p_next;
+            long long n_value = strtoll(p_iter, &p_next, 10);
+            if (p_next == p_iter) {
+                p_iter++;
+                continue;
+            }
+            out.push_back(n_value);
+            p_iter = p_next;
+        }
+    });
+
+    run_bench("string_view::to_integer", text, [&](number_sink &out) {
+        crim::string_view view(text.data(), text.size());
+        for (crim::string_view line : view.split('\n')) {
+            for (crim::string_view token : line.split(' ')) {
+                long long n_value;
+                if (token.to_integer(n_value)) {
+                    out.push_back(n_value);
+                }
+            }
+        }
+    });
+
+    run_bench("crim::parse_int", text, [&](number_sink &out) {
+        crim::string_view view(text.data(), text.size());
+        for (crim::string_view line : view.split('\n')) {
+            for (crim::string_view token : line.split(' ')) {
+                long long n_value;
+                if (crim::parse_int(token, n_value)) {
+                    out.push_back(n_value);
+                }
+            }
+        }
+    });
+
+    run_bench("crim::extract_all_ints", text, [&](number_sink &out) {
+        crim::extract_all_ints(text, out);
+    });
+    return 0;
+}
@@ -0,0 +1,182 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <type_traits>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/memory.tcc>
+#include <crim/dyarray.tcc>
+
+/**
+ * Usage: crim_pool_allocator [count]
+ *
+ * Allocates and frees `count` (default 1 million) nodes a few different ways
+ * with `std::allocator`, `crim::allocator` and `crim::pool_allocator`.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+// Something about the size of a graph or queue node.
+struct node {
+    node *next;
+    int value;
+    double weight;
+};
+
+constexpr int ROUNDS = 10;
+
+// Allocate everything, then free everything. Freeing is in the same order so
+// the pool's free list ends up reversed for the next round.
+template<class AllocT>
+size_t bench_bulk(size_t count) {
+    using traits = std::allocator_traits<AllocT>;
+    AllocT alloc;
+    node **nodes = static_cast<node **>(malloc(sizeof(node *) * count));
+    size_t sum = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) {
+            nodes[i] = traits::allocate(alloc, 1);
+            nodes[i]->value = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < count; i++) {
+            sum += nodes[i]->value;
+            traits::deallocate(alloc, nodes[i], 1);
+        }
+    }
+    free(nodes);
+    return sum;
+}
+
+// Keep a window of live nodes and keep replacing random ones, like a queue or
+// a graph search would.
+template<class AllocT>
+size_t bench_churn(size_t count) {
+    using traits = std::allocator_traits<AllocT>;
+    constexpr size_t WINDOW = 4096;
+    AllocT alloc;
+    node *live[WINDOW];
+    for (size_t i = 0; i < WINDOW; i++) {
+        live[i] = traits::allocate(alloc, 1);
+        live[i]->value = 0;
+    }
+    unsigned seed = 12345;
+    size_t sum = 0;
+    for (size_t i = 0; i < count * ROUNDS; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t slot = (seed >> 16) % WINDOW;
+        sum += live[slot]->value;
+        traits::deallocate(alloc, live[slot], 1);
+        live[slot] = traits::allocate(alloc, 1);
+        live[slot]->value = static_cast<int>(i);
+    }
+    for (size_t i = 0; i < WINDOW; i++) {
+        traits::deallocate(alloc, live[i], 1);
+    }
+    return sum;
+}
+
+// An actual container that only knows about `std::allocator_traits`. Note that
+// it rebinds our allocator to its own internal node type.
+template<class AllocT>
+size_t bench_list(size_t count) {
+    using list_alloc = typename std::allocator_traits<AllocT>::template rebind_alloc<int>;
+    size_t sum = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        std::list<int, list_alloc> values;
+        for (size_t i = 0; i < count; i++) {
+            values.push_back(static_cast<int>(i));
+        }
+        sum += values.size();
+    }
+    return sum;
+}
+
+void run_bench(const char *name, size_t (*fn)(size_t), size_t count) {
+    auto start = bench_clock::now();
+    size_t checksum = fn(count);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    // Each op is 1 allocation and 1 deallocation.
+    double mops = (count * ROUNDS / 1e6) / elapsed.count();
+    printf("%-32s %9.3f s %9.1f Mops/s (checksum %zu)\n", name, elapsed.count(), mops, checksum);
+}
+
+template<class AllocT>
+void run_all(const char *name, size_t count) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s bulk", name);
+    run_bench(buffer, bench_bulk<AllocT>, count);
+    snprintf(buffer, sizeof(buffer), "%s churn", name);
+    run_bench(buffer, bench_churn<AllocT>, count);
+    snprintf(buffer, sizeof(buffer), "%s std::list", name);
+    run_bench(buffer, bench_list<AllocT>, count);
+    printf("\n");
+}
+
+// `base_dyarray` asks for whole buffers, which go through `crim::allocator`.
+void dyarray_test() {
+    crim::dyarray<int, crim::pool_allocator<int>> values = {1, 2, 3, 4};
+    for (int i = 5; i <= 100; i++) {
+        values.push_back(i);
+    }
+    crim::dyarray<int, crim::pool_allocator<int>> copy = values;
+    int sum = 0;
+    for (int i : copy) {
+        sum += i;
+    }
+    printf("dyarray: %zu elements, sum %i, same pool? %s\n\n",
+        copy.length(), sum, (copy.get_allocator() == values.get_allocator()) ? "true" : "false");
+}
+
+// Rebinds share a pool group, so they compare equal and can free each other's slots.
+void rebind_test() {
+    crim::pool_allocator<int> ints;
+    crim::pool_allocator<node> nodes(ints);
+    crim::pool_allocator<int> back(nodes);
+    node *p_node = nodes.allocate(1);
+    crim::pool_allocator<node>(back).deallocate(p_node, 1);
+    printf("rebind: A(B(a)) == a? %s, B(a) == a? %s\n\n",
+        (back == ints) ? "true" : "false", (nodes == ints) ? "true" : "false");
+}
+
+// `splice()` and `merge()` compare allocators, so they need ours found through ADL.
+void list_test() {
+    using pool_list = std::list<int, crim::pool_allocator<int>>;
+    pool_list evens;
+    for (int i = 0; i < 10; i += 2) {
+        evens.push_back(i);
+    }
+    pool_list odds(evens.get_allocator());
+    for (int i = 1; i < 10; i += 2) {
+        odds.push_back(i);
+    }
+    evens.merge(odds);
+    pool_list tail(evens.get_allocator());
+    tail.splice(tail.end(), evens, std::next(evens.begin(), 5), evens.end());
+    int sum = 0;
+    for (int value : evens) {
+        sum += value;
+    }
+    printf("list: merged and spliced into %zu + %zu elements, sum of first %i\n\n",
+        evens.size(), tail.size(), sum);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (count == 0) {
+        count = 1000000;
+    }
+    dyarray_test();
+    rebind_test();
+    list_test();
+    printf("%zu nodes of %zu bytes, %i rounds\n\n", count, sizeof(node), ROUNDS);
+    run_all<std::allocator<node>>("std::allocator", count);
+    run_all<crim::allocator<node>>("crim::allocator", count);
+    run_all<crim::pool_allocator<node>>("crim::pool_allocator", count);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/base_string.tcc>
+#include <crim/small_dyarray.tcc>
+
+/**
+ * Usage: crim_small_dyarray [count]
+ *
+ * Checks that elements survive spilling to the heap, moving back into the
+ * inline storage and being moved or copied between arrays. Then it builds
+ * `count` (default 10 million) tiny arrays, like the digits of each line of
+ * a puzzle input, with and without inline storage.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+template<class ArrayT>
+void print_array(const char *name, const ArrayT &v) {
+    printf("%s (length %zu, capacity %zu, %s):",
+        name, v.length(), v.capacity(), v.spilled() ? "heap" : "inline");
+    for (const auto &s : v) {
+        printf(" \"%s\"", s.c_str());
+    }
+    printf("\n");
+}
+
+// `std::string` is not trivially relocatable, so it takes the slow paths.
+template<class StringT>
+void small_dyarray_test(const char *name) {
+    printf("%s\n", name);
+    crim::small_dyarray<StringT, 2> v;
+    v.push_back("Hi mom!").push_back("Hello there!");
+    print_array("2 pushed", v);
+    v.emplace_back(v[0]); // Spills, and refers to our own inline element.
+    v.emplace_back("This string is long enough to live on the heap!");
+    print_array("4 pushed", v);
+
+    crim::small_dyarray<StringT, 2> w = v;
+    print_array("copy of it", w);
+    w.pop_back();
+    w.pop_back();
+    w.resize(2); // Back into the inline storage.
+    print_array("2 popped, resized", w);
+
+    crim::small_dyarray<StringT, 2> x = std::move(w); // Inline, so 1 by 1.
+    print_array("moved inline", x);
+    x = std::move(v); // Spilled, so we steal the buffer.
+    print_array("moved spilled", x);
+    print_array("moved-from", v);
+    x.clear();
+    print_array("cleared", x);
+    printf("\n");
+}
+
+// The digits of every line, as in 2023/01's `match_numbers`.
+template<class ArrayT>
+long long bench_lines(size_t count) {
+    long long sum = 0;
+    for (size_t line = 0; line < count; line++) {
+        ArrayT digits;
+        for (size_t i = 0; i < 2 + line % 5; i++) {
+            digits.push_back(static_cast<int>((line + i) % 10));
+        }
+        sum += digits[0] * 10 + digits[digits.size() - 1];
+    }
+    return sum;
+}
+
+// `std::vector` calls it `size()`, we call it `length()`.
+template<class ElemT, size_t N>
+class small_vector_adaptor : public crim::small_dyarray<ElemT, N> {
+public:
+    size_t size() const {
+        return this->length();
+    }
+};
+
+void run_bench(const char *name, long long (*fn)(size_t), size_t count) {
+    auto start = bench_clock::now();
+    long long sum = fn(count);
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    printf("%-32s %9.3f s (checksum %lld)\n", name, elapsed.count(), sum);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (count == 0) {
+        count = 10000000;
+    }
+    small_dyarray_test<crim::cstring>("crim::small_dyarray<crim::cstring, 2>");
+    small_dyarray_test<std::string>("crim::small_dyarray<std::string, 2>");
+
+    printf("%zu lines of 2 to 6 digits\n\n", count);
+    run_bench("std::vector<int>", bench_lines<std::vector<int>>, count);
+    run_bench("crim::small_dyarray<int, 16>", bench_lines<small_vector_adaptor<int, 16>>, count);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/* -*- C -*- */
+#include <stdio.h>
+
+/* -*- C++ -*- */
+#include <string_view>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/base_string.tcc>
+#include <crim/dystring.tcc>
+#include <crim/string_view.tcc>
+
+// Views aren't nul terminated, so print them with a precision.
+void print_view(const char *what, crim::string_view view) {
+    printf("%s: \"%.*s\" (length %zu)\n", what, (int)view.length(), view.data(), view.length());
+}
+
+void find_test() {
+    crim::string_view line = "Game 11: 3 blue, 4 red; 1 red, 2 green";
+    print_view("line", line);
+    printf("find(':') = %zu, find(\"red\") = %zu, find(\"red\", 21) = %zu, rfind(' ') = %zu\n",
+        line.find(':'), line.find("red"), line.find("red", 21), line.rfind(' '));
+    printf("find('x') is npos? %s\n", (line.find('x') == crim::string_view::npos) ? "true" : "false");
+    printf("starts_with(\"Game\"): %i, ends_with(\"green\"): %i, starts_with(\"game\"): %i\n",
+        line.starts_with("Game"), line.ends_with("green"), line.starts_with("game"));
+    print_view("slice(5, 7)", line.slice(5, 7));
+    print_view("slice(100)", line.slice(100));
+    print_view("substr(9, 6)", line.substr(9, 6));
+    printf("\n");
+}
+
+void split_test() {
+    crim::string_view line = "Game 11: 3 blue, 4 red; 1 red, 2 green";
+    crim::string_view head = line.split_first(':');
+    print_view("split_first(':')", head);
+    print_view("rest", line);
+    int n_set = 1;
+    for (crim::string_view set : line.split(';')) {
+        printf("set %i:", n_set++);
+        for (crim::string_view cube : set.split(',')) {
+            cube = cube.trim();
+            printf(" [%.*s]", (int)cube.length(), cube.data());
+        }
+        printf("\n");
+    }
+    // Python would give "a", "", "b", "" here.
+    printf("\"a,,b,\" splits into:");
+    for (crim::string_view piece : crim::string_view("a,,b,").split(',')) {
+        printf(" \"%.*s\"", (int)piece.length(), piece.data());
+    }
+    printf("\n\"\" splits into:");
+    for (crim::string_view piece : crim::string_view("").split(',')) {
+        printf(" \"%.*s\"", (int)piece.length(), piece.data());
+    }
+    printf("\n\n");
+}
+
+void trim_test() {
+    crim::string_view padded = " \t 12 red\r\n";
+    print_view("trim()", padded.trim());
+    print_view("trim_left()", padded.trim_left());
+    print_view("trim_right()", padded.trim_right());
+    print_view("all spaces trimmed", crim::string_view("   ").trim());
+    printf("\n");
+}
+
+void to_integer_test() {
+    const char *inputs[] = {"42", "-17", "+8", "", "-", "12a", "2147483647", "2147483648", "-2147483648"};
+    for (const char *input : inputs) {
+        int value = -1;
+        bool ok = crim::string_view(input).to_integer(value);
+        printf("to_integer(\"%s\"): %s, %i\n", input, ok ? "ok" : "failed", value);
+    }
+    unsigned char byte = 0;
+    bool ok = crim::string_view("ff").to_integer(byte, 16);
+    printf("to_integer(\"ff\", 16) as unsigned char: %s, %u\n", ok ? "ok" : "failed", byte);
+    ok = crim::string_view("-1").to_integer(byte);
+    printf("to_integer(\"-1\") as unsigned char: %s\n\n", ok ? "ok" : "failed");
+}
+
+// Strings of ours, and the standard views we get from `crim::mapped_file`.
+void conversion_test() {
+    crim::cstring s = "This cstring is long enough to be on the heap";
+    crim::string t = "Hi mom!";
+    std::string_view u = "from std::string_view";
+    print_view("crim::cstring", s);
+    print_view("crim::string", t);
+    print_view("std::string_view", u);
+    std::string_view back = crim::string_view(s).slice(5, 12);
+    printf("back to std::string_view: \"%.*s\"\n", (int)back.length(), back.data());
+    printf("s == \"Hi mom!\": %i, t == \"Hi mom!\": %i\n",
+        crim::string_view(s) == "Hi mom!", crim::string_view(t) == "Hi mom!");
+}
+
+int main() {
+    find_test();
+    split_test();
+    trim_test();
+    to_integer_test();
+    conversion_test();
+    return 0;
+}
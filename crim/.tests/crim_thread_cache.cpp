@@ -0,0 +1,116 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+// Every `crim::allocator` in this file goes through the thread cache.
+#define CRIM_ALLOCATOR_USE_THREAD_CACHE
+#include <crim/memory.tcc>
+#include <crim/base_string.tcc>
+#include <crim/dyarray.tcc>
+
+/**
+ * Usage: crim_thread_cache [threads]
+ *
+ * Every thread churns through small allocations, first straight from
+ * `std::malloc` then from `crim::thread_cache`. Afterwards, each thread builds
+ * a bunch of `crim::cstring` and `crim::dyarray` so we see the hit rates of a
+ * more realistic workload.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+constexpr size_t OPS_PER_THREAD = 2000000;
+constexpr size_t WINDOW = 1024;
+
+struct malloc_backend {
+    static void *allocate(size_t n_bytes) { return malloc(n_bytes); }
+    static void deallocate(void *p_memory, size_t) { free(p_memory); }
+};
+
+struct cache_backend {
+    static void *allocate(size_t n_bytes) { return crim::thread_cache::allocate(n_bytes); }
+    static void deallocate(void *p_memory, size_t n_bytes) { crim::thread_cache::deallocate(p_memory, n_bytes); }
+};
+
+// Keep a window of live blocks of 8 to 512 bytes and keep replacing them.
+template<class Backend>
+void churn(unsigned seed) {
+    void *live[WINDOW];
+    size_t sizes[WINDOW];
+    for (size_t i = 0; i < WINDOW; i++) {
+        sizes[i] = 8 << (i % 7);
+        live[i] = Backend::allocate(sizes[i]);
+    }
+    for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t slot = (seed >> 16) % WINDOW;
+        Backend::deallocate(live[slot], sizes[slot]);
+        sizes[slot] = 8 << ((seed >> 8) % 7);
+        live[slot] = Backend::allocate(sizes[slot]);
+        static_cast<char *>(live[slot])[0] = static_cast<char>(i);
+    }
+    for (size_t i = 0; i < WINDOW; i++) {
+        Backend::deallocate(live[i], sizes[i]);
+    }
+}
+
+template<class Backend>
+void run_bench(const char *name, unsigned n_threads) {
+    auto start = bench_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < n_threads; i++) {
+        threads.emplace_back(churn<Backend>, 12345 + i);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    double mops = (n_threads * OPS_PER_THREAD / 1e6) / elapsed.count();
+    printf("%-24s %u threads %9.3f s %9.1f Mops/s\n", name, n_threads, elapsed.count(), mops);
+}
+
+// Lots of strings that outgrow the stack buffer and arrays that keep resizing.
+void containers(int id) {
+    size_t total = 0;
+    for (int round = 0; round < 2000; round++) {
+        crim::dyarray<crim::cstring, crim::allocator<crim::cstring>> lines;
+        for (int i = 0; i < 64; i++) {
+            crim::cstring line;
+            for (int j = 0; j < (i + round + id) % 48; j++) {
+                line.push_back('a' + j % 26);
+            }
+            lines.push_back(crim::rvalue_cast(line));
+        }
+        for (const auto &line : lines) {
+            total += line.length();
+        }
+    }
+    printf("thread %i: %zu chars\n", id, total);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned n_threads = (argc == 2) ? strtoul(argv[1], NULL, 10) : 0;
+    if (n_threads == 0) {
+        n_threads = std::thread::hardware_concurrency();
+    }
+    n_threads = (n_threads == 0) ? 4 : n_threads;
+    run_bench<malloc_backend>("std::malloc", n_threads);
+    run_bench<cache_backend>("crim::thread_cache", n_threads);
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < n_threads; i++) {
+        threads.emplace_back(containers, static_cast<int>(i));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    printf("\n");
+    crim::thread_cache::report(stdout);
+    return 0;
+}
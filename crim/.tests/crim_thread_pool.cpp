@@ -0,0 +1,194 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#include <crim/thread_pool.hpp>
+
+/**
+ * Usage: crim_thread_pool [max threads]
+ *
+ * Checks `crim::thread_pool` first: results, exceptions, nested waits. Then
+ * times 3 workloads with 1, 2, 4... threads up to `max threads` (default:
+ * every core) to see how they scale:
+ *
+ * - "even":   `parallel_for` where every index costs about the same.
+ * - "uneven": `parallel_for` where the cost grows with the index, so a static
+ *             split would leave most threads waiting on the last one.
+ * - "fib":    recursive `submit` and `get`, i.e. fork-join on every level,
+ *             which is nothing but stealing and waiting.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+// Steps for `n` to reach 1 under the Collatz rules. Cheap, but no shortcuts.
+unsigned collatz(unsigned long long n) {
+    unsigned n_steps = 0;
+    while (n != 1) {
+        n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
+        n_steps++;
+    }
+    return n_steps;
+}
+
+long long fib_serial(int n) {
+    return (n < 2) ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+// Below the cutoff a task costs more than the work, so go serial.
+long long fib_pool(crim::thread_pool &pool, int n) {
+    if (n < 20) {
+        return fib_serial(n);
+    }
+    auto left = pool.submit([&pool, n]() {
+        return fib_pool(pool, n - 1);
+    });
+    long long right = fib_pool(pool, n - 2);
+    return left.get() + right;
+}
+
+bool check_pool(size_t n_threads) {
+    crim::thread_pool pool(n_threads);
+    int n_failed = 0;
+
+    auto answer = pool.submit([]() {
+        return 42;
+    });
+    n_failed += (answer.get() != 42);
+    n_failed += answer.valid();
+
+    auto thrower = pool.submit([]() -> int {
+        throw std::runtime_error("Hi mom!");
+    });
+    try {
+        thrower.get();
+        n_failed++;
+    } catch (const std::runtime_error &error) {
+        n_failed += (std::string(error.what()) != "Hi mom!");
+    }
+
+    // Every index exactly once.
+    std::vector<std::atomic<int>> seen(100003);
+    pool.parallel_for(0, seen.size(), [&seen](size_t i) {
+        seen[i].fetch_add(1, std::memory_order_relaxed);
+    }, 7);
+    for (auto &count : seen) {
+        n_failed += (count.load() != 1);
+    }
+
+    try {
+        pool.parallel_for(0, 1000, [](size_t i) {
+            if (i == 777) {
+                throw std::out_of_range("777");
+            }
+        });
+        n_failed++;
+    } catch (const std::out_of_range &error) {
+        n_failed += (std::string(error.what()) != "777");
+    }
+
+    // Waiting from inside tasks must not deadlock, even with 1 thread.
+    n_failed += (fib_pool(pool, 25) != fib_serial(25));
+
+    // Dropped handles still run.
+    std::atomic<int> n_ran{0};
+    for (int i = 0; i < 1000; i++) {
+        pool.submit([&n_ran]() {
+            n_ran.fetch_add(1);
+        });
+    }
+    pool.wait_idle();
+    n_failed += (n_ran.load() != 1000);
+
+    printf("check %2zu threads: %s (%i failures)\n", n_threads, (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed == 0;
+}
+
+template<class Fn>
+double time_it(Fn fn, long long &result) {
+    auto start = bench_clock::now();
+    result = fn();
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    return elapsed.count();
+}
+
+struct baseline {
+    double even = 0.0;
+    double uneven = 0.0;
+    double fib = 0.0;
+};
+
+void run_bench(size_t n_threads, baseline &base) {
+    crim::thread_pool pool(n_threads);
+    const size_t n_count = 4000000;
+    long long n_even = 0;
+    long long n_uneven = 0;
+    long long n_fib = 0;
+
+    double even = time_it([&]() {
+        std::vector<long long> partial(pool.size() + 1, 0);
+        pool.parallel_for(0, n_count, [&](size_t i) {
+            partial[pool.current_worker()] += collatz(i + 1);
+        });
+        long long n_sum = 0;
+        for (long long n : partial) {
+            n_sum += n;
+        }
+        return n_sum;
+    }, n_even);
+
+    double uneven = time_it([&]() {
+        std::vector<long long> partial(pool.size() + 1, 0);
+        pool.parallel_for(0, 4000, [&](size_t i) {
+            // Index `i` does `i` times the work of index 1.
+            for (size_t j = 0; j < i; j++) {
+                partial[pool.current_worker()] += collatz(i * 4000 + j + 1);
+            }
+        });
+        long long n_sum = 0;
+        for (long long n : partial) {
+            n_sum += n;
+        }
+        return n_sum;
+    }, n_uneven);
+
+    double fib = time_it([&]() {
+        return fib_pool(pool, 36);
+    }, n_fib);
+
+    if (n_threads == 1) {
+        base = baseline{even, uneven, fib};
+    }
+    printf("%3zu threads: even %7.3f s (%5.2fx)  uneven %7.3f s (%5.2fx)  fib %7.3f s (%5.2fx)  [%lld %lld %lld]\n",
+        n_threads, even, base.even / even, uneven, base.uneven / uneven, fib, base.fib / fib,
+        n_even, n_uneven, n_fib);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n_maxthreads = (argc == 2) ? strtoul(argv[1], NULL, 10) : std::thread::hardware_concurrency();
+    n_maxthreads = (n_maxthreads == 0) ? 1 : n_maxthreads;
+
+    bool b_ok = check_pool(1);
+    b_ok = check_pool(4) && b_ok;
+    b_ok = check_pool(n_maxthreads) && b_ok;
+    if (!b_ok) {
+        return 1;
+    }
+
+    printf("\n%zu hardware threads\n\n", static_cast<size_t>(std::thread::hardware_concurrency()));
+    baseline base;
+    // Doubling each time, but always ending on exactly the maximum, e.g. 4 then 6.
+    for (size_t n_threads = 1; n_threads != 0; n_threads = (n_threads == n_maxthreads) ? 0
+            : (n_threads * 2 < n_maxthreads) ? n_threads * 2 : n_maxthreads) {
+        run_bench(n_threads, base);
+    }
+    return 0;
+}
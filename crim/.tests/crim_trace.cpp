@@ -0,0 +1,178 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#define CRIM_TRACE
+#include <crim/trace.hpp>
+
+/**
+ * Usage: crim_trace [zones]
+ *
+ * Records nested zones on a few threads, writes them out and reads the JSON
+ * back to check every zone made it, on the right thread and inside its
+ * parent. Then times `zones` (default 1 million) empty zones, and splits that
+ * into recording them, which should stay under 20 ns, and reading the clock
+ * twice. Also times reading `steady_clock` twice, which is what a zone would
+ * cost without the TSC.
+ *
+ * The trace itself goes to `crim_trace_test.json`, then again at exit.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+constexpr int N_THREADS = 4;
+constexpr int N_OUTER = 100;
+constexpr int N_INNER = 10;
+
+struct zone {
+    std::string name;
+    unsigned tid;
+    double ts;
+    double dur;
+};
+
+// One event per line, so a full JSON parser would be overkill.
+std::vector<zone> read_zones(const char *path) {
+    std::vector<zone> zones;
+    FILE *p_file = fopen(path, "r");
+    if (p_file == NULL) {
+        return zones;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), p_file) != NULL) {
+        char name[64];
+        zone z;
+        if (strstr(line, "\"ph\":\"X\"") != NULL
+            && sscanf(line, "%*[^:]:\"%63[^\"]\",\"cat\":\"crim\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lf,\"dur\":%lf",
+                name, &z.tid, &z.ts, &z.dur) == 4) {
+            z.name = name;
+            zones.push_back(z);
+        }
+    }
+    fclose(p_file);
+    return zones;
+}
+
+volatile unsigned sink;
+
+void do_work(unsigned n_iterations) {
+    unsigned n_value = 0;
+    for (unsigned i = 0; i < n_iterations; i++) {
+        n_value = n_value * 31 + i;
+    }
+    sink = n_value;
+}
+
+int check_trace() {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < N_THREADS; t++) {
+        threads.emplace_back([]() {
+            crim_trace_thread_name("worker");
+            for (int i = 0; i < N_OUTER; i++) {
+                crim_trace_scope("outer");
+                for (int j = 0; j < N_INNER; j++) {
+                    crim_trace_scope("inner");
+                    do_work(100);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const char *path = "crim_trace_test.json";
+    long n_written = crim::tracer::write(path);
+    std::vector<zone> zones = read_zones(path);
+
+    int n_failed = 0;
+    size_t n_outer = 0;
+    size_t n_inner = 0;
+    size_t n_escaped = 0;
+    for (const zone &z : zones) {
+        n_outer += (z.name == "outer");
+        n_inner += (z.name == "inner");
+    }
+    // Every inner zone fits inside an outer one on the same thread. Zones are
+    // written in the order they finished, so the parent comes after them.
+    for (size_t i = 0; i < zones.size(); i++) {
+        if (zones[i].name != "inner") {
+            continue;
+        }
+        bool b_inside = false;
+        for (size_t j = i + 1; j < zones.size() && !b_inside; j++) {
+            const zone &parent = zones[j];
+            b_inside = parent.name == "outer" && parent.tid == zones[i].tid && parent.ts <= zones[i].ts
+                && zones[i].ts + zones[i].dur <= parent.ts + parent.dur + 0.001;
+        }
+        n_escaped += !b_inside;
+    }
+    if (n_outer != N_THREADS * N_OUTER || n_inner != N_THREADS * N_OUTER * N_INNER) {
+        printf("FAILED: expected %i outer and %i inner zones, got %zu and %zu\n",
+            N_THREADS * N_OUTER, N_THREADS * N_OUTER * N_INNER, n_outer, n_inner);
+        n_failed++;
+    }
+    if (n_written != static_cast<long>(zones.size()) + N_THREADS) {
+        printf("FAILED: wrote %ld events but read back %zu zones\n", n_written, zones.size());
+        n_failed++;
+    }
+    if (n_escaped != 0) {
+        printf("FAILED: %zu inner zones aren't inside an outer zone\n", n_escaped);
+        n_failed++;
+    }
+    printf("trace checks: %s (%i failures)\n\n", (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed;
+}
+
+int main(int argc, char *argv[]) {
+    setenv("CRIM_TRACE_FILE", "crim_trace_test.json", 1);
+    if (check_trace() != 0) {
+        return 1;
+    }
+    int n_zones = (argc == 2) ? atoi(argv[1]) : 1000000;
+
+    auto start = bench_clock::now();
+    for (int i = 0; i < n_zones; i++) {
+        crim_trace_scope("empty");
+    }
+    std::chrono::duration<double, std::nano> n_traced = bench_clock::now() - start;
+
+    // Just the bookkeeping, with the clock reads taken out.
+    static constexpr crim::trace_site site{"record", crim_loginfo(__LINE__)};
+    start = bench_clock::now();
+    for (int i = 0; i < n_zones; i++) {
+        crim::tracer::record(site, static_cast<std::uint64_t>(i), static_cast<std::uint64_t>(i) + 1);
+    }
+    std::chrono::duration<double, std::nano> n_record = bench_clock::now() - start;
+
+    start = bench_clock::now();
+    unsigned long long n_ticks = 0;
+    for (int i = 0; i < n_zones; i++) {
+        std::uint64_t n_begin = crim::tracer::now();
+        n_ticks += crim::tracer::now() - n_begin;
+    }
+    std::chrono::duration<double, std::nano> n_now = bench_clock::now() - start;
+
+    start = bench_clock::now();
+    long long n_total = 0;
+    for (int i = 0; i < n_zones; i++) {
+        auto begin = bench_clock::now();
+        n_total += (bench_clock::now() - begin).count();
+    }
+    std::chrono::duration<double, std::nano> n_clock = bench_clock::now() - start;
+
+    printf("%i empty zones\n", n_zones);
+    printf("crim_trace_scope       %6.1f ns/zone\n", n_traced.count() / n_zones);
+    printf("crim::tracer::record() %6.1f ns/zone, all of it but the clock\n", n_record.count() / n_zones);
+    printf("2x crim::tracer::now() %6.1f ns (%llu ticks measured)\n", n_now.count() / n_zones, n_ticks);
+    printf("2x steady_clock::now() %6.1f ns (%lld ns measured)\n", n_clock.count() / n_zones, n_total);
+    return 0;
+}
@@ -0,0 +1,193 @@
+/* -*- C -*- */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -*- C++ -*- */
+#include <chrono>
+#include <list>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* -*- MY DATA STRUCTURES -*- */
+#define CRIM_TRACK_ALLOCATIONS
+#include <crim/tracking_allocator.tcc>
+#include <crim/dyarray.tcc>
+
+/**
+ * Usage: crim_tracking_allocator [count]
+ *
+ * Checks that `crim::tracking_allocator` puts every allocation, free and
+ * growth down to the right call site, even across scopes and threads, and that
+ * the sizes land in the right buckets. Then pushes `count` (default 1 million)
+ * ints onto `crim::dyarray`s with and without tracking to show what it costs.
+ *
+ * The full report is printed to `stderr` at exit.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+template<class T>
+using tracked = crim::tracking_allocator<crim::allocator<T>>;
+
+static_assert(sizeof(tracked<int>) == sizeof(crim::allocator<int>), "Tracking shouldn't add any state!");
+static_assert(crim::has_reallocate<tracked<int>>::value, "crim::allocator can reallocate, so we should too!");
+static_assert(!crim::has_reallocate<crim::tracking_allocator<std::allocator<int>>>::value,
+    "std::allocator can't reallocate, so we shouldn't either!");
+
+int check(bool b_ok, const char *what) {
+    if (!b_ok) {
+        printf("FAILED: %s\n", what);
+    }
+    return b_ok ? 0 : 1;
+}
+
+int check_sites() {
+    int n_failed = 0;
+    static crim::alloc_site site_grow{"grow"};
+    static crim::alloc_site site_vector{"vector"};
+    static crim::alloc_site site_list{"list"};
+    static crim::alloc_site site_outer{"outer"};
+    static crim::alloc_site site_inner{"inner"};
+    static crim::alloc_site site_sizes{"sizes"};
+
+    // crim::dyarray grows with reallocate, and the live bytes follow it.
+    {
+        crim::alloc_scope scope(site_grow);
+        crim::dyarray<int, tracked<int>> values;
+        for (int i = 0; i < 1000; i++) {
+            values.push_back(i);
+        }
+        crim::alloc_site::stats s = site_grow.get_stats();
+        n_failed += check(s.allocs == 1 && s.reallocs > 0, "dyarray allocates once then reallocates");
+        n_failed += check(s.live == values.capacity() * sizeof(int), "live bytes are the capacity");
+        n_failed += check(s.peak == s.live, "peak is the biggest it got");
+    }
+    crim::alloc_site::stats s = site_grow.get_stats();
+    n_failed += check(s.frees == 1 && s.live == 0, "dyarray frees everything");
+
+    // std::vector can't reallocate, so it's allocate, copy, free every time.
+    {
+        crim::alloc_scope scope(site_vector);
+        std::vector<int, crim::tracking_allocator<std::allocator<int>>> values;
+        for (int i = 0; i < 1000; i++) {
+            values.push_back(i);
+        }
+    }
+    s = site_vector.get_stats();
+    n_failed += check(s.allocs > 1 && s.allocs == s.frees && s.reallocs == 0, "vector allocates and frees");
+    n_failed += check(s.live == 0 && s.peak > 1000 * sizeof(int), "vector peak covers old and new buffers");
+
+    // Rebinding keeps tracking, and the pool still gets 1 node at a time.
+    // Splicing compares allocators, so that has to find ours through ADL.
+    {
+        crim::alloc_scope scope(site_list);
+        using tracked_list = std::list<int, crim::tracking_allocator<crim::pool_allocator<int>>>;
+        tracked_list values;
+        tracked_list more(values.get_allocator());
+        for (int i = 0; i < 100; i++) {
+            (i % 2 == 0 ? values : more).push_back(i);
+        }
+        values.splice(values.end(), more);
+        n_failed += check(values.size() == 100 && more.empty(), "list splices");
+    }
+    s = site_list.get_stats();
+    n_failed += check(s.allocs == 100 && s.frees == 100 && s.live == 0, "list nodes through the pool");
+
+    // Freed somewhere else, but still counted where it was allocated.
+    tracked<char> alloc;
+    char *p_outer;
+    {
+        crim::alloc_scope outer(site_outer);
+        p_outer = alloc.allocate(10);
+        {
+            crim::alloc_scope inner(site_inner);
+            alloc.deallocate(p_outer, 10);
+            p_outer = alloc.allocate(20);
+        }
+        n_failed += check(&crim::alloc_site::current() == &site_outer, "scopes restore the outer site");
+    }
+    alloc.deallocate(p_outer, 20);
+    s = site_outer.get_stats();
+    n_failed += check(s.allocs == 1 && s.frees == 1 && s.live == 0, "outer site owns its free");
+    s = site_inner.get_stats();
+    n_failed += check(s.allocs == 1 && s.frees == 1 && s.live == 0, "inner site owns its free");
+
+    // Sizes go to the smallest power of 2 that holds them.
+    {
+        crim::alloc_scope scope(site_sizes);
+        for (size_t n_size : {1, 2, 3, 4, 5, 1024, 1025}) {
+            alloc.deallocate(alloc.allocate(n_size), n_size);
+        }
+    }
+    s = site_sizes.get_stats();
+    n_failed += check(s.histogram[0] == 1 && s.histogram[1] == 1 && s.histogram[2] == 2 && s.histogram[3] == 1
+        && s.histogram[10] == 1 && s.histogram[11] == 1, "size histogram");
+    n_failed += check(s.bytes == 1 + 2 + 3 + 4 + 5 + 1024 + 1025, "total bytes");
+
+    // Every thread has its own scopes, but they all count into the same site.
+    static crim::alloc_site site_threads{"threads"};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            crim::alloc_scope scope(site_threads);
+            crim::dyarray<int, tracked<int>> values;
+            for (int i = 0; i < 10000; i++) {
+                values.push_back(i);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    s = site_threads.get_stats();
+    n_failed += check(s.allocs == 4 && s.frees == 4 && s.live == 0, "threads count into the same site");
+
+    printf("tracking_allocator checks: %s (%i failures)\n\n", (n_failed == 0) ? "ok" : "FAILED", n_failed);
+    return n_failed;
+}
+
+template<class ArrayT>
+double time_pushes(int n_count) {
+    auto start = bench_clock::now();
+    ArrayT values;
+    for (int i = 0; i < n_count; i++) {
+        values.push_back(i);
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    return elapsed.count();
+}
+
+// Lots of small blocks, which is where a side table lookup per call shows.
+template<class AllocT>
+double time_churn(int n_count) {
+    AllocT alloc;
+    auto start = bench_clock::now();
+    for (int i = 0; i < n_count; i++) {
+        int *p_memory = alloc.allocate(4);
+        p_memory[0] = i;
+        alloc.deallocate(p_memory, 4);
+    }
+    std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    if (check_sites() != 0) {
+        return 1;
+    }
+    int n_count = (argc == 2) ? atoi(argv[1]) : 1000000;
+    crim_track_allocations();
+    double n_plain = time_pushes<crim::dyarray<int>>(n_count);
+    double n_tracked = time_pushes<crim::dyarray<int, tracked<int>>>(n_count);
+    printf("push_back %i ints\n", n_count);
+    printf("crim::allocator          %8.3f ms\n", n_plain * 1e3);
+    printf("crim::tracking_allocator %8.3f ms (%.2fx)\n\n", n_tracked * 1e3, n_tracked / n_plain);
+
+    n_plain = time_churn<crim::allocator<int>>(n_count);
+    n_tracked = time_churn<tracked<int>>(n_count);
+    printf("allocate and free %i blocks of 16 bytes\n", n_count);
+    printf("crim::allocator          %8.1f ns/block\n", n_plain * 1e9 / n_count);
+    printf("crim::tracking_allocator %8.1f ns/block (%.2fx)\n\n", n_tracked * 1e9 / n_count, n_tracked / n_plain);
+    return 0;
+}
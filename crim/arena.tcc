@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cstddef> /* std::size_t, std::max_align_t */
+#include <cstdint> /* std::uintptr_t */
+#include <cstdlib> /* std::malloc, std::free */
+#include <new> /* std::bad_alloc, std::bad_array_new_length */
+#include <type_traits> /* std::true_type */
+
+#include "logerror.hpp"
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::arena", func, info)
+
+namespace crim {
+    class arena;
+
+    template<class T>
+    struct arena_allocator;
+};
+
+/**
+ * BEGIN: ARENA IMPLEMENTATION -*-----------------------------------------------
+ */
+
+/**
+ * @brief   A monotonic (bump) allocator. Allocating is just rounding up the
+ *          cursor and moving it forward. Individual frees do nothing, except
+ *          for the most recent allocation which can be given back.
+ *
+ *          Use it for lots of small allocations that all die together, such
+ *          as every line of an input file. Call `reset()` when you're done
+ *          with them and the memory is reused for the next file.
+ *
+ * @note    Memory comes in blocks from `std::malloc`. Blocks are only freed by
+ *          `release()` or the destructor, `reset()` keeps them all around.
+ */
+class crim::arena {
+private:
+    /**
+     * Header at the start of every block. The usable memory comes right after
+     * it. Blocks form a singly linked list in the order they were allocated.
+     */
+    struct block {
+        block *next;
+        std::size_t size; // Usable bytes, not counting this header.
+    };
+
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    block *m_phead; // Very first block. `reset()` goes back to this.
+    block *m_pcurrent; // Block we're bumping in right now.
+    char *m_pcursor; // Next free byte in `m_pcurrent`.
+    char *m_plimit; // 1 past the last usable byte of `m_pcurrent`.
+    std::size_t m_nblocksize; // Minimum size of new blocks.
+    std::size_t m_ncapacity; // Usable bytes across all blocks.
+
+public:
+    /* -*- CONSTRUCTORS, DESTRUCTORS -*- */
+
+    explicit arena(std::size_t n_blocksize = DEFAULT_BLOCK_SIZE) noexcept
+        : m_phead{nullptr}
+        , m_pcurrent{nullptr}
+        , m_pcursor{nullptr}
+        , m_plimit{nullptr}
+        , m_nblocksize{n_blocksize}
+        , m_ncapacity{0}
+    {}
+
+    // Allocators hold pointers to us, so we can't be copied or moved.
+    arena(const arena &other) = delete;
+    arena &operator=(const arena &other) = delete;
+
+    ~arena()
+    {
+        release();
+    }
+
+    /* -*- ALLOCATION -*- */
+
+    /**
+     * @brief   Bump-allocates `n_bytes` aligned to `n_align`, which must be a
+     *          power of 2. Gets a new block if the current one is full.
+     *
+     * @exception   `std::bad_alloc` if we couldn't get a new block.
+     */
+    void *allocate(std::size_t n_bytes, std::size_t n_align = alignof(std::max_align_t))
+    {
+        char *p_memory = align_up(m_pcursor, n_align);
+        if (m_pcursor == nullptr || p_memory + n_bytes > m_plimit) {
+            next_block(n_bytes + n_align);
+            p_memory = align_up(m_pcursor, n_align);
+        }
+        m_pcursor = p_memory + n_bytes;
+        return p_memory;
+    }
+
+    /**
+     * @brief   Only the most recent allocation can actually be given back. It's
+     *          common enough, e.g. a growing buffer that was just allocated.
+     *          Everything else stays put until `reset()`.
+     */
+    void deallocate(void *p_memory, std::size_t n_bytes) noexcept
+    {
+        char *p_bytes = static_cast<char *>(p_memory);
+        if (p_bytes != nullptr && p_bytes + n_bytes == m_pcursor) {
+            m_pcursor = p_bytes;
+        }
+    }
+
+    /**
+     * @brief   Forget every allocation at once in O(1). All blocks are kept so
+     *          the next round of allocations doesn't have to `malloc` again.
+     *
+     * @warning Anything still pointing into the arena is now dangling!
+     */
+    void reset() noexcept
+    {
+        m_pcurrent = m_phead;
+        if (m_phead != nullptr) {
+            m_pcursor = data(m_phead);
+            m_plimit = m_pcursor + m_phead->size;
+        }
+    }
+
+    /**
+     * @brief   Actually gives all blocks back to `std::free`.
+     */
+    void release() noexcept
+    {
+        while (m_phead != nullptr) {
+            block *p_next = m_phead->next;
+            std::free(m_phead);
+            m_phead = p_next;
+        }
+        m_pcurrent = nullptr;
+        m_pcursor = nullptr;
+        m_plimit = nullptr;
+        m_ncapacity = 0;
+    }
+
+    /* -*- STATISTICS -*- */
+
+    // Total usable bytes held across all our blocks.
+    std::size_t capacity() const noexcept
+    {
+        return m_ncapacity;
+    }
+
+    // Bytes bumped past so far, counting padding and earlier blocks' leftovers.
+    std::size_t used() const noexcept
+    {
+        std::size_t n_used = 0;
+        for (block *p_iter = m_phead; p_iter != m_pcurrent; p_iter = p_iter->next) {
+            n_used += p_iter->size;
+        }
+        return (m_pcurrent == nullptr) ? 0 : n_used + (m_pcursor - data(m_pcurrent));
+    }
+
+private:
+    static char *data(block *p_block) noexcept
+    {
+        return reinterpret_cast<char *>(p_block + 1);
+    }
+
+    static char *align_up(char *p_memory, std::size_t n_align) noexcept
+    {
+        std::uintptr_t n_address = reinterpret_cast<std::uintptr_t>(p_memory);
+        n_address = (n_address + n_align - 1) & ~(n_align - 1);
+        return reinterpret_cast<char *>(n_address);
+    }
+
+    /**
+     * @brief   Move on to the next block that can fit `n_bytes`. Blocks kept
+     *          from before a `reset()` are reused first. Otherwise we allocate
+     *          a new one right after the current block.
+     */
+    void next_block(std::size_t n_bytes)
+    {
+        block *p_next = (m_pcurrent == nullptr) ? m_phead : m_pcurrent->next;
+        if (p_next == nullptr || p_next->size < n_bytes) {
+            std::size_t n_size = (n_bytes > m_nblocksize) ? n_bytes : m_nblocksize;
+            p_next = static_cast<block *>(std::malloc(sizeof(block) + n_size));
+            if (p_next == nullptr) {
+                crim_logerror("next_block", "Failed to allocate memory!");
+                throw std::bad_alloc();
+            }
+            p_next->size = n_size;
+            m_ncapacity += n_size;
+            // Splice it in so the rest of the chain is still reachable.
+            if (m_pcurrent == nullptr) {
+                p_next->next = m_phead;
+                m_phead = p_next;
+            } else {
+                p_next->next = m_pcurrent->next;
+                m_pcurrent->next = p_next;
+            }
+        }
+        m_pcurrent = p_next;
+        m_pcursor = data(p_next);
+        m_plimit = m_pcursor + p_next->size;
+    }
+};
+
+/**
+ * END: ARENA IMPLEMENTATION -*-------------------------------------------------
+ */
+
+/**
+ * BEGIN: ARENA ALLOCATOR IMPLEMENTATION -*-------------------------------------
+ */
+
+/**
+ * @brief   Adapts a `crim::arena` to the standard allocator interface, so that
+ *          containers like `crim::dyarray` and `crim::base_string` can use it.
+ *
+ *          Copies refer to the same arena. Containers take their allocator
+ *          along when they're copy/move-assigned, so strings that were default
+ *          constructed then assigned still end up in the right arena.
+ *
+ * @warning Default constructed instances don't refer to any arena! They're
+ *          fine for empty containers but will throw if they ever allocate.
+ */
+template<class T>
+struct crim::arena_allocator {
+    using value_type = T;
+    using size_type = std::size_t;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    arena *m_parena;
+
+    arena_allocator() noexcept
+        : m_parena{nullptr}
+    {}
+
+    arena_allocator(arena &resource) noexcept
+        : m_parena{&resource}
+    {}
+
+    // Converting copy-constructor, e.g. for `std::allocator_traits::rebind`.
+    template<class OtherT>
+    arena_allocator(const arena_allocator<OtherT> &other) noexcept
+        : m_parena{other.m_parena}
+    {}
+
+    /**
+     * @exception   `std::bad_array_new_length`, `std::bad_alloc()`.
+     */
+    T *allocate(size_type n_count)
+    {
+        if (n_count > static_cast<size_type>(-1) / sizeof(T)) {
+            crim_logerror("allocate", "Requested too much memory!");
+            throw std::bad_array_new_length();
+        } else if (m_parena == nullptr) {
+            crim_logerror("allocate", "Allocator has no arena!");
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(m_parena->allocate(sizeof(T) * n_count, alignof(T)));
+    }
+
+    void deallocate(T *p_memory, size_type n_count) noexcept
+    {
+        if (m_parena != nullptr) {
+            m_parena->deallocate(p_memory, sizeof(T) * n_count);
+        }
+    }
+
+    // Memory from one arena can only be given back to that very same arena.
+    // Friends so `std` containers find them through ADL.
+    template<class OtherT>
+    friend bool operator==(const arena_allocator &lhs, const arena_allocator<OtherT> &rhs) noexcept
+    {
+        return lhs.m_parena == rhs.m_parena;
+    }
+
+    template<class OtherT>
+    friend bool operator!=(const arena_allocator &lhs, const arena_allocator<OtherT> &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+};
+
+/**
+ * END: ARENA ALLOCATOR IMPLEMENTATION -*---------------------------------------
+ */
+
+#undef crim_logerror
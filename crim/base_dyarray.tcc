@@ -7,11 +7,16 @@
 /*- -*-  THE C++ STANDARD LIBRARY -*- -*/
 #include <algorithm>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
-#include <functional>
+#include <type_traits>
+#include <utility>
 
 /*- -*-  REINVENTING THE WHEEL LIBRARY -*- -*/
 #include "iterator.tcc"
+#include "memory.tcc"
+#include "type_traits.tcc"
 
 /**
  * @brief   Classes that inherit from parents can be forward declared, but the
@@ -46,9 +51,10 @@ namespace crim {
      * @tparam  DerivedT    The derived class's name, usually the templated name.
      * @tparam  ElemT       Buffer's element type.
      * @tparam  AllocT      Desired allocator, based off of `std::allocator`.
+     *                      `crim::allocator` can `reallocate` our buffer.
      */
     template<
-        class DerivedT, class ElemT, class AllocT = std::allocator<ElemT>
+        class DerivedT, class ElemT, class AllocT = crim::allocator<ElemT>
     > class base_dyarray;
 };
 
@@ -66,6 +72,14 @@ private:
 
     using Malloc = std::allocator_traits<AllocT>;
 
+public:
+    using allocator_type = AllocT;
+
+    // `move()` can always just steal the buffer of the other instance.
+    static constexpr bool is_nothrow_move_assignable = 
+        Malloc::propagate_on_container_move_assignment::value 
+        || Malloc::is_always_equal::value;
+
 protected:
     static constexpr size_t DYARRAY_START_CAPACITY = 16;
     static constexpr size_t DYARRAY_MAX_CAPACITY = 0xFFFFFFFF; // 1-based.
@@ -79,9 +93,14 @@ protected:
     // NOTICE: These are protected to avoid users calling these by themselves!
     // See: https://www.reddit.com/r/cpp/comments/lhvkzs/comment/gn3nmsx/
 
-    // Primary delegated constructor.
-    base_dyarray(size_t n_length, size_t n_capacity, ElemT *p_memory)
-    : m_malloc{}
+    /**
+     * @brief   Primary delegated constructor.
+     * 
+     * @note    Stateful allocators, e.g. `crim::arena_allocator`, are copied in
+     *          here. Stateless ones like `std::allocator` don't care.
+     */
+    base_dyarray(size_t n_length, size_t n_capacity, ElemT *p_memory, const AllocT &alloc)
+    : m_malloc{alloc}
     , m_nlength{n_length}
     , m_ncapacity{n_capacity}
     , m_pbuffer{p_memory}
@@ -89,16 +108,26 @@ protected:
     {}
 
     // Default constructor, zeroes out the memory.
-    base_dyarray() : base_dyarray(0, 0, nullptr) {}
+    base_dyarray() : base_dyarray(AllocT()) {}
+
+    // Same as the default constructor, but with an allocator to use later.
+    explicit base_dyarray(const AllocT &alloc) 
+    : base_dyarray(0, 0, nullptr, alloc) 
+    {}
     
     /**
      * @brief   Secondary delegated constructor which takes care of allocating 
      *          the correct amount of memory. It in turn delegates to the
      *          primary delegated constructor.
+     * 
+     * @note    We can't allocate in the initializer list as `m_malloc` isn't
+     *          constructed yet at that point, so allocate in the body instead.
      */
-    base_dyarray(size_t n_length, size_t n_capacity) 
-    : base_dyarray(n_length, n_capacity, Malloc::allocate(m_malloc, n_capacity)) 
-    {}
+    base_dyarray(size_t n_length, size_t n_capacity, const AllocT &alloc = AllocT()) 
+    : base_dyarray(n_length, n_capacity, nullptr, alloc) {
+        m_pbuffer = Malloc::allocate(m_malloc, n_capacity);
+        m_iterator.set_range(m_pbuffer, m_nlength);
+    }
 
     /**
      * @brief   Constructor for "array literals" (curly brace literals) which
@@ -108,20 +137,26 @@ protected:
      * 
      *          Upon an append/push_back, this will likely cause a realloc.
      */
-    base_dyarray(std::initializer_list<ElemT> list) 
-    : base_dyarray(list.size(), list.size()) {
-        // this->begin() should be the non-const version even if we're const
-        std::copy(list.begin(), list.end(), begin());
+    base_dyarray(std::initializer_list<ElemT> list, const AllocT &alloc = AllocT()) 
+    : base_dyarray(list.size(), list.size(), alloc) {
+        // Buffer is uninitialized so copy-construct, don't copy-assign.
+        std::uninitialized_copy(list.begin(), list.end(), begin());
     }
 
     /**
      * @brief   Copy-constructor, it allocates enough memory for the buffer
      *          hold `src`'s data buffer, then it deep-copies them.
+     * 
+     * @note    The allocator gets to decide what a copy of it should be.
      */
     base_dyarray(const base_dyarray &src) 
-    : base_dyarray(src.length(), src.capacity()) {
-        // this->begin() should be the non-const version even if we're const
-        std::copy(src.begin(), src.end(), begin());
+    : base_dyarray(
+        src.length(), 
+        src.capacity(), 
+        Malloc::select_on_container_copy_construction(src.m_malloc)
+    ) {
+        // Buffer is uninitialized so copy-construct, don't copy-assign.
+        std::uninitialized_copy(src.begin(), src.end(), begin());
     }
 
     /**
@@ -133,8 +168,8 @@ protected:
      * 
      * @note    [See here for help.](https://learn.microsoft.com/en-us/cpp/cpp/move-constructors-and-move-assignment-operators-cpp?view=msvc-170)
      */
-    base_dyarray(base_dyarray &&tmp) 
-    : base_dyarray(tmp.length(), tmp.capacity(), tmp.begin()) {
+    base_dyarray(base_dyarray &&tmp) noexcept
+    : base_dyarray(tmp.length(), tmp.capacity(), tmp.begin(), tmp.m_malloc) {
         tmp.reset();
     }
 
@@ -149,7 +184,57 @@ protected:
      *          need to manually destroy `m_pbuffer[length()-1 ... capacity()]`.
      */
     ~base_dyarray() {
-        // Malloc::deallocate doesn't accept nullptr so let's avoid that.
+        destroy_buffer();
+    }
+
+    /* -*-  INLINE STORAGE -*- */
+    // Derived classes with a buffer of their own, e.g. `crim::small_dyarray`,
+    // shadow these two. We have none, so checks against them fold away.
+
+    ElemT *local_buffer() {
+        return nullptr;
+    }
+
+    static constexpr size_t local_capacity() {
+        return 0;
+    }
+
+private:
+    // Is `p_buffer` the derived class's inline storage? Never free that!
+    bool is_local(const ElemT *p_buffer) {
+        const ElemT *p_local = derived_cast().local_buffer();
+        return p_local != nullptr && p_buffer == p_local;
+    }
+
+    /**
+     * @brief   Where a buffer for `n_capacity` elements should live: the inline
+     *          storage if there is some and it's big enough, else the heap.
+     * 
+     * @note    For plain `crim::dyarray`, asking for 0 elements gets `nullptr`.
+     */
+    ElemT *new_buffer(size_t n_capacity) {
+        if (n_capacity <= DerivedT::local_capacity()) {
+            return derived_cast().local_buffer();
+        }
+        return Malloc::allocate(m_malloc, n_capacity);
+    }
+
+    // Malloc::deallocate doesn't accept nullptr, nor our inline storage.
+    void free_buffer(ElemT *p_buffer, size_t n_capacity) {
+        if (p_buffer != nullptr && !is_local(p_buffer)) {
+            Malloc::deallocate(m_malloc, p_buffer, n_capacity);
+        }
+    }
+
+    /**
+     * @brief   Destroys all our elements and gives the buffer back to the
+     *          allocator, but leaves our members dangling.
+     * 
+     * @note    Derived classes with inline storage must set `m_pbuffer` to 
+     *          `nullptr` in their destructor, as they're gone by the time ours
+     *          runs and we can't ask them about it anymore.
+     */
+    void destroy_buffer() {
         // Conditional jump or move depends on uninitizlised value(s)?
         if (m_pbuffer != nullptr) {
             // Destroy all constructed objects we have, because memory is hard.
@@ -157,24 +242,35 @@ protected:
                 Malloc::destroy(m_malloc, &m_pbuffer[i]);
             }
             // Only after instances are destroyed can we get rid of the pointer.
-            Malloc::deallocate(m_malloc, m_pbuffer, capacity());
+            free_buffer(m_pbuffer, capacity());
         }
     }
 
-private:
+    /**
+     * @brief   Destroys all our elements and gives the buffer back to the
+     *          allocator, then zeroes out the memory via `reset()`.
+     * 
+     *          Use this instead of explicitly calling our destructor.
+     */
+    void release() {
+        destroy_buffer();
+        reset();
+    }
+
     /**
      * @brief   Effectively zeroes out the memory.
      * 
      *          Primarily to erase `m_pbuffer` of temporary instances so that
      *          when they're destroyed the memory pointed is safe from deletion.
+     *          If the derived class has inline storage, we point back to it.
      * 
      * @warning Assumes you've taken care of freeing/moving memory properly!
      */
     void reset() {
         m_nlength = 0;
-        m_ncapacity = 0;
-        m_pbuffer = nullptr;
-        m_iterator.set_range(nullptr, 0);
+        m_ncapacity = DerivedT::local_capacity();
+        m_pbuffer = derived_cast().local_buffer();
+        m_iterator.set_range(m_pbuffer, 0);
     }
 
 public:
@@ -310,49 +406,105 @@ public:
         // Don't copy ourselves, copying overlapping memory won't end well.
         if (this != &src) {
             // Clear any constructed instances and heap-allocated memory.
-            this->~base_dyarray();
+            // This must use our old allocator, so do it before we take theirs.
+            release();
+            if constexpr (Malloc::propagate_on_container_copy_assignment::value) {
+                m_malloc = src.m_malloc;
+            }
 
             // Deep-copy only up to last written index to avoid unitialized 
-            // memory. std::copy calls copy-constructor for each non-trivial.
-            m_pbuffer = Malloc::allocate(m_malloc, src.capacity());
-            std::copy(src.begin(), src.end(), begin());
+            // memory. Copy-construct each element since the buffer is raw.
+            if (src.capacity() > m_ncapacity) {
+                m_pbuffer = new_buffer(src.capacity());
+                m_ncapacity = src.capacity();
+            }
+            std::uninitialized_copy(src.begin(), src.end(), m_pbuffer);
 
             m_nlength = src.m_nlength;
-            m_ncapacity = src.m_ncapacity;
             m_iterator.set_range(m_pbuffer, m_nlength);
         }
         return derived_cast();
     }
 
-    DerivedT &move(base_dyarray &&src) {
+    /**
+     * @note    Only throws if we have to move each element over, i.e. when our
+     *          allocators differ and we can't take theirs. Elements in inline
+     *          storage are always moved one by one, but they fit in ours.
+     */
+    DerivedT &move(base_dyarray &&src) noexcept(is_nothrow_move_assignable) {
         // If we try to move ourselves, we'll destroy the same buffer!
-        if (this != &src) {
-            // Clear any constructed instances and heap-allocated memory.
-            // Causes a conditional jump/move based on uninitialised value(s)
-            this->~base_dyarray();
+        if (this == &src) {
+            return derived_cast();
+        }
+        // If we can't take `src`'s allocator and ours can't free its memory,
+        // stealing the buffer would be a disaster. Same if it's their inline
+        // storage, which dies with them. Move each element instead.
+        bool b_steal = !src.is_local(src.m_pbuffer);
+        if constexpr (!Malloc::propagate_on_container_move_assignment::value) {
+            b_steal = b_steal && (m_malloc == src.m_malloc);
+        }
+        if (!b_steal) {
+            release();
+            if (src.capacity() > m_ncapacity) {
+                m_pbuffer = new_buffer(src.capacity());
+                m_ncapacity = src.capacity();
+            }
+            std::uninitialized_move(src.begin(), src.end(), m_pbuffer);
+            m_nlength = src.m_nlength;
+            m_iterator.set_range(m_pbuffer, m_nlength);
+            src.release();
+            return derived_cast();
+        }
+        // Clear any constructed instances and heap-allocated memory.
+        release();
+        if constexpr (Malloc::propagate_on_container_move_assignment::value) {
+            m_malloc = std::move(src.m_malloc);
+        }
 
-            // Do a shallow copy, since `src` will be destroyed shortly anyway.
-            m_pbuffer = src.begin();
-            m_nlength = src.length();
-            m_ncapacity = src.capacity();
-            m_iterator = src.m_iterator;
+        // Do a shallow copy, since `src` will be destroyed shortly anyway.
+        m_pbuffer = src.begin();
+        m_nlength = src.length();
+        m_ncapacity = src.capacity();
+        m_iterator = src.m_iterator;
 
-            // `src.m_pbuffer` is set to null so it's safe from deletion now.
-            src.reset();
-        }
+        // `src.m_pbuffer` is set to null so it's safe from deletion now.
+        src.reset();
         return derived_cast();
     }
 
+    // Copy of the allocator we were constructed with.
+    AllocT get_allocator() const {
+        return m_malloc;
+    }
+
 public:
     /* -*-  BUFFER MANIPULATION -*- */
 
     /**
-     * @brief   Moves `entry` to the top of the internal buffer. That is, it is 
-     *          move-assigned to the index after the previously written element. 
+     * @brief   Constructs a new element at the top of the internal buffer,
+     *          passing `args` straight to its constructor. There's no default
+     *          construction nor any assignment, just the one constructor call.
      * 
-     *          It's mainly helpful for objects with a clear move-assigment,
-     *          such as by overloading the `=` operator. For example, see:
-     *          `crim::dystring &operator=(crim::dystring &&)`.
+     * @note    `args` may refer to one of our own elements, e.g. 
+     *          `arr.emplace_back(arr[0])`. That's fine even if we reallocate.
+     */
+    template<class ...Args>
+    DerivedT &emplace_back(Args &&...args) {
+        if (m_nlength < m_ncapacity) {
+            Malloc::construct(m_malloc, &m_pbuffer[m_nlength], std::forward<Args>(args)...);
+        } else {
+            grow_and_emplace(std::forward<Args>(args)...);
+        }
+        m_nlength++;
+        // Don't try to dereference unitialized memory and get its address!
+        m_iterator.m_end++;
+        return derived_cast();
+    }
+
+    /**
+     * @brief   Moves `entry` to the top of the internal buffer. That is, it is 
+     *          move-constructed at the index after the previously written 
+     *          element. 
      * 
      * @note    We take an rvalue reference so `entry` itself maybe invalidated!
      *          This function only really works with temporary values. 
@@ -360,52 +512,173 @@ public:
     DerivedT &push_back(ElemT &&entry) {
         // `entry`, being named, "decays" to an lvalue reference so do this
         // so we can call the move constructor.
-        return push_back_helper([&]() {
-            m_pbuffer[m_nlength++] = std::move(entry);
-        });
+        return emplace_back(std::move(entry));
     }
 
     /**
      * @brief   Copies `entry` by value to the top of the internal buffer. That 
-     *          is, its copy-constructor (or a default one) is called to assign
-     *          that value to the index after the previously written element.
+     *          is, its copy-constructor (or a default one) is called to make
+     *          the element at the index after the previously written element.
      * 
      * @note    We take a const lvalue reference so that we do not need to
      *          overload for const and non-const, as we do not intend to modify
      *          `entry` in any way.
      */
     DerivedT &push_back(const ElemT &entry) {
-        return push_back_helper([&]() {
-            m_pbuffer[m_nlength++] = entry;
-        });
+        return emplace_back(entry);
+    }
+
+    /**
+     * @brief   Makes sure we can hold at least `n_capacity` elements without
+     *          having to reallocate. Never shrinks the buffer.
+     * 
+     * @exception   `std::length_error` if `n_capacity > max_length()`.
+     */
+    DerivedT &reserve(size_t n_capacity) {
+        if (n_capacity > DYARRAY_MAX_CAPACITY) {
+            throw std::length_error("Reached crim::base_dyarray::MAXLENGTH!");
+        } else if (n_capacity > m_ncapacity) {
+            resize(n_capacity);
+        }
+        return derived_cast();
+    }
+
+    /**
+     * @brief   Copies every element in `[first, last)` to the end of the buffer.
+     * 
+     *          If we can count the elements beforehand (i.e. forward iterators
+     *          or better) we reallocate at most once, then copy them over in
+     *          bulk. For trivial types that's basically a `memcpy`.
+     * 
+     *          Otherwise, e.g. for stream iterators, we `emplace_back` each one.
+     * 
+     * @note    The range may be part of our own buffer if it's given as plain
+     *          pointers, e.g. `arr.append_range(arr.begin(), arr.end())`.
+     */
+    template<class InputIt>
+    DerivedT &append_range(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            size_t n_count = static_cast<size_t>(std::distance(first, last));
+            if (m_nlength + n_count > m_ncapacity) {
+                // Pointers into our old buffer must follow it to the new one.
+                if constexpr (std::is_pointer_v<InputIt>) {
+                    bool b_isours = (first >= begin() && first < end());
+                    size_t n_offset = b_isours ? static_cast<size_t>(first - begin()) : 0;
+                    grow_for(n_count);
+                    if (b_isours) {
+                        first = begin() + n_offset;
+                        last = first + n_count;
+                    }
+                } else {
+                    grow_for(n_count);
+                }
+            }
+            std::uninitialized_copy(first, last, end());
+            m_nlength += n_count;
+            m_iterator.m_end += n_count;
+        } else {
+            for (/* Empty */; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+        return derived_cast();
     }
 
 private:
     /**
-     * @brief   Simple wrapper to help us generalize for either: 
-     *          `const ElemT &` (constant lvalue reference, named instance) 
-     *          `ElemT &&` (writeable rvalue reference, temporary instance)
+     * @brief   Next capacity to use if we need room for `n_extra` more elements.
+     *          All the cool kids seem to grow their buffers by doubling it!
      * 
-     * @param   assign_fn   A lambda function or a callback function. Capture
-     *                      everything by reference (and `this` by value) then
-     *                      do whatever you need in the function body.
+     * @exception   `std::length_error` if that would exceed `max_length()`.
      */
-    DerivedT &push_back_helper(std::function<void(void)> assign_fn) {
-        if (m_nlength > DYARRAY_MAX_CAPACITY) {
+    size_t next_capacity(size_t n_extra) const {
+        if (n_extra > DYARRAY_MAX_CAPACITY - m_nlength) {
             throw std::length_error("Reached crim::base_dyarray::MAXLENGTH!");
-        } else if (m_nlength + 1 > m_ncapacity) {
-            // All the cool kids seem to grow their buffers by doubling it!
-            resize(empty() ? DYARRAY_START_CAPACITY : m_ncapacity * 2); 
         }
-        // Important if non-trivial constructors/heap-allocations are involved!
-        Malloc::construct(m_malloc, &m_pbuffer[m_nlength]);
+        size_t n_needed = m_nlength + n_extra;
+        size_t n_newcap = (m_ncapacity == 0) ? DYARRAY_START_CAPACITY : m_ncapacity * 2;
+        n_newcap = (n_newcap < n_needed) ? n_needed : n_newcap;
+        return (n_newcap > DYARRAY_MAX_CAPACITY) ? DYARRAY_MAX_CAPACITY : n_newcap;
+    }
 
-        // Lets us generalize for const lvalue reference or rvalue reference.
-        assign_fn();
+    // Grows the buffer, if needed, so `n_extra` more elements will fit.
+    void grow_for(size_t n_extra) {
+        if (m_nlength + n_extra > m_ncapacity) {
+            resize(next_capacity(n_extra));
+        }
+    }
 
-        // Don't try to dereference unitialized memory and get its address!
-        m_iterator.m_end++;
-        return derived_cast();
+    /**
+     * @brief   Slow path of `emplace_back`: the buffer is full. `args` might
+     *          refer to one of our own elements, so we have to construct the
+     *          new element before the old buffer goes away.
+     * 
+     *          Trivially relocatable elements are built off to the side, then 
+     *          the whole buffer is grown via `resize()` and the new element is
+     *          copied in bytewise. Anything else is constructed straight in the
+     *          new buffer before the old elements are moved over.
+     */
+    template<class ...Args>
+    void grow_and_emplace(Args &&...args) {
+        size_t n_newcap = next_capacity(1);
+        if constexpr (is_trivially_relocatable_v<ElemT>) {
+            alignas(ElemT) unsigned char p_tmp[sizeof(ElemT)];
+            ElemT *p_elem = reinterpret_cast<ElemT *>(p_tmp);
+            Malloc::construct(m_malloc, p_elem, std::forward<Args>(args)...);
+            try {
+                resize(n_newcap);
+            } catch (...) {
+                Malloc::destroy(m_malloc, p_elem);
+                throw;
+            }
+            // Relocated, so `p_elem` must not be destroyed.
+            memcpy(static_cast<void *>(&m_pbuffer[m_nlength]), p_tmp, sizeof(ElemT));
+            return;
+        }
+        // We're full, so this is never our inline storage.
+        ElemT *p_dummy = Malloc::allocate(m_malloc, n_newcap);
+        try {
+            Malloc::construct(m_malloc, &p_dummy[m_nlength], std::forward<Args>(args)...);
+        } catch (...) {
+            Malloc::deallocate(m_malloc, p_dummy, n_newcap);
+            throw;
+        }
+        // See `resize()`, we move-construct since `p_dummy` is uninitialized.
+        for (size_t i = 0; i < m_nlength; i++) {
+            Malloc::construct(m_malloc, &p_dummy[i], std::move(m_pbuffer[i]));
+            Malloc::destroy(m_malloc, &m_pbuffer[i]);
+        }
+        free_buffer(m_pbuffer, m_ncapacity);
+        m_pbuffer = p_dummy;
+        m_ncapacity = n_newcap;
+        m_iterator.set_range(m_pbuffer, m_nlength);
+    }
+
+    /**
+     * @brief   Moves our trivially relocatable elements to a buffer of size
+     *          `n_newsize` as raw bytes. If the allocator can `reallocate`, the
+     *          block might even be extended in place.
+     * 
+     * @note    Inline storage can't be handed to the allocator, so moving into
+     *          or out of it is always a plain `memcpy`.
+     */
+    void relocate(size_t n_newsize) {
+        if constexpr (has_reallocate<AllocT>::value) {
+            if (!is_local(m_pbuffer) && n_newsize > DerivedT::local_capacity()) {
+                m_pbuffer = m_malloc.reallocate(m_pbuffer, m_ncapacity, n_newsize);
+                return;
+            }
+        }
+        ElemT *p_dummy = new_buffer(n_newsize);
+        // Only `nullptr` if `n_newsize` is 0, in which case we have nothing.
+        if (p_dummy != nullptr && m_nlength > 0) {
+            memcpy(static_cast<void *>(p_dummy), 
+                static_cast<const void *>(m_pbuffer), 
+                sizeof(ElemT) * m_nlength);
+        }
+        free_buffer(m_pbuffer, m_ncapacity);
+        m_pbuffer = p_dummy;
     }
 
 public:
@@ -415,6 +688,9 @@ public:
      * @details Similar to C's `realloc`. Cleans up the old memory as well.
      *          Updates internals for you accordingly so you don't have to!
      * 
+     *          Trivially relocatable elements, e.g. `int` or `crim::string`, 
+     *          are moved with 1 `memcpy` (or `realloc`) for the whole buffer.
+     * 
      * @param   new_size    New requested buffer size, may be greater or lesser.
      * 
      * @warning For strings, this may not guarantee nul termination!
@@ -424,16 +700,28 @@ public:
         if (n_newsize == m_ncapacity) {
             return derived_cast();
         }
-        ElemT *p_dummy = Malloc::allocate(m_malloc, n_newsize);
-
-        // Need for later so we deallocate the correct number of elements.
-        size_t n_oldsize = m_ncapacity; 
-
-        // Does the new size extend the buffer or not?
-        // true:    Use current `m_index` since any farther is uninitialized.
-        // false:   Buffer was shortened, so `n_newsize` *is* the last index.
-        m_nlength = (n_newsize > m_ncapacity) ? m_nlength : n_newsize;
-        m_ncapacity = n_newsize;
+        // Buffer was shortened, so elements past `n_newsize` have to go.
+        for (size_t i = n_newsize; i < m_nlength; i++) {
+            Malloc::destroy(m_malloc, &m_pbuffer[i]);
+        }
+        m_nlength = (n_newsize > m_nlength) ? m_nlength : n_newsize;
+
+        // Inline storage is all or nothing: we can move back into it, but we
+        // can't make it any smaller.
+        if (n_newsize <= DerivedT::local_capacity()) {
+            if (is_local(m_pbuffer)) {
+                m_iterator.set_range(m_pbuffer, m_nlength);
+                return derived_cast();
+            }
+            n_newsize = DerivedT::local_capacity();
+        }
+        if constexpr (is_trivially_relocatable_v<ElemT>) {
+            relocate(n_newsize);
+            m_ncapacity = n_newsize;
+            m_iterator.set_range(m_pbuffer, m_nlength);
+            return derived_cast();
+        }
+        ElemT *p_dummy = new_buffer(n_newsize);
 
         /**
          * @brief   Move, not copy, previous buffer into current since it's a
@@ -452,17 +740,16 @@ public:
          *          instance's constructor arguments. 
          * 
          *          Here, we (probably) want to force the move-constructor.
+         *          Moved-from elements still need their destructors called.
          */
         for (size_t i = 0; i < m_nlength; i++) {
             Malloc::construct(m_malloc, &p_dummy[i], std::move(m_pbuffer[i]));
+            Malloc::destroy(m_malloc, &m_pbuffer[i]);
         }
 
-        // Since previous contents were moved no need to explicitly destroy
-        // Also: Malloc::deallocate shouldn't accept `nullptr`!
-        if (m_pbuffer != nullptr) {
-            Malloc::deallocate(m_malloc, m_pbuffer, n_oldsize);
-        }
+        free_buffer(m_pbuffer, m_ncapacity);
         m_pbuffer = p_dummy;
+        m_ncapacity = n_newsize;
         m_iterator.set_range(m_pbuffer, m_nlength);
         return derived_cast();
     }
@@ -493,9 +780,12 @@ public:
      */
     DerivedT &clear() {
         // Destroy all created objects and free our pointer's allocated memory.
-        this->~base_dyarray();
-        m_pbuffer = Malloc::allocate(m_malloc, m_ncapacity);
-        m_nlength = 0;
+        size_t n_capacity = m_ncapacity;
+        release();
+        if (n_capacity > m_ncapacity) {
+            m_pbuffer = new_buffer(n_capacity);
+            m_ncapacity = n_capacity;
+        }
         m_iterator.set_range(m_pbuffer);
         return derived_cast();
     }
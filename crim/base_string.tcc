@@ -2,18 +2,29 @@
 
 #include <cstring> /* std::strlen */
 #include <algorithm> /* std::move */
+#include <memory> /* std::allocator_traits */
 #include <stdexcept> /* std::out_of_range */
+#include <type_traits> /* std::make_unsigned_t */
 
 #include "bitmanip.hpp"
 #include "memory.tcc"
+#include "string_view.tcc"
 #include "type_traits.tcc"
 #include "utility.tcc"
 
+/**
+ * Long strings flag themselves with the top bit of their capacity, which only
+ * ends up in our very last byte on little-endian machines.
+ */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#error "crim::base_string's short string layout assumes a little-endian machine!"
+#endif
+
 #define crim_logerror(func, info) \
     crim_logerror_nofunc("crim::base_string<T>", func, info)
 
 namespace crim {
-    template<typename CharT, class Traits, class Alloc> 
+    template<typename CharT, class Traits, class Alloc>
     class base_string;
 }
 
@@ -25,9 +36,21 @@ namespace crim {
  * @brief   A simple reimplementation of `std::string`.
  *          Also with short string optimization to reduce heap-allocations!
  *
+ * @details We're just 3 pointers wide (24 bytes on 64-bit machines), like
+ *          a pointer, length and capacity. Short strings reuse all of that for
+ *          their characters, up to 23 `char`s plus the nul terminator.
+ *
+ *          The very last `CharT` tells the two apart. Short strings keep how
+ *          many characters they have *left* in there, so when they're full it
+ *          is 0 and doubles as their nul terminator. Long strings set the top
+ *          bit of their capacity, which lands in the top bit of that `CharT`.
+ *
+ *          Stateless allocators like `crim::allocator` take up no space at all
+ *          thanks to the empty base optimization.
+ *
  * @note    Default values must go in forward declarations.
  */
-template<typename CharT, class Traits, class Alloc> 
+template<typename CharT, class Traits, class Alloc>
 class crim::base_string {
 /**
  * BEGIN: TYPEDEFS -*-----------------------------------------------------------
@@ -42,7 +65,9 @@ private:
     using pointer = value_type *;
     using const_pointer = const value_type *;
     using size_type = typename Alloc::size_type;
-/** 
+    using alloc_traits = std::allocator_traits<allocator_type>;
+    using uchar_type = std::make_unsigned_t<value_type>;
+/**
  * END: TYPEDEFS -*-------------------------------------------------------------
  */
 
@@ -50,31 +75,55 @@ private:
  * BEGIN: DATA MEMBERS -*-------------------------------------------------------
  */
 private:
-    allocator_type m_allocator;
-    /** 
-     * Anonymous unions expose their members to the enclosing scope.
-     * But with templates we can't get sizeof one union member properly.
-     * Either the union type or the union instance need to be named.
-     *  - https://stackoverflow.com/a/28820862
-     */
-    union databuf {
-        struct heapbuf {
-            pointer ptr; 
-            size_type cap;
-        } heap;
-        value_type stack[sizeof(heap)] = {0};
-    } m_data;
-    size_type m_ncount{0}; 
+    struct heapbuf {
+        pointer ptr;
+        size_type size;
+        size_type cap; // Top bit is always set, see `long_flag`.
+    };
 
     // w/o explicit "cast", would get the following error:
     // "enumerated and non-enumerated type in conditional expression"
     // for `capacity()`.
     enum limit : size_type {
-        stack_max_cap = sizeof(m_data.stack) / sizeof(value_type),
+        stack_max_cap = sizeof(heapbuf) / sizeof(value_type), // Includes nul.
+        stack_max_len = stack_max_cap - 1,
         heap_init_cap = stack_max_cap * 2
     };
 
-    // Primarily used to access const overloads with non-const `this`. 
+    static_assert(sizeof(heapbuf) % sizeof(value_type) == 0,
+        "The last CharT of a short string must line up with the capacity!");
+
+    // Set in `heapbuf::cap` for long strings, never in a short string's count.
+    static constexpr size_type long_flag = size_type(1) << (bit::size<size_type>() - 1);
+    static constexpr uchar_type long_bit = uchar_type(1) << (bit::size<uchar_type>() - 1);
+
+    // Named so that `move_instance()` can copy all of it in one go.
+    union databuf {
+        heapbuf heap;
+        value_type stack[stack_max_cap];
+    };
+
+    // Inheriting the allocator means an empty one takes up no space in here.
+    struct rep : allocator_type {
+        databuf data;
+
+        explicit rep(const allocator_type &alloc) noexcept
+            : allocator_type(alloc)
+            , data{}
+        {}
+    } m_rep;
+
+    allocator_type &allocator() noexcept
+    {
+        return m_rep;
+    }
+
+    const allocator_type &allocator() const noexcept
+    {
+        return m_rep;
+    }
+
+    // Primarily used to access const overloads with non-const `this`.
     const base_string *const_this()
     {
         return const_cast<const base_string*>(this);
@@ -86,98 +135,194 @@ private:
 /**
  * BEGIN: CONSTRUCTOR/DESTRUCTORS -*--------------------------------------------
  */
-public: 
-    base_string(size_type n_length = 0) noexcept
-        : m_allocator{}
-        , m_data{}
-        , m_ncount{n_length}
+public:
+    base_string() noexcept
+        : base_string(allocator_type())
     {}
 
-    base_string(const_pointer p_literal) 
-        : base_string(traits_type::length(p_literal))
+    // Empty string which will get its memory from `alloc` later on.
+    explicit base_string(const allocator_type &alloc) noexcept
+        : m_rep{alloc}
     {
-        copy_string(p_literal);
+        set_short_length(0);
     }
 
-    base_string(const base_string &other) 
-        : base_string(other.c_str())
-    {}
-    
-    base_string(base_string &&other) 
-        : base_string(other.length())
+    base_string(const_pointer p_literal, const allocator_type &alloc = allocator_type())
+        : base_string(alloc)
+    {
+        copy_string(p_literal, traits_type::length(p_literal));
+    }
+
+    // Exactly `n_length` characters of `p_data`, which need not be nul terminated.
+    base_string(const_pointer p_data, size_type n_length, const allocator_type &alloc = allocator_type())
+        : base_string(alloc)
+    {
+        copy_string(p_data, n_length);
+    }
+
+    // The allocator gets to decide what a copy of it should be.
+    base_string(const base_string &other)
+        : base_string(alloc_traits::select_on_container_copy_construction(other.allocator()))
+    {
+        copy_string(other.data(), other.length());
+    }
+
+    base_string(base_string &&other) noexcept
+        : base_string(other.allocator())
     {
         // Named parameters which are rvalue refs "decays" to lvalue ref.
-        move_instance(crim::rvalue_cast(other)); 
+        move_instance(crim::rvalue_cast(other));
     }
-    
+
     ~base_string()
     {
-        // If we're a short string, we don't need to deallocate anything.
-        if (isshort()) {
-            return;
+        release();
+    }
+
+    base_string &operator=(const base_string &other)
+    {
+        // Copying ourselves would free the buffer we're copying from.
+        if (this != &other) {
+            release();
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                allocator() = other.allocator();
+            }
+            copy_string(other.data(), other.length());
         }
-        // Non-trivially destructible types: need to destroy them all first.
-        m_allocator.deallocate(m_data.heap.ptr, m_data.heap.cap);
+        return *this;
+    }
+
+    // Only throws if our allocators differ and we have to copy instead.
+    base_string &operator=(base_string &&other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value
+        || alloc_traits::is_always_equal::value)
+    {
+        if (this == &other) {
+            return *this;
+        }
+        // Our allocator can't free memory from theirs, so we have to copy.
+        if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+            if (allocator() != other.allocator()) {
+                return *this = static_cast<const base_string &>(other);
+            }
+        }
+        release();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            allocator() = other.allocator();
+        }
+        move_instance(crim::rvalue_cast(other));
+        return *this;
+    }
+
+    base_string &operator=(const_pointer p_literal)
+    {
+        // `p_literal` might point into our own buffer, so copy it out first.
+        base_string tmp(p_literal, allocator());
+        return *this = crim::rvalue_cast(tmp);
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator();
     }
 
 private:
     /**
-     * @brief   Call `Traits::copy` on the correct buffer. We add 1 to the count
-     *          so that we also copy the nul character at the end.
+     * @brief   Gives back our heap buffer, if any, and becomes an empty short
+     *          string again.
+     */
+    void release() noexcept
+    {
+        // If we're a short string, we don't need to deallocate anything.
+        if (!isshort()) {
+            allocator().deallocate(m_rep.data.heap.ptr, capacity());
+        }
+        set_short_length(0);
+    }
+
+    /**
+     * @brief   Writes the nul terminator and how much room is left. At
+     *          `stack_max_len` those are the very same `CharT`, which is fine
+     *          since we'd write a 0 to it either way.
      */
-    void copy_string(const_pointer p_data)
+    void set_short_length(size_type n_length) noexcept
+    {
+        m_rep.data.stack[n_length] = value_type(0);
+        m_rep.data.stack[stack_max_len] = static_cast<value_type>(stack_max_len - n_length);
+    }
+
+    void set_long(pointer p_data, size_type n_length, size_type n_capacity) noexcept
+    {
+        m_rep.data.heap.ptr = p_data;
+        m_rep.data.heap.size = n_length;
+        m_rep.data.heap.cap = n_capacity | long_flag;
+    }
+
+    // Nul terminates at `n_length`, which must fit in our current buffer.
+    void set_length(size_type n_length) noexcept
     {
         if (isshort()) {
-            traits_type::copy(m_data.stack, p_data, m_ncount + 1);
+            set_short_length(n_length);
         } else {
-            // For long strings, we only start allocations by powers of 2.
-            m_data.heap.cap = crim::bit::next_power(m_ncount + 1);
-            m_data.heap.ptr = m_allocator.allocate(m_data.heap.cap);
-            traits_type::copy(m_data.heap.ptr, p_data, m_data.heap.cap);
+            m_rep.data.heap.size = n_length;
+            m_rep.data.heap.ptr[n_length] = value_type(0);
         }
     }
-    
+
     /**
-     * @brief   We "take ownership" of `other`'s `m_data.heap.ptr`. We only do
-     *          do so when we know it's been allocated for. Otherwise, we can
-     *          just copy by value on `m_data.stack`.
+     * @brief   Copies `n_length` characters of `p_data` into our, currently
+     *          empty, buffer then nul terminates it.
      *
-     * @note    This is important to ensure that, in case `other` is indeed a 
-     *          heap-allocated string, it's pointer doesn't get freed when its
-     *          destructor is called.
+     * @note    Long strings get exactly as much as they need. Anything that
+     *          grows them later on doubles the capacity anyway.
      */
-    void move_instance(base_string &&other)
+    void copy_string(const_pointer p_data, size_type n_length)
     {
-        if (other.isshort()) {
-            traits_type::copy(m_data.stack, other.c_str(), m_ncount + 1);
+        if (n_length <= stack_max_len) {
+            traits_type::copy(m_rep.data.stack, p_data, n_length);
+            set_short_length(n_length);
             return;
         }
-        m_data.heap.cap = other.capacity();
-        m_data.heap.ptr = other.data();
-        // other should now use stack, which is all 0's.
-        other.m_ncount = 0;
-        other.m_data.heap.ptr = nullptr;
-        other.m_data.heap.cap = 0;
+        size_type n_capacity = n_length + 1;
+        pointer p_buffer = allocator().allocate(n_capacity);
+        // Only `n_length` chars of `p_data` are ours to read.
+        traits_type::copy(p_buffer, p_data, n_length);
+        p_buffer[n_length] = value_type(0);
+        set_long(p_buffer, n_length, n_capacity);
+    }
+
+    /**
+     * @brief   We "take ownership" of `other`'s heap buffer, if any. Either way
+     *          the whole representation is just 3 words, so we copy all of it.
+     *
+     * @note    This is important to ensure that, in case `other` is indeed a
+     *          heap-allocated string, it's pointer doesn't get freed when its
+     *          destructor is called.
+     */
+    void move_instance(base_string &&other) noexcept
+    {
+        m_rep.data = other.m_rep.data;
+        other.set_short_length(0);
     }
 
-public: 
+public:
     /**
      * @brief       Read-only element access.
-     * 
+     *
      * @exception   `std::out_of_range` if `n_index` if out of bounds.
     */
     const_reference at(size_type n_index) const
     {
-        if (n_index >= m_ncount) {
+        if (n_index >= length()) {
             crim_logerror("at", "Requested an invalid index!");
             throw std::out_of_range("See log message.");
         }
-        return isshort() ? m_data.stack[n_index] : m_data.heap.ptr[n_index];
+        return data()[n_index];
     }
-    
+
     /**
      * @brief       Read-write element access.
-     * 
+     *
      * @exception   `std::out_of_range` if `n_index` if out of bounds.
     */
     CharT &at(size_type n_index)
@@ -188,116 +333,230 @@ public:
     }
 
     /**
-     * @brief   Check if we're still a short string. In that case we're still 
+     * @brief   Check if we're still a short string. In that case we're still
      *          using the `stack` union array.
-     *          Inside of `push_back()`, we use a slightly different check.
-     * 
-     * @note    `m_ncount` of 15 and/or 16 are still short strings.
-     *          But if `m_ncount == 16` and then we do a push_back, we need to 
-     *          init `m_data.heap`. 
+     *
+     * @note    Reading `stack` while `heap` is the active member is type
+     *          punning, which GCC, Clang and MSVC all allow for unions.
      */
     bool isshort() const noexcept
     {
-        return m_ncount <= stack_max_cap;
+        uchar_type last = static_cast<uchar_type>(m_rep.data.stack[stack_max_len]);
+        return (last & long_bit) == 0;
     }
-    
+
     // Count of non-nul `CharT`'s we're currently storing.
     size_type length() const noexcept
     {
-        return m_ncount;
+        if (isshort()) {
+            return stack_max_len - static_cast<uchar_type>(m_rep.data.stack[stack_max_len]);
+        }
+        return m_rep.data.heap.size;
     }
-    
+
     // Includes allocated capacity for the terminating nul character.
     size_type capacity() const noexcept
     {
-        return isshort() ? stack_max_cap : m_data.heap.cap;
+        return isshort() ? stack_max_cap : (m_rep.data.heap.cap & ~long_flag);
     }
 private:
     /**
-     * @brief   Valgrind shows that a local instance uses a little bit more
-     *          memory than an array of known size. Hmm...
+     * @brief   Moves our characters into a fresh heap buffer that can hold
+     *          `n_newcap` of them, nul included, truncating if needed.
      */
-    bool init_heap()
+    bool grow_heap(size_type n_newcap)
     {
-        // Copy-by-value on the old data first.
-        value_type p_prevdata[stack_max_cap];
-        traits_type::copy(p_prevdata, m_data.stack, stack_max_cap);
+        pointer p_dummy = allocator().allocate(n_newcap);
+        // To be handled elsewhere, but do log the error.
+        if (p_dummy == nullptr) {
+            crim_logerror("grow_heap", "allocator().allocate() returned a nullptr!");
+            return false;
+        }
+        size_type n_length = length();
+        n_length = (n_length < n_newcap) ? n_length : n_newcap - 1;
+        traits_type::copy(p_dummy, data(), n_length);
+        p_dummy[n_length] = value_type(0);
 
-        // Careful: now assigning the active union members!
-        m_data.heap.cap = heap_init_cap;
-        m_data.heap.ptr = m_allocator.allocate(m_data.heap.cap);
+        // Switcharoo and cleanup.
+        if (!isshort()) {
+            allocator().deallocate(m_rep.data.heap.ptr, capacity());
+        }
+        set_long(p_dummy, n_length, n_newcap);
+        return true;
+    }
 
-        // To be handled elsewhere, but do log the error.
-        if (m_data.heap.ptr == nullptr) {
-            crim_logerror("init_heap", "m_allocator.allocate() failed!");
+    /**
+     * @brief   Slow path of `append()`: we need a bigger buffer. We copy the old
+     *          contents and `p_data` into it before letting go of the old one,
+     *          as `p_data` may well point into it.
+     */
+    bool grow_and_append(const_pointer p_data, size_type n_count)
+    {
+        size_type n_length = length();
+        size_type n_needed = n_length + n_count + 1;
+        size_type n_newcap = isshort() ? heap_init_cap : capacity() * 2;
+        n_newcap = (n_newcap < n_needed) ? n_needed : n_newcap;
+
+        pointer p_dummy = allocator().allocate(n_newcap);
+        if (p_dummy == nullptr) {
+            crim_logerror("grow_and_append", "allocator().allocate() returned a nullptr!");
             return false;
         }
-        traits_type::copy(m_data.heap.ptr, p_prevdata, m_ncount);
+        traits_type::copy(p_dummy, data(), n_length);
+        traits_type::copy(p_dummy + n_length, p_data, n_count);
+        p_dummy[n_length + n_count] = value_type(0);
+        if (!isshort()) {
+            allocator().deallocate(m_rep.data.heap.ptr, capacity());
+        }
+        set_long(p_dummy, n_length + n_count, n_newcap);
         return true;
     }
 public:
-    // TODO: When shortening the buffer, check if we need to use stack
-    bool resize(size_type n_newcap) 
+    /**
+     * @brief   Reallocates our buffer so it can hold exactly `n_newcap`
+     *          characters, nul included. Anything past that is cut off.
+     *
+     *          Asking for `stack_max_cap` or less moves us back into the short
+     *          string buffer.
+     */
+    bool resize(size_type n_newcap)
     {
+        if (isshort()) {
+            if (n_newcap <= stack_max_cap) {
+                size_type n_length = length();
+                set_short_length((n_length < n_newcap) ? n_length : (n_newcap > 0) ? n_newcap - 1 : 0);
+                return true;
+            }
+            return grow_heap(n_newcap);
+        }
         // Don't do anything so we don't waste our time.
-        if (n_newcap == m_data.heap.cap) {
+        if (n_newcap == capacity()) {
             return true;
+        } else if (n_newcap > stack_max_cap) {
+            return grow_heap(n_newcap);
         }
-
-        // When shortening the buffer, we want to copy less elements.
-        if (n_newcap < m_data.heap.cap) {
-            m_ncount = n_newcap;
-        }
-        pointer p_dummy = m_allocator.allocate(n_newcap);
-        if (p_dummy == nullptr) {
-            crim_logerror("resize", "m_allocator.allocate() returned a nullptr!");
-            return false;
-        }
-        traits_type::copy(p_dummy, m_data.heap.ptr, m_ncount);
-
-        // Switcharoo and cleanup.
-        p_dummy[m_ncount] = '\0';
-        m_allocator.deallocate(m_data.heap.ptr, m_data.heap.cap);
-        m_data.heap.ptr = p_dummy;
-        m_data.heap.cap = n_newcap;
-        return true;            
+        // Back to the short string buffer, careful not to overwrite `heap`
+        // before we're done reading from it.
+        pointer p_old = m_rep.data.heap.ptr;
+        size_type n_oldcap = capacity();
+        size_type n_length = length();
+        n_length = (n_length < n_newcap) ? n_length : (n_newcap > 0) ? n_newcap - 1 : 0;
+        traits_type::copy(m_rep.data.stack, p_old, n_length);
+        set_short_length(n_length);
+        allocator().deallocate(p_old, n_oldcap);
+        return true;
     }
 
-    // For stack, all the data is 0-initialized so we just append `ch`.
-    // But for `m_data.hea`p, we constantly also append a nul char after `ch`.
+    // Short strings bump the count in their last `CharT`, long strings bump
+    // `heap.size`. Either way we also append a nul char after `ch`.
     bool push_back(CharT ch)
     {
-        // Can't use `isshort()` due to off by 1, since once we need to write
-        // to the 16th index we also need to start `m_data.heap.ptr`.
-        if (m_ncount < stack_max_cap) {
-            m_data.stack[m_ncount++] = ch;
-            return true;
-        }
-        // Initialize `m_data.heap` only once, after this `isshort() == false`.
-        if (m_ncount == stack_max_cap) {
-            if (init_heap() == false) {
-                crim_logerror("push_back", "init_heap() failed!");
+        if (isshort()) {
+            size_type n_length = length();
+            if (n_length < stack_max_len) {
+                m_rep.data.stack[n_length] = ch;
+                set_short_length(n_length + 1);
+                return true;
+            }
+            // Full, so start the heap buffer. After this `isshort() == false`.
+            if (grow_heap(heap_init_cap) == false) {
+                crim_logerror("push_back", "grow_heap() failed!");
                 return false;
             }
-        }
-        // Check for enough allocated memory, if not then grow buffer by 2.
-        if (m_ncount + 1 >= m_data.heap.cap) {
-            if (resize(m_data.heap.cap * 2) == false) {
-                crim_logerror("push_back", "resize() failed!");
+        } else if (m_rep.data.heap.size + 1 >= capacity()) {
+            // Check for enough allocated memory, if not then grow buffer by 2.
+            if (grow_heap(capacity() * 2) == false) {
+                crim_logerror("push_back", "grow_heap() failed!");
                 return false;
             }
         }
-        // `m_data.heap.ptr` has uninitialized memory, need to append nul char.
-        m_data.heap.ptr[m_ncount++] = ch;
-        m_data.heap.ptr[m_ncount] = '\0';
+        // `heap.ptr` has uninitialized memory, need to append nul char.
+        heapbuf &heap = m_rep.data.heap;
+        heap.ptr[heap.size++] = ch;
+        heap.ptr[heap.size] = value_type(0);
         return true;
     }
-    
+
+    /**
+     * @brief   Makes sure we can hold `n_length` characters, plus the nul, with
+     *          no more allocations. Never shrinks the buffer.
+     */
+    bool reserve(size_type n_length)
+    {
+        if (n_length < capacity()) {
+            return true;
+        }
+        return grow_heap(n_length + 1);
+    }
+
+    /**
+     * @brief   Makes us exactly `n_length` characters long without writing any
+     *          of them, besides the nul at the end. Characters we already had
+     *          are kept, new ones are garbage until you fill them in through
+     *          the returned pointer, e.g. with `std::fread`.
+     *
+     * @return  `data()`, or `nullptr` if we couldn't allocate.
+     */
+    pointer resize_for_overwrite(size_type n_length)
+    {
+        if (!reserve(n_length)) {
+            crim_logerror("resize_for_overwrite", "reserve() failed!");
+            return nullptr;
+        }
+        set_length(n_length);
+        return data();
+    }
+
+    /**
+     * @brief   Appends `n_count` characters of `p_data`, with one capacity
+     *          check and one copy. `p_data` may point into ourselves.
+     */
+    base_string &append(const_pointer p_data, size_type n_count)
+    {
+        size_type n_length = length();
+        // Need room for the nul char too, hence `<` and not `<=`.
+        if (n_length + n_count < capacity()) {
+            // Our old characters end where the new ones start, so even if
+            // `p_data` is one of ours the ranges don't overlap.
+            traits_type::copy(data() + n_length, p_data, n_count);
+            set_length(n_length + n_count);
+        } else if (!grow_and_append(p_data, n_count)) {
+            crim_logerror("append", "grow_and_append() failed!");
+        }
+        return *this;
+    }
+
+    base_string &append(const_pointer p_literal)
+    {
+        return append(p_literal, traits_type::length(p_literal));
+    }
+
+    base_string &append(const base_string &other)
+    {
+        return append(other.data(), other.length());
+    }
+
+    base_string &operator+=(const_pointer p_literal)
+    {
+        return append(p_literal);
+    }
+
+    base_string &operator+=(const base_string &other)
+    {
+        return append(other);
+    }
+
+    base_string &operator+=(CharT ch)
+    {
+        push_back(ch);
+        return *this;
+    }
+
     const_pointer data() const noexcept
     {
-        return isshort() ? m_data.stack : m_data.heap.ptr;
+        return isshort() ? m_rep.data.stack : m_rep.data.heap.ptr;
     }
-    
+
     pointer data() noexcept
     {
         return const_cast<pointer>(const_this()->data());
@@ -308,8 +567,24 @@ public:
     {
         return data();
     }
+
+    // So parsers can take views and not care where the characters live.
+    operator basic_string_view<CharT, Traits>() const noexcept
+    {
+        return basic_string_view<CharT, Traits>(data(), length());
+    }
 };
 
+/**
+ * @brief   Short strings live inside of us but nothing points to them, we just
+ *          check our last `CharT`. So copying our bytes elsewhere is a valid move as
+ *          long as our allocator can be moved that way too.
+ */
+template<typename CharT, class Traits, class Alloc>
+struct crim::is_trivially_relocatable<crim::base_string<CharT, Traits, Alloc>> 
+    : crim::is_trivially_relocatable<Alloc> 
+{};
+
 /**
  * END: BASE STRING IMPLEMENTATION -*-------------------------------------------
  */
@@ -3,7 +3,7 @@
 #include "base_dyarray.tcc"
 
 namespace crim {
-    template<class ElemT> class dyarray;
+    template<class ElemT, class AllocT = crim::allocator<ElemT>> class dyarray;
 };
 
 /**
@@ -11,33 +11,47 @@ namespace crim {
  *          to use this with fundamental/user-defined types only.
  * 
  * @tparam  ElemT   Desired type of the buffer's elements.
+ * @tparam  AllocT  Desired allocator, e.g. `crim::arena_allocator<ElemT>`.
  * 
  * @warning This is a work in progress!
  */
-template<typename ElemT> 
-class crim::dyarray : public crim::base_dyarray<crim::dyarray<ElemT>, ElemT> {
+template<typename ElemT, class AllocT> 
+class crim::dyarray : public crim::base_dyarray<crim::dyarray<ElemT, AllocT>, ElemT, AllocT> {
 private:
-    using base = base_dyarray<dyarray<ElemT>, ElemT>;
+    using base = base_dyarray<dyarray<ElemT, AllocT>, ElemT, AllocT>;
 public:
     // Delegate's to base class's constructor for no arguments.
     // Does some basic allocations.
     dyarray() : base() {}
 
+    // Empty array which will get its memory from `alloc` later on.
+    explicit dyarray(const AllocT &alloc) : base(alloc) {}
+
     // Delegates to base class's constructor for initializer lists.
     // Think of them like array literals.
-    dyarray(std::initializer_list<ElemT> list) : base(list) {}
+    dyarray(std::initializer_list<ElemT> list, const AllocT &alloc = AllocT()) 
+    : base(list, alloc) {}
 
     dyarray(const dyarray &src) : base(src) {}
 
     // Static cast is necessary to call the correct function, otherwise it'll
     // use the one meant for lvalue references!
-    dyarray(dyarray &&src) : base(std::forward<base>(src)) {}
+    dyarray(dyarray &&src) noexcept : base(std::forward<base>(src)) {}
 
     dyarray &operator=(const dyarray &src) {
         return base::copy(src);
     }
 
-    dyarray &operator=(dyarray &&src) {
+    dyarray &operator=(dyarray &&src) noexcept(base::is_nothrow_move_assignable) {
         return base::move(std::forward<base>(src));
     }
 };
+
+/**
+ * @brief   We only point to our heap buffer, never into ourselves. So we can be
+ *          moved around bytewise as long as our allocator can too.
+ */
+template<class ElemT, class AllocT>
+struct crim::is_trivially_relocatable<crim::dyarray<ElemT, AllocT>> 
+    : crim::is_trivially_relocatable<AllocT> 
+{};
@@ -1,6 +1,7 @@
 #pragma once
 /*- -*- REINVENTING THE WHEEL LIBRARY -*- -*/
 #include "base_dyarray.tcc"
+#include "string_view.tcc"
 
 namespace crim {
     /**
@@ -8,15 +9,16 @@ namespace crim {
      *          for manipulating the string.
      * 
      * @tparam  CharT Desired character type, e.g. `char`, `wchar_t`, etc.
+     * @tparam  AllocT Desired allocator, e.g. `crim::arena_allocator<CharT>`.
      */
-    template<class CharT> class dystring;
+    template<class CharT, class AllocT = crim::allocator<CharT>> class dystring;
 };
 
-template<typename CharT> 
-class crim::dystring : public crim::base_dyarray<crim::dystring<CharT>, CharT> {
+template<typename CharT, class AllocT> 
+class crim::dystring : public crim::base_dyarray<crim::dystring<CharT, AllocT>, CharT, AllocT> {
 private:
     // Use this for quick access to base's methods and casts to the base class.
-    using base = base_dyarray<dystring<CharT>, CharT>;
+    using base = base_dyarray<dystring<CharT, AllocT>, CharT, AllocT>;
 public:
     /* -*- CONSTRUCTORS, DESTRUCTORS -*- */
 
@@ -32,6 +34,18 @@ public:
         append(msg);
     }
 
+    /**
+     * @brief   Same as above, but the buffer is allocated from `alloc`.
+     */
+    dystring(const CharT *msg, const AllocT &alloc) : base(alloc) {
+        append(msg);
+    }
+
+    // Empty string which will get its memory from `alloc`.
+    explicit dystring(const AllocT &alloc) : base(alloc) {
+        append('\0');
+    }
+
     /**
      * @brief   Copy-constructor which delegates to the base class's version.
      *          That one takes care of doing the deep copy for us.
@@ -52,9 +66,14 @@ public:
      *          It does a shallow copy, sets `src`'s pointers to `nullptr`.
      *          Upon temporary `src`'s destruction, the memory pointed to by
      *          `src.m_pbuffer` is not freed, allowing us to keep it around!
+     * 
+     * @note    A stolen buffer always has room for the nul char, so this never
+     *          allocates. If `src` was moved-from already, so are we.
      */
-    dystring(dystring &&src) : base(std::forward<base>(src)) {
-        append('\0');
+    dystring(dystring &&src) noexcept : base(std::forward<base>(src)) {
+        if (base::data() != nullptr) {
+            append('\0');
+        }
     }
 
     /* -*- ASSIGNMENT OPERATORS -*- */
@@ -65,7 +84,7 @@ public:
      *          copy over `msg` into the buffer.
      */
     dystring &operator=(const CharT *msg) {
-        dystring tmp = msg; // basic constructor
+        dystring tmp(msg, base::get_allocator()); // basic constructor
         std::swap(*this, tmp);
         return *this;
     }
@@ -109,9 +128,9 @@ public:
      *          have to explicitly append it ourselves else we might end up with
      *          a likely buffer overrun!
      */
-    dystring &operator=(dystring &&src) {
+    dystring &operator=(dystring &&src) noexcept(base::is_nothrow_move_assignable) {
         base::move(std::forward<base>(src));
-        return append('\0');
+        return (base::data() != nullptr) ? append('\0') : *this;
     }
 
     dystring &operator+=(const CharT *msg) {
@@ -119,7 +138,11 @@ public:
     }
 
     dystring &operator+=(const dystring &src) {
-        return append(src.c_str());
+        return append(src.c_str(), src.length());
+    }
+
+    dystring &operator+=(CharT c) {
+        return append(c);
     }
 
     /* -*- DATA ACCESS OPERATIONS -*- */
@@ -135,6 +158,11 @@ public:
         return base::data();
     }
 
+    // So parsers can take views and not care where the characters live.
+    operator basic_string_view<CharT>() const {
+        return basic_string_view<CharT>(base::data(), base::length());
+    }
+
     /* -*- STRING WRITING FUNCTIONS -*- */
 
     /**
@@ -156,16 +184,29 @@ public:
      * 
      *          This will automatiically erase the previous nul terminator then 
      *          add one at the very end without counting it in the index.
-     * 
-     * @note    Might reallocate memory for the internal buffer via `resize`,
-     *          which is called in the parent method `base::push_back()`.
      */
     dystring &append(const CharT *msg) {
-        // Don't add 1 to avoid both writing nul char and incrementing index.
-        for (size_t i = 0, len = strlen(msg); i < len; i++) {
-            base::push_back(msg[i]); // faster than append() since no nul char
+        return append(msg, char_traits<CharT>::length(msg));
+    }
+
+    /**
+     * @brief   Appends the first `n_count` characters of `msg`, then a nul char
+     *          that isn't counted in the index.
+     * 
+     * @note    We make room for everything, nul char included, up front. So we
+     *          reallocate at most once and then copy `msg` over in bulk.
+     */
+    dystring &append(const CharT *msg, size_t n_count) {
+        // `msg` may be part of our own buffer, which moves if we have to grow.
+        bool b_isours = (msg >= base::begin() && msg < base::end());
+        size_t n_offset = b_isours ? static_cast<size_t>(msg - base::begin()) : 0;
+        base::grow_for(n_count + 1);
+        if (b_isours) {
+            msg = base::begin() + n_offset;
         }
-        return append('\0');
+        base::append_range(msg, msg + n_count);
+        base::m_pbuffer[base::m_nlength] = CharT(0);
+        return *this;
     }
 
     /**
@@ -189,6 +230,12 @@ public:
     }
 };
 
+// Same as `crim::dyarray`, we never point into ourselves.
+template<class CharT, class AllocT>
+struct crim::is_trivially_relocatable<crim::dystring<CharT, AllocT>> 
+    : crim::is_trivially_relocatable<AllocT> 
+{};
+
 namespace crim {
     /* -*- TEMPLATE INSTANTIATIONS -*- */
 
@@ -6,6 +6,8 @@
 #include <cwchar> /* WEOF, std::wmem* family, std::wcs* family, std::mbstate_t */
 #include <cstdio> /* EOF */
 
+#include "simd_char.hpp"
+
 namespace crim::impl {
     template<typename CharT>
     struct char_types;
@@ -162,6 +164,23 @@ struct crim::impl::char_traits {
         return nullptr;
     }
     
+    /**
+     * @brief   Find the first occurence of `needle` in `s`, which is `len` long.
+     *          Not in `std::char_traits`, but `find` on strings wants it.
+     * 
+     * @return  Pointer to occurence or `nullptr`. An empty `needle` is found
+     *          right at the start.
+     */
+    static const_pointer search(const_pointer s, size_type len, const_pointer needle, size_type needle_len)
+    {
+        for (size_type idx = 0; idx + needle_len <= len; idx++) {
+            if (compare(s + idx, needle, needle_len) == 0) {
+                return s + idx;
+            }
+        }
+        return nullptr;
+    }
+    
     static pointer move(pointer dst, const_pointer src, size_type len)
     {
         void *ptr = std::memmove(dst, src, sizeof(char_type) * len);
@@ -276,6 +295,11 @@ struct crim::impl::char_types<char> {
  *          By inheriting the base class publicly, we have access to many of the
  *          predefined functions that we did not specialize.
  *          So common functions like `copy` and `move` are inherited.
+ *
+ * @note    Scanning functions go through `crim::impl::simd::dispatch()`, so
+ *          they use SSE2 or AVX2, whichever the CPU has, even without `-mavx2`.
+ *          Every container built on us gets that for free. On glibc only
+ *          `search` does, see `impl/simd_char.hpp` for why.
  */
 template<> 
 struct crim::char_traits<char> : public crim::impl::char_traits<char> {
@@ -297,27 +321,43 @@ struct crim::char_traits<char> : public crim::impl::char_traits<char> {
      */
     static int compare(const_pointer s1, const_pointer s2, size_type len)
     {
+#if defined(CRIM_CHAR_TRAITS_LIBC_SCANS)
         return std::memcmp(s1, s2, len);
+#else
+        return impl::simd::dispatch().compare(s1, s2, len);
+#endif
     }
     
     /**
-     * @brief   String length, duh. Specialization to call `std::strlen`.
-     * 
-     * @note    `std::strlen` will ONLY work for char types, hence the need for
-     *          the specialization.
+     * @brief   String length, duh. Same result as `std::strlen`.
      */
     static size_type length(const_pointer s)
     {
+#if defined(CRIM_CHAR_TRAITS_LIBC_SCANS)
         return std::strlen(s);
+#else
+        return impl::simd::dispatch().length(s);
+#endif
     }
     
     /**
-     * @brief   Find first occurence of `ch` in `s`. Calls `std::memchr`.
+     * @brief   Find first occurence of `ch` in `s`, like `std::memchr`.
      */
     static const_pointer find(const_pointer s, size_type len, const_reference ch)
     {
-        const void *p = std::memchr(s, ch, len);
-        return static_cast<const_pointer>(p);
+#if defined(CRIM_CHAR_TRAITS_LIBC_SCANS)
+        return static_cast<const_pointer>(std::memchr(s, ch, len));
+#else
+        return impl::simd::dispatch().find(s, len, ch);
+#endif
+    }
+    
+    /**
+     * @brief   Find first occurence of `needle` in `s`, like `memmem`.
+     */
+    static const_pointer search(const_pointer s, size_type len, const_pointer needle, size_type needle_len)
+    {
+        return impl::simd::dispatch().search(s, len, needle, needle_len);
     }
     
     /**
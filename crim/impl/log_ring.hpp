@@ -0,0 +1,374 @@
+#pragma once
+
+#include <atomic> /* std::atomic, std::memory_order_* */
+#include <chrono> /* std::chrono::milliseconds */
+#include <condition_variable> /* std::condition_variable */
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fputs, std::fwrite, std::snprintf */
+#include <cstdlib> /* std::atexit */
+#include <cstring> /* std::memcpy, std::strlen */
+#include <mutex> /* std::mutex, std::lock_guard, std::unique_lock */
+#include <new> /* std::nothrow */
+#include <thread> /* std::thread */
+
+namespace crim::impl {
+    class log_ring;
+
+    class async_logger;
+};
+
+/**
+ * @brief   Single producer, single consumer queue of already formatted log
+ *          lines. Each slot is a fixed size, so a push is one copy into memory
+ *          we already have and never a call to `malloc`.
+ *
+ * @note    Lines longer than a slot are cut short and end in `"...\n"`.
+ *
+ * @warning `reserve()` and `commit()` are for the owning thread only, `drain()`
+ *          for whoever holds `async_logger`'s drain lock.
+ */
+class crim::impl::log_ring {
+public:
+    using size_type = std::size_t;
+
+    static constexpr size_type n_slots = 64; // Must be a power of 2.
+    static constexpr size_type n_slotsize = 256;
+
+    struct slot {
+        size_type length;
+        char text[n_slotsize - sizeof(size_type)];
+    };
+
+private:
+    // Producer and consumer each write one of these, keep them on separate lines.
+    alignas(64) std::atomic<size_type> m_nhead; // Next slot to read.
+    alignas(64) std::atomic<size_type> m_ntail; // Next slot to write.
+    std::atomic<bool> m_bowned; // Does some live thread push to us?
+    log_ring *m_pnext; // Next in the list of every ring, set once.
+    slot m_slots[n_slots];
+
+    friend class async_logger;
+
+public:
+    log_ring() : m_nhead{0}, m_ntail{0}, m_bowned{true}, m_pnext{nullptr} {}
+
+    log_ring(const log_ring &other) = delete;
+    log_ring &operator=(const log_ring &other) = delete;
+
+    /**
+     * @brief   Producer only. Gives you the next free slot to fill in, or
+     *          `nullptr` if the consumer is too far behind. Nothing is visible
+     *          until you `commit()` it.
+     */
+    slot *reserve() noexcept {
+        size_type n_tail = m_ntail.load(std::memory_order_relaxed);
+        if (n_tail - m_nhead.load(std::memory_order_acquire) == n_slots) {
+            return nullptr;
+        }
+        return &m_slots[n_tail & (n_slots - 1)];
+    }
+
+    void commit() noexcept {
+        m_ntail.store(m_ntail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief   Consumer only. Hands every slot pushed so far to `on_slot` and
+     *          then gives them back to the producer.
+     *
+     * @return  How many slots there were.
+     */
+    template<class Callback>
+    size_type drain(Callback on_slot) {
+        size_type n_head = m_nhead.load(std::memory_order_relaxed);
+        size_type n_tail = m_ntail.load(std::memory_order_acquire);
+        for (size_type i = n_head; i != n_tail; i++) {
+            on_slot(m_slots[i & (n_slots - 1)]);
+        }
+        m_nhead.store(n_tail, std::memory_order_release);
+        return n_tail - n_head;
+    }
+};
+
+/**
+ * @brief   What `crim_logerror` uses with `CRIM_LOGERROR_USE_ASYNC`. Every
+ *          thread formats its messages into its own `log_ring`, and one
+ *          background thread copies them all to `stderr` in big writes. So
+ *          workers that log a lot never wait on each other for the `stderr`
+ *          lock, or on `stderr` itself.
+ *
+ *          If a ring is full the message is dropped and counted instead of
+ *          making its thread wait. The count is written out the next time the
+ *          background thread gets to it.
+ *
+ * @note    Memory is bounded: a ring is only made when a thread logs for the
+ *          first time and no ring is free, and it's freed up for another
+ *          thread when its own thread exits. So we never have more rings than
+ *          the most threads that were ever logging at once.
+ *
+ *          Whatever is left is flushed at exit, after which every message is
+ *          written straight to `stderr`, the way the default backend does it.
+ */
+class crim::impl::async_logger {
+public:
+    using size_type = std::size_t;
+
+    // Copies `errmsg` as is, for `crim::logerror_lit()`.
+    static void write(const char *errmsg) noexcept
+    {
+        if (stopped()) {
+            std::fputs(errmsg, stderr);
+            return;
+        }
+        log_ring::slot *p_slot = reserve();
+        if (p_slot == nullptr) {
+            return;
+        }
+        size_type n_length = std::strlen(errmsg);
+        if (n_length > sizeof(p_slot->text)) {
+            std::memcpy(p_slot->text, errmsg, sizeof(p_slot->text));
+            n_length = truncate(*p_slot);
+        } else {
+            std::memcpy(p_slot->text, errmsg, n_length);
+        }
+        p_slot->length = n_length;
+        commit();
+    }
+
+    // Same text as the default `crim::logerror_fmt()`.
+    static void format(const char *file, int line, const char *name, const char *func, const char *info) noexcept
+    {
+        if (stopped()) {
+            std::fprintf(stderr, "%s:%i:\n\t%s::%s(): %s\n", file, line, name, func, info);
+            return;
+        }
+        log_ring::slot *p_slot = reserve();
+        if (p_slot == nullptr) {
+            return;
+        }
+        int n_written = std::snprintf(p_slot->text, sizeof(p_slot->text), "%s:%i:\n\t%s::%s(): %s\n",
+            file, line, name, func, info);
+        size_type n_length = (n_written > 0) ? static_cast<size_type>(n_written) : 0;
+        if (n_length >= sizeof(p_slot->text)) {
+            n_length = truncate(*p_slot);
+        }
+        p_slot->length = n_length;
+        commit();
+    }
+
+    /**
+     * @brief   Writes out everything logged so far, from every thread, before
+     *          returning. Use it before you `abort()` or hand `stderr` over
+     *          to something else.
+     */
+    static void flush()
+    {
+        std::lock_guard<std::mutex> guard(state().drainlock);
+        drain_all();
+    }
+
+    // How many messages were dropped because their ring was full, ever.
+    static size_type dropped() noexcept
+    {
+        return state().n_dropped.load(std::memory_order_relaxed);
+    }
+
+    // How many rings were ever made.
+    static size_type rings() noexcept
+    {
+        size_type n_rings = 0;
+        for (log_ring *p_ring = state().rings.load(std::memory_order_acquire); p_ring != nullptr; p_ring = p_ring->m_pnext) {
+            n_rings++;
+        }
+        return n_rings;
+    }
+
+private:
+    struct shared_state {
+        std::atomic<log_ring *> rings{nullptr};
+        std::atomic<size_type> n_dropped{0};
+        size_type n_reported = 0; // Drops written out so far, drain lock only.
+        std::atomic<bool> b_sleeping{false};
+        std::atomic<bool> b_stopping{false};
+        std::atomic<bool> b_stopped{false};
+        std::mutex drainlock;
+        std::mutex sleeplock;
+        std::condition_variable wakeup;
+        std::thread *p_drainer = nullptr; // Leaked so no destructor races the exit handler.
+    };
+
+    // Gives our ring back when our thread exits.
+    struct ring_owner {
+        log_ring *p_ring = nullptr;
+
+        ~ring_owner() {
+            if (p_ring != nullptr) {
+                p_ring->m_bowned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    // How long the drainer sleeps if a wakeup gets past it.
+    static constexpr std::chrono::milliseconds n_interval{10};
+
+    // Leaked, so anything logging from a static destructor still finds it.
+    static shared_state &state() noexcept
+    {
+        static shared_state *p_state = new shared_state();
+        return *p_state;
+    }
+
+    static ring_owner &local() noexcept
+    {
+        static thread_local ring_owner owner;
+        return owner;
+    }
+
+    static bool stopped() noexcept
+    {
+        return state().b_stopped.load(std::memory_order_acquire);
+    }
+
+    // Our thread's next free slot, or `nullptr` and one more drop.
+    static log_ring::slot *reserve() noexcept
+    {
+        ring_owner &owner = local();
+        if (owner.p_ring == nullptr) {
+            owner.p_ring = acquire_ring();
+            if (owner.p_ring == nullptr) {
+                state().n_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        log_ring::slot *p_slot = owner.p_ring->reserve();
+        if (p_slot == nullptr) {
+            state().n_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return p_slot;
+    }
+
+    static void commit() noexcept
+    {
+        local().p_ring->commit();
+        shared_state &s = state();
+        // Only pay for the wakeup if the drainer actually went to sleep.
+        if (s.b_sleeping.load(std::memory_order_seq_cst)) {
+            s.wakeup.notify_one();
+        }
+    }
+
+    static size_type truncate(log_ring::slot &slot) noexcept
+    {
+        size_type n_length = sizeof(slot.text);
+        std::memcpy(slot.text + n_length - 4, "...\n", 4);
+        return n_length;
+    }
+
+    // Slow path, once per thread: reuse a ring from a thread that's gone or
+    // make a new one. The first call starts the drainer.
+    [[gnu::noinline]] static log_ring *acquire_ring() noexcept
+    {
+        static const bool b_started = start();
+        if (!b_started) {
+            return nullptr;
+        }
+        shared_state &s = state();
+        for (log_ring *p_ring = s.rings.load(std::memory_order_acquire); p_ring != nullptr; p_ring = p_ring->m_pnext) {
+            bool b_owned = false;
+            // Acquire, so we carry on from wherever the last owner's tail was.
+            if (p_ring->m_bowned.compare_exchange_strong(b_owned, true, std::memory_order_acquire)) {
+                return p_ring;
+            }
+        }
+        log_ring *p_ring = new (std::nothrow) log_ring();
+        if (p_ring == nullptr) {
+            return nullptr;
+        }
+        p_ring->m_pnext = s.rings.load(std::memory_order_relaxed);
+        while (!s.rings.compare_exchange_weak(p_ring->m_pnext, p_ring, std::memory_order_release, std::memory_order_relaxed)) {
+            // `p_ring->m_pnext` was reloaded for us, try again.
+        }
+        return p_ring;
+    }
+
+    static bool start() noexcept
+    {
+        shared_state &s = state();
+        try {
+            s.p_drainer = new std::thread(drainer_main);
+        } catch (...) {
+            std::fputs("crim::impl::async_logger: Could not start the drainer!\n", stderr);
+            return false;
+        }
+        std::atexit(stop);
+        return true;
+    }
+
+    static void drainer_main()
+    {
+        shared_state &s = state();
+        for (;;) {
+            size_type n_drained;
+            {
+                std::lock_guard<std::mutex> guard(s.drainlock);
+                n_drained = drain_all();
+            }
+            if (n_drained > 0) {
+                continue;
+            }
+            if (s.b_stopping.load(std::memory_order_acquire)) {
+                break;
+            }
+            // Pairs with the check in `commit()`. Something pushed just as we
+            // nod off can still wait the whole interval, but no longer.
+            std::unique_lock<std::mutex> guard(s.sleeplock);
+            s.b_sleeping.store(true, std::memory_order_seq_cst);
+            s.wakeup.wait_for(guard, n_interval);
+            s.b_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Drain lock only. Batches everything up so `stderr` sees a few big
+    // writes instead of one per message.
+    static size_type drain_all()
+    {
+        shared_state &s = state();
+        char buffer[8192];
+        size_type n_buffered = 0;
+        auto on_slot = [&](const log_ring::slot &slot) {
+            if (n_buffered + slot.length > sizeof(buffer)) {
+                std::fwrite(buffer, 1, n_buffered, stderr);
+                n_buffered = 0;
+            }
+            std::memcpy(buffer + n_buffered, slot.text, slot.length);
+            n_buffered += slot.length;
+        };
+        size_type n_drained = 0;
+        for (log_ring *p_ring = s.rings.load(std::memory_order_acquire); p_ring != nullptr; p_ring = p_ring->m_pnext) {
+            n_drained += p_ring->drain(on_slot);
+        }
+        std::fwrite(buffer, 1, n_buffered, stderr);
+
+        size_type n_dropped = s.n_dropped.load(std::memory_order_relaxed);
+        if (n_dropped != s.n_reported) {
+            std::fprintf(stderr, "crim::impl::async_logger: dropped %zu messages\n", n_dropped - s.n_reported);
+            s.n_reported = n_dropped;
+        }
+        return n_drained;
+    }
+
+    static void stop()
+    {
+        shared_state &s = state();
+        {
+            std::lock_guard<std::mutex> guard(s.sleeplock);
+            s.b_stopping.store(true, std::memory_order_release);
+        }
+        s.wakeup.notify_one();
+        s.p_drainer->join();
+        // Anyone still logging now goes straight to `stderr`, but they may
+        // have pushed just before that.
+        s.b_stopped.store(true, std::memory_order_release);
+        flush();
+    }
+};
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uintptr_t */
+#include <cstring> /* std::memchr, std::memcmp, std::strlen */
+
+/**
+ * x86-64 always has SSE2, so that's our baseline. The AVX2 versions are built
+ * with a `target` attribute so you don't need `-mavx2`, and only get picked if
+ * cpuid says the CPU (and OS) can actually run them.
+ *
+ * Define `CRIM_CHAR_TRAITS_NO_SIMD` to go back to plain libc everywhere.
+ */
+#if !defined(CRIM_CHAR_TRAITS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define CRIM_CHAR_TRAITS_USE_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> /* __cpuid, _BitScanForward */
+#define CRIM_TARGET_AVX2
+#define CRIM_NO_SANITIZE_ADDRESS
+#else
+#define CRIM_TARGET_AVX2 __attribute__((target("avx2")))
+#define CRIM_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+
+/**
+ * glibc already picks an SSE2/AVX2/EVEX `memchr`, `memcmp` and `strlen` for the
+ * CPU at load time, and they beat ours (see `crim/.strings/char_traits.cpp`).
+ * Calling them directly also lets the compiler fold them for constant strings.
+ * So there we only bring `search`, which `memmem` doesn't vectorize.
+ */
+#if !defined(CRIM_CHAR_TRAITS_USE_SIMD) || defined(__GLIBC__)
+#define CRIM_CHAR_TRAITS_LIBC_SCANS
+#endif
+
+namespace crim::impl::simd {
+    using find_fn = const char *(*)(const char *p_data, std::size_t n_length, char ch);
+    using compare_fn = int (*)(const char *p_lhs, const char *p_rhs, std::size_t n_length);
+    using length_fn = std::size_t (*)(const char *p_data);
+    using search_fn = const char *(*)(const char *p_hay, std::size_t n_hay,
+        const char *p_needle, std::size_t n_needle);
+
+    struct dispatch_table;
+    const dispatch_table &dispatch() noexcept;
+};
+
+/**
+ * @brief   Which version of each function this CPU gets. Filled in once, the
+ *          first time any of them is called.
+ */
+struct crim::impl::simd::dispatch_table {
+    const char *name; // "avx2", "sse2" or "libc", plus "(glibc)" if we defer to it.
+    find_fn find;
+    compare_fn compare;
+    length_fn length;
+    search_fn search;
+};
+
+/**
+ * BEGIN: PORTABLE FALLBACKS -*-------------------------------------------------
+ */
+
+namespace crim::impl::simd::libc {
+    inline const char *find(const char *p_data, std::size_t n_length, char ch)
+    {
+        return static_cast<const char *>(std::memchr(p_data, ch, n_length));
+    }
+
+    inline int compare(const char *p_lhs, const char *p_rhs, std::size_t n_length)
+    {
+        return std::memcmp(p_lhs, p_rhs, n_length);
+    }
+
+    inline std::size_t length(const char *p_data)
+    {
+        return std::strlen(p_data);
+    }
+
+    // Jump between occurences of the first character, then compare the rest.
+    inline const char *search(const char *p_hay, std::size_t n_hay,
+        const char *p_needle, std::size_t n_needle)
+    {
+        if (n_needle == 0) {
+            return p_hay;
+        }
+        const char *p_end = p_hay + n_hay;
+        while (static_cast<std::size_t>(p_end - p_hay) >= n_needle) {
+            p_hay = find(p_hay, static_cast<std::size_t>(p_end - p_hay) - n_needle + 1, p_needle[0]);
+            if (p_hay == nullptr) {
+                return nullptr;
+            } else if (std::memcmp(p_hay + 1, p_needle + 1, n_needle - 1) == 0) {
+                return p_hay;
+            }
+            p_hay++;
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * END: PORTABLE FALLBACKS -*---------------------------------------------------
+ */
+
+#if defined(CRIM_CHAR_TRAITS_USE_SIMD)
+
+/**
+ * BEGIN: SSE2 AND AVX2 -*------------------------------------------------------
+ */
+
+namespace crim::impl::simd {
+    // Index of the lowest set bit in a non-zero `movemask` result.
+    inline unsigned first_bit(unsigned mask) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    inline int byte_diff(const char *p_lhs, const char *p_rhs, std::size_t n_index) noexcept
+    {
+        return static_cast<int>(static_cast<unsigned char>(p_lhs[n_index]))
+             - static_cast<int>(static_cast<unsigned char>(p_rhs[n_index]));
+    }
+};
+
+namespace crim::impl::simd::sse2 {
+    /**
+     * @brief   16 bytes per compare. The last partial block is handled by one
+     *          more load that overlaps the previous one, so no scalar tail
+     *          unless the whole input is shorter than a block.
+     */
+    inline const char *find(const char *p_data, std::size_t n_length, char ch)
+    {
+        if (n_length < 16) {
+            for (std::size_t i = 0; i < n_length; i++) {
+                if (p_data[i] == ch) {
+                    return p_data + i;
+                }
+            }
+            return nullptr;
+        }
+        const __m128i needle = _mm_set1_epi8(ch);
+        std::size_t i = 0;
+        for (/* Empty */; i + 16 <= n_length; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+            if (mask != 0) {
+                return p_data + i + first_bit(mask);
+            }
+        }
+        if (i < n_length) {
+            i = n_length - 16;
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+            if (mask != 0) {
+                return p_data + i + first_bit(mask);
+            }
+        }
+        return nullptr;
+    }
+
+    inline int compare(const char *p_lhs, const char *p_rhs, std::size_t n_length)
+    {
+        std::size_t i = 0;
+        for (/* Empty */; i + 16 <= n_length; i += 16) {
+            __m128i lhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_lhs + i));
+            __m128i rhs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_rhs + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)));
+            if (mask != 0xFFFF) {
+                return byte_diff(p_lhs, p_rhs, i + first_bit(~mask));
+            }
+        }
+        for (/* Empty */; i < n_length; i++) {
+            if (p_lhs[i] != p_rhs[i]) {
+                return byte_diff(p_lhs, p_rhs, i);
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief   We don't know where the string ends, so we only ever load whole
+     *          aligned blocks. Those never cross a page boundary so they can't
+     *          fault, but they may read a few bytes on either side of the
+     *          string. That's fine for the CPU, but not for AddressSanitizer.
+     */
+    CRIM_NO_SANITIZE_ADDRESS
+    inline std::size_t length(const char *p_data)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t n_offset = reinterpret_cast<std::uintptr_t>(p_data) & 15;
+        const char *p_block = p_data - n_offset;
+        __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(p_block));
+        // Ignore whatever comes before `p_data` in the first block.
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero))) >> n_offset;
+        if (mask != 0) {
+            return first_bit(mask);
+        }
+        for (;;) {
+            p_block += 16;
+            chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(p_block));
+            mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)));
+            if (mask != 0) {
+                return static_cast<std::size_t>(p_block - p_data) + first_bit(mask);
+            }
+        }
+    }
+
+    /**
+     * @brief   Looks for the first *and* last character of `p_needle` at once,
+     *          16 candidate positions per step. Only positions where both
+     *          match get a full `memcmp`, which is rare for real text.
+     *
+     * @note    See Wojciech Muła's "SIMD-friendly algorithms for substring
+     *          searching" for the idea.
+     */
+    inline const char *search(const char *p_hay, std::size_t n_hay,
+        const char *p_needle, std::size_t n_needle)
+    {
+        if (n_needle < 2 || n_needle > n_hay) {
+            return (n_needle == 1) ? find(p_hay, n_hay, p_needle[0])
+                 : (n_needle == 0) ? p_hay : nullptr;
+        }
+        const __m128i first = _mm_set1_epi8(p_needle[0]);
+        const __m128i last = _mm_set1_epi8(p_needle[n_needle - 1]);
+        std::size_t n_last = n_hay - n_needle; // Last valid starting position.
+        std::size_t i = 0;
+        for (/* Empty */; i + 16 <= n_last + 1; i += 16) {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_hay + i));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_hay + i + n_needle - 1));
+            __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            while (mask != 0) {
+                std::size_t n_pos = i + first_bit(mask);
+                if (std::memcmp(p_hay + n_pos + 1, p_needle + 1, n_needle - 2) == 0) {
+                    return p_hay + n_pos;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return libc::search(p_hay + i, n_hay - i, p_needle, n_needle);
+    }
+};
+
+namespace crim::impl::simd::avx2 {
+    // Same as the SSE2 version, 32 bytes at a time and unrolled twice.
+    CRIM_TARGET_AVX2
+    inline const char *find(const char *p_data, std::size_t n_length, char ch)
+    {
+        if (n_length < 32) {
+            return sse2::find(p_data, n_length, ch);
+        }
+        const __m256i needle = _mm256_set1_epi8(ch);
+        std::size_t i = 0;
+        for (/* Empty */; i + 64 <= n_length; i += 64) {
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_data + i));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_data + i + 32));
+            __m256i lo_hits = _mm256_cmpeq_epi8(lo, needle);
+            __m256i hi_hits = _mm256_cmpeq_epi8(hi, needle);
+            if (_mm256_testz_si256(_mm256_or_si256(lo_hits, hi_hits), _mm256_or_si256(lo_hits, hi_hits))) {
+                continue;
+            }
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(lo_hits));
+            if (mask != 0) {
+                return p_data + i + first_bit(mask);
+            }
+            mask = static_cast<unsigned>(_mm256_movemask_epi8(hi_hits));
+            return p_data + i + 32 + first_bit(mask);
+        }
+        for (/* Empty */; i < n_length; i += 32) {
+            // Overlap the previous block instead of running off the end.
+            i = (i + 32 <= n_length) ? i : n_length - 32;
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_data + i));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+            if (mask != 0) {
+                return p_data + i + first_bit(mask);
+            }
+        }
+        return nullptr;
+    }
+
+    CRIM_TARGET_AVX2
+    inline int compare(const char *p_lhs, const char *p_rhs, std::size_t n_length)
+    {
+        std::size_t i = 0;
+        for (/* Empty */; i + 32 <= n_length; i += 32) {
+            __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_lhs + i));
+            __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_rhs + i));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs)));
+            if (mask != 0xFFFFFFFF) {
+                return byte_diff(p_lhs, p_rhs, i + first_bit(~mask));
+            }
+        }
+        return sse2::compare(p_lhs + i, p_rhs + i, n_length - i);
+    }
+
+    // See `sse2::length()` for why we only do aligned loads.
+    CRIM_TARGET_AVX2 CRIM_NO_SANITIZE_ADDRESS
+    inline std::size_t length(const char *p_data)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        std::size_t n_offset = reinterpret_cast<std::uintptr_t>(p_data) & 31;
+        const char *p_block = p_data - n_offset;
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(p_block));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero))) >> n_offset;
+        if (mask != 0) {
+            return first_bit(mask);
+        }
+        for (;;) {
+            p_block += 32;
+            chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(p_block));
+            mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero)));
+            if (mask != 0) {
+                return static_cast<std::size_t>(p_block - p_data) + first_bit(mask);
+            }
+        }
+    }
+
+    CRIM_TARGET_AVX2
+    inline const char *search(const char *p_hay, std::size_t n_hay,
+        const char *p_needle, std::size_t n_needle)
+    {
+        if (n_needle < 2 || n_needle > n_hay) {
+            return sse2::search(p_hay, n_hay, p_needle, n_needle);
+        }
+        const __m256i first = _mm256_set1_epi8(p_needle[0]);
+        const __m256i last = _mm256_set1_epi8(p_needle[n_needle - 1]);
+        std::size_t n_last = n_hay - n_needle;
+        std::size_t i = 0;
+        for (/* Empty */; i + 32 <= n_last + 1; i += 32) {
+            __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_hay + i));
+            __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_hay + i + n_needle - 1));
+            __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            while (mask != 0) {
+                std::size_t n_pos = i + first_bit(mask);
+                if (std::memcmp(p_hay + n_pos + 1, p_needle + 1, n_needle - 2) == 0) {
+                    return p_hay + n_pos;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return sse2::search(p_hay + i, n_hay - i, p_needle, n_needle);
+    }
+
+    // cpuid leaf 7 for AVX2 itself, plus XGETBV to see the OS saves YMM state.
+    inline bool supported() noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int regs[4];
+        __cpuid(regs, 1);
+        bool b_osxsave = (regs[2] & (1 << 27)) != 0;
+        if (!b_osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuid(regs, 0);
+        if (regs[0] < 7) {
+            return false;
+        }
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+};
+
+/**
+ * END: SSE2 AND AVX2 -*--------------------------------------------------------
+ */
+
+#endif // CRIM_CHAR_TRAITS_USE_SIMD
+
+/**
+ * @brief   Picks the best version of every function for this CPU, once. Every
+ *          call after the first is just a load of the table.
+ */
+inline const crim::impl::simd::dispatch_table &crim::impl::simd::dispatch() noexcept
+{
+    static const dispatch_table table = []() noexcept -> dispatch_table {
+#if defined(CRIM_CHAR_TRAITS_USE_SIMD) && defined(CRIM_CHAR_TRAITS_LIBC_SCANS)
+        if (avx2::supported()) {
+            return {"avx2 (glibc)", libc::find, libc::compare, libc::length, avx2::search};
+        }
+        return {"sse2 (glibc)", libc::find, libc::compare, libc::length, sse2::search};
+#elif defined(CRIM_CHAR_TRAITS_USE_SIMD)
+        if (avx2::supported()) {
+            return {"avx2", avx2::find, avx2::compare, avx2::length, avx2::search};
+        }
+        return {"sse2", sse2::find, sse2::compare, sse2::length, sse2::search};
+#else
+        return {"libc", libc::find, libc::compare, libc::length, libc::search};
+#endif
+    }();
+    return table;
+}
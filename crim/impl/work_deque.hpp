@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic> /* std::atomic, std::memory_order_* */
+#include <cstddef> /* std::size_t, std::ptrdiff_t */
+#include <memory> /* std::unique_ptr */
+#include <vector> /* std::vector */
+
+namespace crim::impl {
+    template<class T>
+    class work_deque;
+};
+
+/**
+ * @brief   Chase-Lev work-stealing deque of `T *`. The owning thread pushes
+ *          and pops at the bottom, like a stack, so it keeps working on what
+ *          it touched last. Any other thread may steal from the top, where
+ *          the oldest and usually biggest pieces of work are.
+ *
+ *          Only `steal()` and the very last element ever need a CAS, so the
+ *          owner almost never fights with anyone.
+ *
+ * @note    Follows "Correct and Efficient Work-Stealing for Weak Memory
+ *          Models" by Lê, Pop, Cohen and Zappa Nardelli (PPoPP 2013), except
+ *          the standalone fences are folded into `seq_cst` loads and stores.
+ *          It's the same cost on x86 and ThreadSanitizer understands it.
+ *
+ * @warning `push()` and `pop()` are for the owner only. Old buffers are kept
+ *          until we're destroyed, since a thief may still be reading them.
+ */
+template<class T>
+class crim::impl::work_deque {
+public:
+    using size_type = std::size_t;
+
+private:
+    // Circular buffer whose size is a power of 2, indexed by the raw counters.
+    struct ring {
+        std::ptrdiff_t n_mask;
+        std::unique_ptr<std::atomic<T *>[]> p_slots;
+
+        explicit ring(std::ptrdiff_t n_capacity)
+            : n_mask{n_capacity - 1}
+            , p_slots{new std::atomic<T *>[static_cast<size_type>(n_capacity)]}
+        {}
+
+        std::ptrdiff_t capacity() const noexcept {
+            return n_mask + 1;
+        }
+
+        T *get(std::ptrdiff_t n_index) const noexcept {
+            return p_slots[n_index & n_mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::ptrdiff_t n_index, T *p_item) noexcept {
+            p_slots[n_index & n_mask].store(p_item, std::memory_order_relaxed);
+        }
+    };
+
+    // Owner and thieves hammer different ends, so keep them on separate lines.
+    alignas(64) std::atomic<std::ptrdiff_t> m_ntop;
+    alignas(64) std::atomic<std::ptrdiff_t> m_nbottom;
+    std::atomic<ring *> m_pring;
+    std::vector<std::unique_ptr<ring>> m_rings; // Every ring we ever had. Owner only.
+
+public:
+    explicit work_deque(size_type n_capacity = 256) : m_ntop{0}, m_nbottom{0} {
+        size_type n_size = 2;
+        while (n_size < n_capacity) {
+            n_size *= 2;
+        }
+        m_rings.emplace_back(new ring(static_cast<std::ptrdiff_t>(n_size)));
+        m_pring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    work_deque(const work_deque &other) = delete;
+    work_deque &operator=(const work_deque &other) = delete;
+
+    /**
+     * @brief   Owner only. Adds `p_item` at the bottom, growing if needed.
+     */
+    void push(T *p_item) {
+        std::ptrdiff_t n_bottom = m_nbottom.load(std::memory_order_relaxed);
+        std::ptrdiff_t n_top = m_ntop.load(std::memory_order_acquire);
+        ring *p_ring = m_pring.load(std::memory_order_relaxed);
+        if (n_bottom - n_top >= p_ring->capacity()) {
+            p_ring = grow(p_ring, n_top, n_bottom);
+        }
+        p_ring->put(n_bottom, p_item);
+        // Publishes the item itself, and whatever it points to, to thieves.
+        m_nbottom.store(n_bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief   Owner only. Takes the most recently pushed item.
+     *
+     * @return  `nullptr` if we're empty or a thief beat us to the last one.
+     */
+    T *pop() noexcept {
+        std::ptrdiff_t n_bottom = m_nbottom.load(std::memory_order_relaxed) - 1;
+        ring *p_ring = m_pring.load(std::memory_order_relaxed);
+        // Claim the slot before looking at `top`, else we race with `steal()`.
+        m_nbottom.store(n_bottom, std::memory_order_seq_cst);
+        std::ptrdiff_t n_top = m_ntop.load(std::memory_order_seq_cst);
+        if (n_top > n_bottom) {
+            m_nbottom.store(n_bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T *p_item = p_ring->get(n_bottom);
+        if (n_top == n_bottom) {
+            // Last one left, so thieves might want it too.
+            if (!m_ntop.compare_exchange_strong(n_top, n_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                p_item = nullptr;
+            }
+            m_nbottom.store(n_bottom + 1, std::memory_order_relaxed);
+        }
+        return p_item;
+    }
+
+    /**
+     * @brief   Any thread. Takes the oldest item.
+     *
+     * @return  `nullptr` if we're empty, or if another thread got there first.
+     *          So `nullptr` doesn't always mean empty, just "try elsewhere".
+     */
+    T *steal() noexcept {
+        std::ptrdiff_t n_top = m_ntop.load(std::memory_order_seq_cst);
+        std::ptrdiff_t n_bottom = m_nbottom.load(std::memory_order_seq_cst);
+        if (n_top >= n_bottom) {
+            return nullptr;
+        }
+        ring *p_ring = m_pring.load(std::memory_order_acquire);
+        T *p_item = p_ring->get(n_top);
+        if (!m_ntop.compare_exchange_strong(n_top, n_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return p_item;
+    }
+
+    // Only a snapshot: it may be stale by the time you look at it.
+    bool empty() const noexcept {
+        std::ptrdiff_t n_top = m_ntop.load(std::memory_order_relaxed);
+        std::ptrdiff_t n_bottom = m_nbottom.load(std::memory_order_relaxed);
+        return n_bottom <= n_top;
+    }
+
+private:
+    // Copies the live range into a ring twice the size. Owner only.
+    ring *grow(ring *p_old, std::ptrdiff_t n_top, std::ptrdiff_t n_bottom) {
+        m_rings.emplace_back(new ring(p_old->capacity() * 2));
+        ring *p_new = m_rings.back().get();
+        for (std::ptrdiff_t i = n_top; i < n_bottom; i++) {
+            p_new->put(i, p_old->get(i));
+        }
+        m_pring.store(p_new, std::memory_order_release);
+        return p_new;
+    }
+};
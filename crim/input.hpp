@@ -11,6 +11,7 @@
 #include "logerror.hpp"
 #include "memory.tcc"
 #include "base_string.tcc"
+#include "mapped_file.hpp"
 
 // Don't forget to `#undef` this at the end of this file, others need it!
 #define crim_logerror(func, info) crim_logerror_nofunc("crim", func, info)
@@ -49,6 +50,28 @@ namespace crim {
         }
         return input;
     }
+
+    /**
+     * @brief   Same as above, but copies the next line of `file` instead. The
+     *          line ending was already handled by `crim::mapped_file`.
+     *
+     * @note    Use `file.readline()` directly if a view is all you need.
+     */
+    cstring readline(mapped_file &file)
+    {
+        cstring input;
+        mapped_file::view_type line;
+        if (!file.readline(line)) {
+            return input;
+        }
+        for (char ch : line) {
+            if (!input.push_back(ch)) {
+                crim_logerror("readline", "input.push_back() failed!");
+                break;
+            }
+        }
+        return input;
+    }
     
     cstring get_string(const char *p_fmts, ...)
     {
@@ -3,6 +3,9 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "mapped_file.hpp"
 
 /**
  * `__FILE__` and `__FILE__` are expanded at compile-time.
@@ -77,6 +80,27 @@ namespace crim {
         return buffer;
     }
 
+    /**
+     * Same as above, but reads the next line of an already mapped file.
+     * This avoids going through `fgetc` one character at a time.
+     * @param file Its line endings are already accounted for.
+     * @return `NULL` once all lines have been read or on allocation failure.
+     */
+    char *readline(mapped_file &file) {
+        mapped_file::view_type line;
+        if (!file.readline(line)) {
+            return NULL;
+        }
+        char *buffer = (char*)malloc(sizeof(*buffer) * (line.size() + 1));
+        if (buffer == NULL) {
+            crim_log_error("Failed to allocate buffer!\n");
+            return NULL;
+        }
+        memcpy(buffer, line.data(), line.size());
+        buffer[line.size()] = '\0';
+        return buffer;
+    }
+
     /**
      * Prompts user to enter a line of text into the standard input stream.
      * Their inputs are stored in a heap-allocated `char` pointer.
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uint32_t */
+#include <stdexcept> /* std::logic_error */
+#include <string_view> /* std::string_view */
+
+namespace crim {
+    template<std::size_t N>
+    class keyword_table;
+
+    template<class... Args>
+    constexpr keyword_table<sizeof...(Args)> make_keyword_table(const Args &...keywords);
+};
+
+/**
+ * @brief   Perfect hash table for a small, fixed set of keywords, found at
+ *          compile time. Turns a chain of `if (word == "red") ... else if`
+ *          into one multiply, one shift, one table load and a comparison.
+ *
+ *          Build it with `crim::make_keyword_table`:
+ *
+ *          `constexpr auto COLORS = crim::make_keyword_table("red", "green", "blue");`
+ *
+ *          Keywords are numbered in the order you gave them, so the easiest
+ *          way to get an enum back out is to declare it in that order too.
+ *
+ * @note    C++17 won't let string literals be template arguments, so we can't
+ *          do `keyword_table<"red", "green", "blue">`. A `constexpr` variable
+ *          gets us the same thing: the seed search below runs in the compiler.
+ *
+ * @note    Each keyword is hashed by its length plus its first, middle and last
+ *          characters. That's plenty for parser keywords, but two keywords
+ *          which agree on all four can't be told apart, so that's an error.
+ */
+template<std::size_t N>
+class crim::keyword_table {
+public:
+    using size_type = std::size_t;
+    using view_type = std::string_view;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    static_assert(N > 0, "crim::keyword_table needs at least one keyword");
+    static_assert(N < 256, "crim::keyword_table only fits 255 keywords");
+
+private:
+    // Power of 2 so we can use the top bits of the product. Around N^2 slots
+    // means a random seed usually works on the first few tries.
+    static constexpr size_type slot_bits() {
+        size_type n_bits = 1;
+        while ((size_type{1} << n_bits) < N * N && n_bits < 12) {
+            n_bits++;
+        }
+        return n_bits;
+    }
+
+    static constexpr size_type n_slotbits = slot_bits();
+    static constexpr size_type n_slots = size_type{1} << n_slotbits;
+
+    view_type m_keywords[N];
+    std::uint32_t m_mixes[N]; // `mix()` of each keyword, to rule most keys out early.
+    unsigned char m_slots[n_slots]; // Keyword index plus 1, or 0 for none.
+    std::uint32_t m_seed;
+
+public:
+    /**
+     * @brief   Finds a seed which puts every keyword in its own slot.
+     *
+     * @exception   `std::logic_error` if the keywords can't be told apart or
+     *              we gave up looking. In a `constexpr` variable that's a
+     *              compile error instead, which is the point.
+     */
+    constexpr explicit keyword_table(const view_type (&keywords)[N]) : m_keywords{}, m_mixes{}, m_slots{}, m_seed{0} {
+        for (size_type i = 0; i < N; i++) {
+            m_keywords[i] = keywords[i];
+            m_mixes[i] = mix(keywords[i]);
+            for (size_type j = 0; j < i; j++) {
+                if (mix(keywords[i]) == mix(keywords[j])) {
+                    throw std::logic_error("crim::keyword_table keywords collide, "
+                        "they need different lengths or first, middle or last chars");
+                }
+            }
+        }
+        for (std::uint32_t n_try = 0; n_try < 4096; n_try++) {
+            // Golden ratio steps, always odd so no bits get thrown away.
+            m_seed = (n_try * 0x9E3779B9u) | 1u;
+            if (try_seed()) {
+                return;
+            }
+        }
+        throw std::logic_error("crim::keyword_table could not find a perfect hash");
+    }
+
+    /* -*- LOOKUP METHODS -*- */
+
+    /**
+     * @brief   Index of `key` in the list we were built from, else `npos`.
+     */
+    constexpr size_type find(view_type key) const noexcept {
+        std::uint32_t n_mix = mix(key);
+        // Empty slots wrap around to `npos`.
+        size_type n_index = static_cast<size_type>(m_slots[slot(n_mix)]) - 1;
+        if (n_index == npos || m_mixes[n_index] != n_mix || m_keywords[n_index].size() != key.size()) {
+            return npos;
+        }
+        // Same ends, middle and length already. Keywords are short, so a plain
+        // loop over what's left beats a call to `memcmp`.
+        const char *p_keyword = m_keywords[n_index].data();
+        for (size_type i = 1; i + 1 < key.size(); i++) {
+            if (p_keyword[i] != key[i]) {
+                return npos;
+            }
+        }
+        return n_index;
+    }
+
+    constexpr bool contains(view_type key) const noexcept {
+        return find(key) != npos;
+    }
+
+    /**
+     * @brief   `find(key)` cast to your enum, whose values should start at 0
+     *          and follow the order of the keywords.
+     *
+     * @return  `if_missing` if `key` isn't one of ours.
+     */
+    template<class EnumT>
+    constexpr EnumT to_enum(view_type key, EnumT if_missing) const noexcept {
+        size_type n_index = find(key);
+        return (n_index == npos) ? if_missing : static_cast<EnumT>(n_index);
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    constexpr view_type operator[](size_type n_index) const noexcept {
+        return m_keywords[n_index];
+    }
+
+    constexpr size_type size() const noexcept {
+        return N;
+    }
+
+private:
+    // Length and 3 characters in one word. Empty keys all become 0.
+    static constexpr std::uint32_t mix(view_type key) noexcept {
+        if (key.empty()) {
+            return 0;
+        }
+        size_type n_length = key.size();
+        return static_cast<std::uint32_t>(n_length & 0xFF)
+             | static_cast<std::uint32_t>(static_cast<unsigned char>(key[0])) << 8
+             | static_cast<std::uint32_t>(static_cast<unsigned char>(key[n_length / 2])) << 16
+             | static_cast<std::uint32_t>(static_cast<unsigned char>(key[n_length - 1])) << 24;
+    }
+
+    // Multiplicative hashing: the top bits of the product are the best mixed.
+    constexpr size_type slot(std::uint32_t n_mix) const noexcept {
+        return static_cast<size_type>((n_mix * m_seed) >> (32 - n_slotbits));
+    }
+
+    // Fills in `m_slots` if `m_seed` has no collisions, else leaves it empty.
+    constexpr bool try_seed() {
+        for (size_type i = 0; i < N; i++) {
+            size_type n_slot = slot(m_mixes[i]);
+            if (m_slots[n_slot] != 0) {
+                for (size_type j = 0; j < i; j++) {
+                    m_slots[slot(m_mixes[j])] = 0;
+                }
+                return false;
+            }
+            m_slots[n_slot] = static_cast<unsigned char>(i + 1);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief   Builds a `crim::keyword_table` out of string literals (or anything
+ *          else `std::string_view` can be made from). Assign it to a
+ *          `constexpr` variable so the work happens at compile time.
+ */
+template<class... Args>
+constexpr crim::keyword_table<sizeof...(Args)> crim::make_keyword_table(const Args &...keywords)
+{
+    const std::string_view list[] = {std::string_view(keywords)...};
+    return keyword_table<sizeof...(Args)>(list);
+}
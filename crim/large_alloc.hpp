@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic> /* std::atomic */
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fprintf */
+#include <cstdlib> /* std::malloc, std::realloc, std::free */
+#include <cstring> /* std::memcpy */
+
+/**
+ * Windows has no `mmap`, so big blocks just come from `std::malloc` there.
+ * Only Linux has `mremap`, other POSIX systems map a new block and copy.
+ * You can also define this yourself to test the fallback path on POSIX.
+ */
+#if defined(_WIN32) && !defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+#define CRIM_LARGE_ALLOC_USE_MALLOC
+#endif
+
+#ifndef CRIM_LARGE_ALLOC_USE_MALLOC
+#include <sys/mman.h> /* mmap, mremap, munmap */
+#include <unistd.h> /* sysconf */
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+#define CRIM_LARGE_ALLOC_USE_MREMAP
+#endif
+#endif
+
+#include "logerror.hpp"
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::large_alloc", func, info)
+
+namespace crim {
+    class large_alloc;
+};
+
+/**
+ * BEGIN: LARGE ALLOCATION IMPLEMENTATION -*------------------------------------
+ */
+
+/**
+ * @brief   Blocks of hundreds of MB straight from `mmap`. The point is growing
+ *          them: `mremap` just moves the page table entries to a bigger range,
+ *          so nothing is copied and we never hold both the old and the new
+ *          block at once. Peak RSS stays at about the size of the block.
+ *
+ *          Also keeps process-wide stats of every growth, so you can see how
+ *          many bytes were remapped instead of copied.
+ *
+ * @note    Selected for big requests of `crim::allocator` by defining the
+ *          macro `CRIM_ALLOCATOR_USE_MMAP` before including `memory.tcc`.
+ *
+ * @warning Like `crim::thread_cache`, you must give `deallocate()` the same
+ *          size you gave `allocate()`, since we have no headers.
+ */
+class crim::large_alloc {
+public:
+    // Process-wide counters, safe to read at any time.
+    struct stats {
+        std::size_t allocs; // Blocks mapped in.
+        std::size_t frees; // Blocks unmapped.
+        std::size_t growths; // Calls to `reallocate()`.
+        std::size_t moved; // ...of which ended up at a new address.
+        std::size_t bytes_remapped; // Old contents carried over without copying.
+        std::size_t bytes_copied; // Old contents we had to `memcpy` after all.
+        std::size_t bytes_mapped; // Currently mapped in.
+        std::size_t peak_mapped; // Most we ever had mapped in at once.
+    };
+
+    /**
+     * @brief   Page-aligned, zero-filled memory for at least `n_bytes`.
+     *
+     * @return  `nullptr` if we failed, just like `std::malloc`.
+     */
+    static void *allocate(std::size_t n_bytes) noexcept
+    {
+#if defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+        void *p_memory = std::malloc(n_bytes);
+        if (p_memory == nullptr) {
+            return nullptr;
+        }
+#else
+        void *p_memory = map(n_bytes);
+        if (p_memory == nullptr) {
+            crim_logerror("allocate", "mmap failed!");
+            return nullptr;
+        }
+#endif
+        counters().allocs++;
+        add_mapped(round_up(n_bytes));
+        return p_memory;
+    }
+
+    static void deallocate(void *p_memory, std::size_t n_bytes) noexcept
+    {
+        if (p_memory == nullptr) {
+            return;
+        }
+#if defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+        std::free(p_memory);
+#else
+        munmap(p_memory, round_up(n_bytes));
+#endif
+        counters().frees++;
+        counters().bytes_mapped -= round_up(n_bytes);
+    }
+
+    /**
+     * @brief   Grows or shrinks a block from `allocate()`, keeping its contents.
+     *          With `mremap` the old pages are just moved to the new range.
+     *
+     * @return  `nullptr` if we failed, in which case `p_memory` is untouched.
+     */
+    static void *reallocate(void *p_memory, std::size_t n_oldbytes, std::size_t n_newbytes) noexcept
+    {
+        std::size_t n_oldsize = round_up(n_oldbytes);
+        std::size_t n_newsize = round_up(n_newbytes);
+        std::size_t n_kept = (n_oldbytes < n_newbytes) ? n_oldbytes : n_newbytes;
+#if defined(CRIM_LARGE_ALLOC_USE_MREMAP)
+        void *p_newmemory = mremap(p_memory, n_oldsize, n_newsize, MREMAP_MAYMOVE);
+        if (p_newmemory == MAP_FAILED) {
+            crim_logerror("reallocate", "mremap failed!");
+            return nullptr;
+        }
+        counters().bytes_remapped += n_kept;
+#elif defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+        void *p_newmemory = std::realloc(p_memory, n_newbytes);
+        if (p_newmemory == nullptr) {
+            return nullptr;
+        }
+        // We can't tell if `realloc` copied or not, so assume the worst.
+        counters().bytes_copied += (p_newmemory == p_memory) ? 0 : n_kept;
+#else
+        void *p_newmemory = map(n_newbytes);
+        if (p_newmemory == nullptr) {
+            crim_logerror("reallocate", "mmap failed!");
+            return nullptr;
+        }
+        std::memcpy(p_newmemory, p_memory, n_kept);
+        munmap(p_memory, n_oldsize);
+        counters().bytes_copied += n_kept;
+#endif
+        counters().growths++;
+        counters().moved += (p_newmemory != p_memory);
+        counters().bytes_mapped -= n_oldsize;
+        add_mapped(n_newsize);
+        return p_newmemory;
+    }
+
+    static stats get_stats() noexcept
+    {
+        const counter_set &c = counters();
+        return stats{
+            c.allocs.load(), c.frees.load(), c.growths.load(), c.moved.load(),
+            c.bytes_remapped.load(), c.bytes_copied.load(),
+            c.bytes_mapped.load(), c.peak_mapped.load()
+        };
+    }
+
+    static void report(std::FILE *stream)
+    {
+        stats s = get_stats();
+        std::fprintf(stream,
+            "crim::large_alloc:\n"
+            "\t%zu allocs, %zu frees, %zu growths (%zu moved)\n"
+            "\t%zu bytes remapped, %zu bytes copied\n"
+            "\t%zu bytes mapped now, %zu bytes at peak\n",
+            s.allocs, s.frees, s.growths, s.moved,
+            s.bytes_remapped, s.bytes_copied,
+            s.bytes_mapped, s.peak_mapped);
+    }
+
+private:
+    struct counter_set {
+        std::atomic<std::size_t> allocs;
+        std::atomic<std::size_t> frees;
+        std::atomic<std::size_t> growths;
+        std::atomic<std::size_t> moved;
+        std::atomic<std::size_t> bytes_remapped;
+        std::atomic<std::size_t> bytes_copied;
+        std::atomic<std::size_t> bytes_mapped;
+        std::atomic<std::size_t> peak_mapped;
+    };
+
+    // Trivially destructible, so it's still fine to use from static destructors.
+    static counter_set &counters() noexcept
+    {
+        static counter_set c{};
+        return c;
+    }
+
+    static void add_mapped(std::size_t n_size) noexcept
+    {
+        counter_set &c = counters();
+        std::size_t n_mapped = (c.bytes_mapped += n_size);
+        std::size_t n_peak = c.peak_mapped.load();
+        while (n_mapped > n_peak && !c.peak_mapped.compare_exchange_weak(n_peak, n_mapped)) {
+            // `n_peak` was reloaded for us, try again.
+        }
+    }
+
+    static std::size_t page_size() noexcept
+    {
+#if defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+        return 4096;
+#else
+        static const std::size_t n_pagesize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return n_pagesize;
+#endif
+    }
+
+    // The kernel deals in whole pages, so we track what it actually maps.
+    static std::size_t round_up(std::size_t n_bytes) noexcept
+    {
+        std::size_t n_pagesize = page_size();
+        return (n_bytes + n_pagesize - 1) & ~(n_pagesize - 1);
+    }
+
+#if !defined(CRIM_LARGE_ALLOC_USE_MALLOC)
+    static void *map(std::size_t n_bytes) noexcept
+    {
+        void *p_memory = mmap(nullptr, round_up(n_bytes), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return (p_memory == MAP_FAILED) ? nullptr : p_memory;
+    }
+#endif
+};
+
+/**
+ * END: LARGE ALLOCATION IMPLEMENTATION -*--------------------------------------
+ */
+
+#undef crim_logerror
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <string_view> /* std::string_view */
+
+/**
+ * x86-64 always has SSE2. AVX2 is only used when the compiler is allowed to
+ * emit it, e.g. with `-mavx2` or `-march=native`.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CRIM_LINE_INDEX_USE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CRIM_LINE_INDEX_USE_SSE2
+#endif
+
+#include "dyarray.tcc"
+
+namespace crim {
+    struct line_span;
+    class line_index;
+};
+
+/**
+ * @brief   Where one line lives in the indexed buffer. The line ending itself
+ *          is never included in `length`.
+ */
+struct crim::line_span {
+    std::size_t offset;
+    std::size_t length;
+};
+
+/**
+ * @brief   Splits a whole buffer into lines in one pass, e.g. the contents of a
+ *          `crim::mapped_file`. Afterwards lines can be accessed randomly, so
+ *          you can hand out ranges of them to different threads.
+ *
+ *          LF, CRLF and lone CR are all line endings. Like `crim::readline`,
+ *          a trailing line ending doesn't produce an extra empty line.
+ *
+ * @note    We only store offsets, so the buffer must outlive the index.
+ */
+class crim::line_index {
+public:
+    using size_type = std::size_t;
+    using view_type = std::string_view;
+
+private:
+    view_type m_text; // The buffer we indexed.
+    dyarray<line_span> m_lines; // One entry per line, in order.
+
+public:
+    line_index() : m_text{}, m_lines{} {}
+
+    explicit line_index(view_type text) : line_index() {
+        build(text);
+    }
+
+    /**
+     * @brief   Throws away the old index, if any, and indexes `text` instead.
+     */
+    line_index &build(view_type text) {
+        m_text = text;
+        m_lines = dyarray<line_span>();
+
+        const char *p_data = text.data();
+        size_type n_size = text.size();
+        size_type n_start = 0; // Offset of the line we're currently in.
+
+        scan_endl(p_data, n_size, [&](size_type n_endl) {
+            // This is the LF of a CRLF we already consumed.
+            if (n_endl < n_start) {
+                return;
+            }
+            m_lines.push_back(line_span{n_start, n_endl - n_start});
+            n_start = n_endl + 1;
+            if (p_data[n_endl] == '\r' && n_start < n_size && p_data[n_start] == '\n') {
+                n_start++;
+            }
+        });
+        // Last line had no line ending.
+        if (n_start < n_size) {
+            m_lines.push_back(line_span{n_start, n_size - n_start});
+        }
+        return *this;
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    // Number of lines we found.
+    size_type size() const {
+        return m_lines.length();
+    }
+
+    bool empty() const {
+        return m_lines.empty();
+    }
+
+    /**
+     * @brief   The `n_index`'th line (0-based) as a view into the buffer.
+     *
+     * @warning No bounds checking. Good luck!
+     */
+    view_type operator[](size_type n_index) const {
+        const line_span &span = m_lines.data()[n_index];
+        return m_text.substr(span.offset, span.length);
+    }
+
+    // Raw offset and length of the `n_index`'th line, also unchecked.
+    const line_span &span(size_type n_index) const {
+        return m_lines.data()[n_index];
+    }
+
+    // The whole buffer we indexed.
+    view_type text() const {
+        return m_text;
+    }
+
+    const line_span *begin() const {
+        return m_lines.begin();
+    }
+
+    const line_span *end() const {
+        return m_lines.end();
+    }
+
+private:
+    /**
+     * @brief   Calls `on_endl(offset)` for every CR and LF in the buffer, in
+     *          order. Whole vectors are compared against both characters at
+     *          once and the resulting bitmask is walked one set bit at a time.
+     */
+    template<class Callback>
+    static void scan_endl(const char *p_data, size_type n_size, Callback on_endl) {
+        size_type i = 0;
+#if defined(CRIM_LINE_INDEX_USE_AVX2)
+        const __m256i lf = _mm256_set1_epi8('\n');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        for (/* Empty */; i + sizeof(__m256i) <= n_size; i += sizeof(__m256i)) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_data + i));
+            __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf), _mm256_cmpeq_epi8(chunk, cr));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            for (/* Empty */; mask != 0; mask &= mask - 1) {
+                on_endl(i + static_cast<size_type>(__builtin_ctz(mask)));
+            }
+        }
+#elif defined(CRIM_LINE_INDEX_USE_SSE2)
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        for (/* Empty */; i + sizeof(__m128i) <= n_size; i += sizeof(__m128i)) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + i));
+            __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            for (/* Empty */; mask != 0; mask &= mask - 1) {
+                on_endl(i + static_cast<size_type>(__builtin_ctz(mask)));
+            }
+        }
+#endif
+        // Whatever is left over that doesn't fill up a whole vector.
+        for (/* Empty */; i < n_size; i++) {
+            if (p_data[i] == '\n' || p_data[i] == '\r') {
+                on_endl(i);
+            }
+        }
+    }
+};
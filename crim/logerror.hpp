@@ -10,6 +10,14 @@
  */
 #define crim_stringify(macro) #macro
 
+/**
+ * Same idea as `crim_stringify` but for pasting 2 tokens together, so that
+ * `crim_concat(zone_, __LINE__)` gives `zone_62` and not `zone___LINE__`.
+ * Handy for naming the hidden variables that our scope macros declare.
+ */
+#define crim_concat_impl(lhs, rhs) lhs##rhs
+#define crim_concat(lhs, rhs) crim_concat_impl(lhs, rhs)
+
 /**
  * Create a concatenated string literal of the file name and a line number.
  * e.g. `"crim/base_dyarray.tcc:62"`
@@ -40,7 +48,29 @@
 #define crim_make_logmsg(scope, func, info) \
     crim_loginfo(__LINE__) "\n\t" scope "::" func "(): " info "\n"
 
-#if defined(CRIM_LOGERROR_USE_STDERR) || !defined(CRIM_LOGERROR_USE_CERR)
+#if defined(CRIM_LOGERROR_USE_ASYNC)
+#include "impl/log_ring.hpp"
+namespace crim {
+    // Same text as the `stderr` version, but only formatted here. Writing it
+    // out is left to a background thread, see `crim::impl::async_logger`.
+    static inline void 
+    logerror_fmt(const char *file, int line, const char *name, const char *func, const char *info)
+    {
+        impl::async_logger::format(file, line, name, func, info);
+    }
+
+    static inline void logerror_lit(const char *errmsg)
+    {
+        impl::async_logger::write(errmsg);
+    }
+
+    // Don't return until everything logged so far is written out.
+    static inline void logerror_flush()
+    {
+        impl::async_logger::flush();
+    }
+};
+#elif defined(CRIM_LOGERROR_USE_STDERR) || !defined(CRIM_LOGERROR_USE_CERR)
 #include <cstdio>
 namespace crim {
     // I'm not sure how much I like this because it takes effort to format.
@@ -58,6 +88,12 @@ namespace crim {
     {
         std::fputs(errmsg, stderr);
     }
+
+    // Nothing to wait for, but `CRIM_LOGERROR_USE_ASYNC` needs this.
+    static inline void logerror_flush()
+    {
+        std::fflush(stderr);
+    }
 };
 #else 
 #include <iostream>
@@ -66,6 +102,11 @@ namespace crim {
     {
         std::cerr << errmsg;
     }
+
+    void logerror_flush()
+    {
+        std::cerr.flush();
+    }
 }
 #endif
 
@@ -79,6 +120,11 @@ namespace crim {
  * @note    By default, we use `std::fputs` and `stderr`. 
  *          To use `std::cerr`, define the `CRIM_LOGERRROR_USE_CERR` macro
  *          before including this header.
+ *
+ *          Or define `CRIM_LOGERROR_USE_ASYNC` so threads only format their
+ *          messages and one background thread writes them all. Messages can
+ *          be dropped then, so call `crim::logerror_flush()` before you
+ *          `abort()`.
  */
 #define crim_logerror_func(scope, info) \
     crim::logerror_fmt(__FILE__, __LINE__, scope, __func__, info)
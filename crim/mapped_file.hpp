@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fopen, std::fread */
+#include <cstdlib> /* std::malloc, std::realloc, std::free */
+#include <string_view> /* std::string_view */
+#include <utility> /* std::swap */
+
+/**
+ * Windows doesn't have `mmap`, so we just slurp the whole file with stdio.
+ * You can also define this yourself to test the fallback path on POSIX.
+ */
+#if defined(_WIN32) && !defined(CRIM_MAPPED_FILE_USE_STDIO)
+#define CRIM_MAPPED_FILE_USE_STDIO
+#endif
+
+#ifndef CRIM_MAPPED_FILE_USE_STDIO
+#include <cerrno> /* errno, EINTR */
+#include <fcntl.h> /* open, posix_fadvise */
+#include <sys/mman.h> /* mmap, munmap, madvise */
+#include <sys/stat.h> /* fstat, S_ISREG */
+#include <unistd.h> /* read, close */
+#endif
+
+#include "logerror.hpp"
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::mapped_file", func, info)
+
+namespace crim {
+    class mapped_file;
+};
+
+/**
+ * @brief   Read-only view of an entire input file.
+ *
+ *          Regular files are `mmap`'d in one go, so reading a line is just
+ *          scanning for the next line ending. Nothing is copied: each line is
+ *          handed out as a `std::string_view` into the mapping.
+ *
+ *          Pipes, terminals and anything else `mmap` rejects get slurped with
+ *          buffered `read(2)` calls into one growable heap block instead.
+ *
+ * @note    Line views are only valid for as long as the `mapped_file` is.
+ *          Copy them into a `crim::cstring` or such if you need to keep them.
+ */
+class crim::mapped_file {
+public:
+    using size_type = std::size_t;
+    using view_type = std::string_view;
+
+private:
+    // Chunk size for the `read(2)` fallback. Doubles as the initial capacity.
+    static constexpr size_type READ_CHUNK_SIZE = 64 * 1024;
+
+    const char *m_pdata; // Start of the mapping or of the heap buffer.
+    size_type m_nsize; // Number of bytes of input we have.
+    size_type m_noffset; // Where `readline()` will start scanning from next.
+    bool m_bmapped; // true: `munmap` on close, false: `std::free` on close.
+    bool m_bopen; // Did the last call to `open()` succeed?
+
+public:
+    /* -*- CONSTRUCTORS, DESTRUCTORS -*- */
+
+    mapped_file() noexcept
+        : m_pdata{nullptr}
+        , m_nsize{0}
+        , m_noffset{0}
+        , m_bmapped{false}
+        , m_bopen{false}
+    {}
+
+    /**
+     * @brief   Opens and maps `p_path` right away. Like `std::ifstream`, check
+     *          `is_open()` afterwards to see if it worked. A path of `"-"` reads
+     *          from the standard input.
+     */
+    explicit mapped_file(const char *p_path)
+        : mapped_file()
+    {
+        open(p_path);
+    }
+
+    // Two owners of the same mapping would both try to unmap it.
+    mapped_file(const mapped_file &other) = delete;
+    mapped_file &operator=(const mapped_file &other) = delete;
+
+    mapped_file(mapped_file &&other) noexcept
+        : mapped_file()
+    {
+        swap(other);
+    }
+
+    mapped_file &operator=(mapped_file &&other) noexcept
+    {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+        close();
+    }
+
+    /* -*- OPENING AND CLOSING -*- */
+
+    /**
+     * @brief   Releases whatever we currently hold then loads `p_path`.
+     *
+     * @return  `false` if the file couldn't be opened or read, in which case
+     *          we're left empty.
+     */
+    bool open(const char *p_path)
+    {
+        close();
+#ifdef CRIM_MAPPED_FILE_USE_STDIO
+        std::FILE *p_stream = is_stdin(p_path) ? stdin : std::fopen(p_path, "rb");
+        if (p_stream == nullptr) {
+            crim_logerror("open", "std::fopen() failed!");
+            return false;
+        }
+        m_bopen = read_stream(p_stream);
+        if (p_stream != stdin) {
+            std::fclose(p_stream);
+        }
+#else
+        if (is_stdin(p_path)) {
+            return open(STDIN_FILENO);
+        }
+        int fd = ::open(p_path, O_RDONLY);
+        if (fd == -1) {
+            crim_logerror("open", "open(2) failed!");
+            return false;
+        }
+        open(fd);
+        ::close(fd);
+#endif
+        return m_bopen;
+    }
+
+#ifndef CRIM_MAPPED_FILE_USE_STDIO
+    /**
+     * @brief   Maps an already opened file descriptor. We don't take ownership
+     *          of `fd`: the mapping stays valid even after you close it.
+     */
+    bool open(int fd)
+    {
+        close();
+        struct stat info;
+        if (::fstat(fd, &info) == -1) {
+            crim_logerror("open", "fstat(2) failed!");
+            return false;
+        }
+        // Only regular files have a size we can trust up front.
+        if (S_ISREG(info.st_mode) && map_fd(fd, static_cast<size_type>(info.st_size))) {
+            m_bopen = true;
+        } else {
+            m_bopen = read_fd(fd);
+        }
+        return m_bopen;
+    }
+#endif
+
+    /**
+     * @brief   Unmaps or frees our data. Safe to call more than once.
+     */
+    void close() noexcept
+    {
+        if (m_pdata != nullptr) {
+#ifndef CRIM_MAPPED_FILE_USE_STDIO
+            if (m_bmapped) {
+                ::munmap(const_cast<char *>(m_pdata), m_nsize);
+            } else
+#endif
+            {
+                std::free(const_cast<char *>(m_pdata));
+            }
+        }
+        m_pdata = nullptr;
+        m_nsize = 0;
+        m_noffset = 0;
+        m_bmapped = false;
+        m_bopen = false;
+    }
+
+    void swap(mapped_file &other) noexcept
+    {
+        std::swap(m_pdata, other.m_pdata);
+        std::swap(m_nsize, other.m_nsize);
+        std::swap(m_noffset, other.m_noffset);
+        std::swap(m_bmapped, other.m_bmapped);
+        std::swap(m_bopen, other.m_bopen);
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    bool is_open() const noexcept
+    {
+        return m_bopen;
+    }
+
+    // Were we able to `mmap`, or did we have to fall back to reading?
+    bool is_mapped() const noexcept
+    {
+        return m_bmapped;
+    }
+
+    /**
+     * @brief   Start of the whole input. NOT nul terminated, so always pair it
+     *          with `size()`.
+     */
+    const char *data() const noexcept
+    {
+        return m_pdata;
+    }
+
+    size_type size() const noexcept
+    {
+        return m_nsize;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_nsize == 0;
+    }
+
+    // The entire input as one big view, for when you want to split it yourself.
+    view_type view() const noexcept
+    {
+        return view_type(m_pdata, m_nsize);
+    }
+
+    /* -*- LINE READING -*- */
+
+    /**
+     * @brief   Points `line` at the next line of input, sans its line ending.
+     *          Accounts for LF, CRLF and lone CR line endings just like
+     *          `crim::readline` does.
+     *
+     * @return  `false` once all lines have been read. A trailing line ending
+     *          does not produce an extra empty line.
+     */
+    bool readline(view_type &line) noexcept
+    {
+        if (eof()) {
+            return false;
+        }
+        const char *p_start = m_pdata + m_noffset;
+        const char *p_end = m_pdata + m_nsize;
+        const char *p_iter = p_start;
+        while (p_iter < p_end && *p_iter != '\n' && *p_iter != '\r') {
+            p_iter++;
+        }
+        line = view_type(p_start, static_cast<size_type>(p_iter - p_start));
+
+        // Consume the line ending too: 1 char for LF or lone CR, 2 for CRLF.
+        if (p_iter < p_end && *p_iter++ == '\r' && p_iter < p_end && *p_iter == '\n') {
+            p_iter++;
+        }
+        m_noffset = static_cast<size_type>(p_iter - m_pdata);
+        return true;
+    }
+
+    // Have all lines been handed out already? Like `std::feof`.
+    bool eof() const noexcept
+    {
+        return m_noffset >= m_nsize;
+    }
+
+    // Start handing out lines from the very beginning again.
+    void rewind() noexcept
+    {
+        m_noffset = 0;
+    }
+
+private:
+    static bool is_stdin(const char *p_path) noexcept
+    {
+        return p_path[0] == '-' && p_path[1] == '\0';
+    }
+
+    /**
+     * @brief   Adopts a heap buffer from one of the `read_*` functions.
+     *          We keep an empty input as a `nullptr` with a size of 0.
+     */
+    void adopt_buffer(char *p_buffer, size_type n_size) noexcept
+    {
+        if (n_size == 0) {
+            std::free(p_buffer);
+            p_buffer = nullptr;
+        }
+        m_pdata = p_buffer;
+        m_nsize = n_size;
+        m_bmapped = false;
+    }
+
+    /**
+     * @brief   Doubles `p_buffer` whenever it can't fit another read chunk.
+     *
+     * @return  The (possibly moved) buffer, or `nullptr` after freeing the old
+     *          one if `std::realloc` failed.
+     */
+    static char *grow_buffer(char *p_buffer, size_type n_size, size_type &n_capacity)
+    {
+        if (n_size + READ_CHUNK_SIZE <= n_capacity) {
+            return p_buffer;
+        }
+        n_capacity = (n_capacity == 0) ? READ_CHUNK_SIZE : n_capacity * 2;
+        void *p_memory = std::realloc(p_buffer, n_capacity);
+        if (p_memory == nullptr) {
+            crim_logerror("grow_buffer", "std::realloc() failed!");
+            std::free(p_buffer);
+        }
+        return static_cast<char *>(p_memory);
+    }
+
+#ifdef CRIM_MAPPED_FILE_USE_STDIO
+    bool read_stream(std::FILE *p_stream)
+    {
+        char *p_buffer = nullptr;
+        size_type n_size = 0;
+        size_type n_capacity = 0;
+        for (;;) {
+            if ((p_buffer = grow_buffer(p_buffer, n_size, n_capacity)) == nullptr) {
+                return false;
+            }
+            size_type n_read = std::fread(p_buffer + n_size, 1, READ_CHUNK_SIZE, p_stream);
+            n_size += n_read;
+            if (n_read < READ_CHUNK_SIZE) {
+                break;
+            }
+        }
+        if (std::ferror(p_stream)) {
+            crim_logerror("read_stream", "std::fread() failed!");
+            std::free(p_buffer);
+            return false;
+        }
+        adopt_buffer(p_buffer, n_size);
+        return true;
+    }
+#else
+    /**
+     * @brief   Maps `n_size` bytes of `fd` and tells the kernel we'll be
+     *          reading front to back so it can read ahead aggressively.
+     *
+     * @return  `false` if `mmap` refused, e.g. for special files in `/proc`,
+     *          so that the caller can fall back to `read_fd`.
+     */
+    bool map_fd(int fd, size_type n_size) noexcept
+    {
+        // `mmap` rejects a length of 0, but an empty file is still valid.
+        if (n_size == 0) {
+            return true;
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        void *p_memory = ::mmap(nullptr, n_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p_memory == MAP_FAILED) {
+            return false;
+        }
+#ifdef MADV_SEQUENTIAL
+        ::madvise(p_memory, n_size, MADV_SEQUENTIAL);
+#endif
+        m_pdata = static_cast<const char *>(p_memory);
+        m_nsize = n_size;
+        m_bmapped = true;
+        return true;
+    }
+
+    /**
+     * @brief   Fallback for pipes and friends: no size up front, so read big
+     *          chunks until `read(2)` reports end of file.
+     */
+    bool read_fd(int fd)
+    {
+        char *p_buffer = nullptr;
+        size_type n_size = 0;
+        size_type n_capacity = 0;
+        for (;;) {
+            if ((p_buffer = grow_buffer(p_buffer, n_size, n_capacity)) == nullptr) {
+                return false;
+            }
+            ssize_t n_read = ::read(fd, p_buffer + n_size, READ_CHUNK_SIZE);
+            if (n_read == 0) {
+                break;
+            } else if (n_read == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                crim_logerror("read_fd", "read(2) failed!");
+                std::free(p_buffer);
+                return false;
+            }
+            n_size += static_cast<size_type>(n_read);
+        }
+        adopt_buffer(p_buffer, n_size);
+        return true;
+    }
+#endif
+};
+
+#undef crim_logerror
@@ -1,11 +1,36 @@
 #pragma once
 
-#include <cstdlib> /* std::malloc, std::free */
+#include <cstddef> /* std::size_t, std::max_align_t */
+#include <cstdlib> /* std::malloc, std::realloc, std::free */
+#include <cstring> /* std::memcpy */
 #include <stdexcept> /* std::out_of_range */
 #include <memory> /* std::pointer_traits */
 #include <new> /* std::bad_array_new_length, std::bad_alloc */
+#include <type_traits> /* std::true_type, std::void_t */
+#include <utility> /* std::declval */
 
 #include "logerror.hpp"
+#include "type_traits.tcc"
+
+/**
+ * Define this before including us to have `crim::allocator` go through the
+ * per-thread size class caches instead of calling `std::malloc` every time.
+ */
+#if defined(CRIM_ALLOCATOR_USE_THREAD_CACHE)
+#include "thread_cache.hpp"
+#endif
+
+/**
+ * Define this before including us to have `crim::allocator` map requests of
+ * at least `CRIM_ALLOCATOR_MMAP_THRESHOLD` bytes straight from the kernel.
+ * Growing those is then a `mremap` instead of a copy.
+ */
+#if defined(CRIM_ALLOCATOR_USE_MMAP)
+#include "large_alloc.hpp"
+#ifndef CRIM_ALLOCATOR_MMAP_THRESHOLD
+#define CRIM_ALLOCATOR_MMAP_THRESHOLD (64 * 1024 * 1024)
+#endif
+#endif
 
 namespace crim {
     template<class T> 
@@ -16,6 +41,17 @@ namespace crim {
 
     template<class Alloc> 
     struct allocator_traits;
+
+    template<class Alloc, class = void>
+    struct has_reallocate;
+
+    template<class T, std::size_t BlockSize = 4096>
+    struct pool_allocator;
+};
+
+namespace crim::impl {
+    template<std::size_t BlockSize>
+    struct slab_pools;
 };
 
 /**
@@ -56,7 +92,9 @@ struct crim::allocator {
     // Converting copy-constructor.
     template<class OtherT> 
     allocator(const allocator<OtherT> &other) noexcept
-    {}
+    {
+        (void)other;
+    }
     
     static constexpr size_type max_size() noexcept 
     {
@@ -88,7 +126,7 @@ struct crim::allocator {
         }
         // Running out of memory IS an exceptional situation.
         //  - https://stackoverflow.com/a/4827445
-        void *p_memory{std::malloc(sizeof(T) * n_count)};
+        void *p_memory{raw_allocate(sizeof(T) * n_count)};
         if (p_memory == nullptr) {
             crim_logerror("allocate", "Failed to allocate memory!");
             throw std::bad_alloc();
@@ -104,13 +142,139 @@ struct crim::allocator {
     */
     void deallocate(T *p_memory, size_type n_count) const noexcept
     {
-        (void)n_count; // Signature needed by std::allocator, but we don't need.
-        std::free(p_memory);
+        raw_deallocate(p_memory, sizeof(T) * n_count);
     } 
+
+    /**
+     * @brief   Like `std::realloc`, grows or shrinks `p_memory` from `n_oldcount`
+     *          to `n_newcount` elements. The contents are kept, possibly at a
+     *          new address, as raw bytes.
+     *
+     *          Containers only call this for trivially relocatable types. See
+     *          `crim::is_trivially_relocatable` and `crim::has_reallocate`.
+     *
+     * @exception   `std::bad_array_new_length()`, `std::bad_alloc()`. If we
+     *              throw, `p_memory` is left untouched.
+     */
+    T *reallocate(T *p_memory, size_type n_oldcount, size_type n_newcount) const
+    {
+        if (p_memory == nullptr) {
+            return allocate(n_newcount);
+        } else if (n_newcount == 0) {
+            deallocate(p_memory, n_oldcount);
+            return nullptr;
+        } else if (!is_valid_size(n_newcount)) {
+            crim_logerror("reallocate", "Requested too much memory!");
+            throw std::bad_array_new_length();
+        }
+        // Cast silences GCC's `-Wclass-memaccess`, we know `T` is relocatable.
+        void *p_newmemory{raw_reallocate(
+            static_cast<void*>(p_memory), sizeof(T) * n_oldcount, sizeof(T) * n_newcount
+        )};
+        if (p_newmemory == nullptr) {
+            crim_logerror("reallocate", "Failed to reallocate memory!");
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p_newmemory);
+    }
+
+    /**
+     * @brief   We have no state, so memory from one instance can always be freed
+     *          by any other instance. Friends so `std` containers find them
+     *          through ADL.
+     */
+    template<class OtherT>
+    friend constexpr bool operator==(const allocator &, const allocator<OtherT> &) noexcept
+    {
+        return true;
+    }
+
+    template<class OtherT>
+    friend constexpr bool operator!=(const allocator &, const allocator<OtherT> &) noexcept
+    {
+        return false;
+    }
+
+private:
+    /**
+     * @brief   Picks the backend for `n_bytes`: the kernel for really big 
+     *          blocks, the thread caches, or just `std::malloc`. Sizes are all
+     *          we have to tell them apart, hence the `n_count` in `deallocate`.
+     */
+    static void *raw_allocate(std::size_t n_bytes)
+    {
+#if defined(CRIM_ALLOCATOR_USE_MMAP)
+        if (n_bytes >= CRIM_ALLOCATOR_MMAP_THRESHOLD) {
+            return large_alloc::allocate(n_bytes);
+        }
+#endif
+#if defined(CRIM_ALLOCATOR_USE_THREAD_CACHE)
+        return thread_cache::allocate(n_bytes);
+#else
+        return std::malloc(n_bytes);
+#endif
+    }
+
+    static void raw_deallocate(void *p_memory, std::size_t n_bytes) noexcept
+    {
+#if defined(CRIM_ALLOCATOR_USE_MMAP)
+        if (n_bytes >= CRIM_ALLOCATOR_MMAP_THRESHOLD) {
+            large_alloc::deallocate(p_memory, n_bytes);
+            return;
+        }
+#endif
+#if defined(CRIM_ALLOCATOR_USE_THREAD_CACHE)
+        // The cache has no headers, it needs the size to find the size class.
+        thread_cache::deallocate(p_memory, n_bytes);
+#else
+        (void)n_bytes; // Signature needed by std::allocator, but we don't need.
+        std::free(p_memory);
+#endif
+    }
+
+    static void *raw_reallocate(void *p_memory, std::size_t n_oldbytes, std::size_t n_newbytes)
+    {
+#if defined(CRIM_ALLOCATOR_USE_MMAP)
+        bool b_oldlarge = (n_oldbytes >= CRIM_ALLOCATOR_MMAP_THRESHOLD);
+        bool b_newlarge = (n_newbytes >= CRIM_ALLOCATOR_MMAP_THRESHOLD);
+        if (b_oldlarge && b_newlarge) {
+            return large_alloc::reallocate(p_memory, n_oldbytes, n_newbytes);
+        } else if (b_oldlarge || b_newlarge) {
+            // Crossing the threshold means switching backends, so copy once.
+            void *p_newmemory = raw_allocate(n_newbytes);
+            if (p_newmemory != nullptr) {
+                std::memcpy(p_newmemory, p_memory, (n_oldbytes < n_newbytes) ? n_oldbytes : n_newbytes);
+                raw_deallocate(p_memory, n_oldbytes);
+            }
+            return p_newmemory;
+        }
+#endif
+#if defined(CRIM_ALLOCATOR_USE_THREAD_CACHE)
+        return thread_cache::reallocate(p_memory, n_oldbytes, n_newbytes);
+#else
+        (void)n_oldbytes;
+        return std::realloc(p_memory, n_newbytes);
+#endif
+    }
 };
 
 #undef crim_logerror
 
+/**
+ * @brief   Whether `Alloc` has a `reallocate(pointer, old_count, new_count)`
+ *          method like `crim::allocator::reallocate`. It's not part of the
+ *          standard allocator interface, so containers have to check first.
+ */
+template<class Alloc, class>
+struct crim::has_reallocate : crim::false_type {};
+
+template<class Alloc>
+struct crim::has_reallocate<Alloc, std::void_t<decltype(
+    std::declval<Alloc &>().reallocate(
+        std::declval<typename Alloc::value_type *>(), std::size_t{}, std::size_t{}
+    )
+)>> : crim::true_type {};
+
 /**
  * @brief   See: https://en.cppreference.com/w/cpp/memory/allocator_traits
  * @tparam  Alloc   A template instantiation of an allocator, be it `std` or `crim`.
@@ -146,10 +310,9 @@ template<class Alloc> struct crim::allocator_traits {
         return allocator.allocate(n_count);
     }
     
-    static void deallocate(allocator_type &allocator, size_type n_count)
+    static void deallocate(allocator_type &allocator, pointer p_memory, size_type n_count)
     {
-        (void)n_count;
-        allocator.deallocate();
+        allocator.deallocate(p_memory, n_count);
     }
     
     /** 
@@ -174,3 +337,314 @@ template<class Alloc> struct crim::allocator_traits {
         p_memory->~T(); // For fundamentals types this is just a no-op.
     }
 };
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::pool_allocator<T>", func, info)
+
+/**
+ * BEGIN: POOL ALLOCATOR IMPLEMENTATION -*--------------------------------------
+ */
+
+/**
+ * @brief   Every pool that one `crim::pool_allocator` and all of its copies
+ *          and rebinds share, one per slot size and alignment. Doesn't know
+ *          about `T` at all, so a `pool_allocator<node>` that `std::list`
+ *          rebinds from a `pool_allocator<int>` still lands in the same group
+ *          and the 2 compare equal.
+ *
+ * @note    There are only ever a handful of slot sizes, so finding one is a
+ *          walk down a list. Allocators do that once, when they're made.
+ */
+template<std::size_t BlockSize>
+struct crim::impl::slab_pools {
+    // Free slots store the pointer to the next free slot in their own memory.
+    struct free_slot {
+        free_slot *next;
+    };
+
+    // Header at the start of every slab. The slots come right after it.
+    struct slab {
+        slab *next;
+    };
+
+    struct pool {
+        pool *next; // Next pool in the group.
+        std::size_t slot_size;
+        std::size_t slot_align;
+        free_slot *free_list; // Slots that were given back to us.
+        char *cursor; // Next never-used slot in the newest slab.
+        char *limit; // 1 past the last slot of the newest slab.
+        slab *slabs; // Every slab we own, newest first.
+    };
+
+    pool *pools;
+    std::size_t refcount; // How many allocators point to us, of any type.
+
+    static slab_pools *create()
+    {
+        void *p_memory = std::malloc(sizeof(slab_pools));
+        if (p_memory == nullptr) {
+            crim_logerror("pool_allocator", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        return ::new (p_memory) slab_pools{nullptr, 1};
+    }
+
+    // The pool for slots like these, made on first use.
+    pool &find(std::size_t n_size, std::size_t n_align)
+    {
+        for (pool *p_pool = pools; p_pool != nullptr; p_pool = p_pool->next) {
+            if (p_pool->slot_size == n_size && p_pool->slot_align == n_align) {
+                return *p_pool;
+            }
+        }
+        pool *p_pool = static_cast<pool *>(std::malloc(sizeof(pool)));
+        if (p_pool == nullptr) {
+            crim_logerror("pool_allocator", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        *p_pool = pool{pools, n_size, n_align, nullptr, nullptr, nullptr, nullptr};
+        pools = p_pool;
+        return *p_pool;
+    }
+
+    /**
+     * @brief   Slots of a new slab aren't linked into the free list up front,
+     *          we just bump `cursor` through them as needed.
+     */
+    static void next_slab(pool &state)
+    {
+        slab *p_slab = static_cast<slab *>(std::malloc(BlockSize));
+        if (p_slab == nullptr) {
+            crim_logerror("allocate", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        p_slab->next = state.slabs;
+        state.slabs = p_slab;
+        std::size_t n_offset = (sizeof(slab) + state.slot_align - 1) / state.slot_align * state.slot_align;
+        state.cursor = reinterpret_cast<char *>(p_slab) + n_offset;
+        state.limit = state.cursor + (BlockSize - n_offset) / state.slot_size * state.slot_size;
+    }
+
+    /**
+     * @brief   The last allocator to go frees every slab of every pool, and
+     *          then the group itself.
+     *
+     * @note    Kept out of line, otherwise GCC 12+ sees through the refcount of
+     *          2 copies dying back to back and warns about a use after free.
+     */
+    [[gnu::noinline]] static void release(slab_pools *p_group) noexcept
+    {
+        if (--p_group->refcount != 0) {
+            return;
+        }
+        while (p_group->pools != nullptr) {
+            pool *p_pool = p_group->pools;
+            while (p_pool->slabs != nullptr) {
+                slab *p_next = p_pool->slabs->next;
+                std::free(p_pool->slabs);
+                p_pool->slabs = p_next;
+            }
+            p_group->pools = p_pool->next;
+            std::free(p_pool);
+        }
+        std::free(p_group);
+    }
+};
+
+/**
+ * @brief   Hands out memory for exactly 1 `T` at a time, carved out of bigger
+ *          slabs. Freed slots go onto a free list that's threaded through the
+ *          slots themselves, so allocating and freeing are just pointer swaps.
+ *          Good for node-heavy stuff like linked lists, trees and graph nodes.
+ *
+ *          Requests for more than 1 element (e.g. the buffer of a `dyarray`)
+ *          don't fit in a slot, so those go straight to `crim::allocator`.
+ *
+ *          Copies and rebinds all share the same `crim::impl::slab_pools`,
+ *          which is freed when the last of them dies. Rebinds with the same
+ *          slot size even share slabs, and all of them compare equal, so
+ *          `A(B(a)) == a` like the standard wants.
+ *
+ * @tparam  BlockSize   Size in bytes of each slab, including its header.
+ *
+ * @warning Not thread-safe! Also slabs are never given back to the system
+ *          until the very last copy of the allocator is destroyed.
+ */
+template<class T, std::size_t BlockSize>
+struct crim::pool_allocator {
+private:
+    // What a slot has to fit: a `T` while in use, a link while free.
+    union slot {
+        void *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    using group = impl::slab_pools<BlockSize>;
+    using pool = typename group::pool;
+
+    static constexpr std::size_t slot_offset
+        = (sizeof(typename group::slab) + alignof(slot) - 1) / alignof(slot) * alignof(slot);
+
+    static_assert(alignof(slot) <= alignof(std::max_align_t), 
+        "std::malloc can't align slabs for this type!");
+    static_assert(BlockSize >= slot_offset + sizeof(slot), 
+        "BlockSize is too small to fit even 1 slot!");
+
+    group *m_pgroup; // Never `nullptr`, even for default constructed instances.
+    pool *m_ppool; // Our slot size's pool in `m_pgroup`, so we only look once.
+
+    template<class OtherT, std::size_t OtherBlockSize>
+    friend struct pool_allocator;
+
+    // Our friends can't see `other`'s privates, but we can.
+    template<class OtherT>
+    bool shares_group(const pool_allocator<OtherT, BlockSize> &other) const noexcept
+    {
+        return m_pgroup == other.m_pgroup;
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    // Memory can only be freed by the pool that handed it out.
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    // `std::allocator_traits` can't rebind us by itself due to `BlockSize`.
+    template<class OtherT>
+    struct rebind {
+        using other = pool_allocator<OtherT, BlockSize>;
+    };
+
+    static constexpr size_type slots_per_slab = (BlockSize - slot_offset) / sizeof(slot);
+
+    /* -*- CONSTRUCTORS, DESTRUCTORS -*- */
+
+    /**
+     * @exception   `std::bad_alloc` if we couldn't even allocate the pool.
+     */
+    pool_allocator()
+        : m_pgroup{group::create()}
+        , m_ppool{nullptr}
+    {
+        try {
+            m_ppool = &m_pgroup->find(sizeof(slot), alignof(slot));
+        } catch (...) {
+            group::release(m_pgroup);
+            throw;
+        }
+    }
+
+    pool_allocator(const pool_allocator &other) noexcept
+        : m_pgroup{other.m_pgroup}
+        , m_ppool{other.m_ppool}
+    {
+        m_pgroup->refcount++;
+    }
+
+    /**
+     * @brief   Converting copy-constructor, e.g. for `std::allocator_traits::rebind`.
+     *          Joins `other`'s group, so memory from either can go back to
+     *          either once rebound to the same type.
+     *
+     * @exception   `std::bad_alloc` if this slot size is new to the group and
+     *              we couldn't allocate its pool.
+     */
+    template<class OtherT>
+    pool_allocator(const pool_allocator<OtherT, BlockSize> &other)
+        : m_pgroup{other.m_pgroup}
+        , m_ppool{&other.m_pgroup->find(sizeof(slot), alignof(slot))}
+    {
+        m_pgroup->refcount++;
+    }
+
+    pool_allocator &operator=(const pool_allocator &other) noexcept
+    {
+        // Increment first in case of self-assignment.
+        other.m_pgroup->refcount++;
+        group::release(m_pgroup);
+        m_pgroup = other.m_pgroup;
+        m_ppool = other.m_ppool;
+        return *this;
+    }
+
+    ~pool_allocator()
+    {
+        group::release(m_pgroup);
+    }
+
+    static constexpr size_type max_size() noexcept
+    {
+        return allocator<T>::max_size();
+    }
+
+    /* -*- ALLOCATION -*- */
+
+    /**
+     * @brief   Single elements come from the free list, or else the newest
+     *          slab. Anything else is passed on to `crim::allocator`.
+     *
+     * @exception   `std::bad_array_new_length()`, `std::bad_alloc()`.
+     */
+    T *allocate(size_type n_count)
+    {
+        if (n_count != 1) {
+            return allocator<T>().allocate(n_count);
+        }
+        pool &state = *m_ppool;
+        typename group::free_slot *p_slot = state.free_list;
+        if (p_slot != nullptr) {
+            state.free_list = p_slot->next;
+            return reinterpret_cast<T *>(p_slot);
+        }
+        if (state.cursor == state.limit) {
+            group::next_slab(state);
+        }
+        char *p_memory = state.cursor;
+        state.cursor += sizeof(slot);
+        return reinterpret_cast<T *>(p_memory);
+    }
+
+    /**
+     * @brief   Pushes the slot onto the free list, the slab itself stays.
+     */
+    void deallocate(T *p_memory, size_type n_count) noexcept
+    {
+        if (n_count != 1) {
+            allocator<T>().deallocate(p_memory, n_count);
+            return;
+        }
+        auto *p_slot = reinterpret_cast<typename group::free_slot *>(p_memory);
+        p_slot->next = m_ppool->free_list;
+        m_ppool->free_list = p_slot;
+    }
+
+    /* -*- COMPARISON -*- */
+
+    // Copies and rebinds of the same allocator share a group, and only they
+    // are equal. Friends so `std` containers find them through ADL.
+    template<class OtherT>
+    friend bool operator==(const pool_allocator &lhs, const pool_allocator<OtherT, BlockSize> &rhs) noexcept
+    {
+        return lhs.shares_group(rhs);
+    }
+
+    template<class OtherT>
+    friend bool operator!=(const pool_allocator &lhs, const pool_allocator<OtherT, BlockSize> &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+};
+
+// Copies only point at the shared pool, never at themselves.
+template<class T, std::size_t BlockSize>
+struct crim::is_trivially_relocatable<crim::pool_allocator<T, BlockSize>> : crim::true_type {};
+
+/**
+ * END: POOL ALLOCATOR IMPLEMENTATION -*----------------------------------------
+ */
+
+#undef crim_logerror
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uint16_t, std::uint32_t */
+#include <initializer_list> /* std::initializer_list */
+#include <string_view> /* std::string_view */
+
+#include "dyarray.tcc"
+
+namespace crim {
+    class multi_matcher;
+};
+
+/**
+ * @brief   Aho-Corasick automaton: finds every occurence of every keyword in
+ *          one pass over the text, overlapping ones included. So `"twone"`
+ *          gives you both `"two"` and `"one"`.
+ *
+ *          Build it once from your keywords, then either `scan()` a whole
+ *          buffer or feed it one byte at a time with `step()`.
+ *
+ * @note    The failure links are baked into a full transition table, so each
+ *          byte is exactly one lookup. To keep that table small, only bytes
+ *          that appear in some keyword get a column of their own. All the
+ *          others share column 0, which always leads back to `start`.
+ *
+ * @warning Empty keywords are ignored. For duplicates only the first counts.
+ */
+class crim::multi_matcher {
+public:
+    using size_type = std::size_t;
+    using state_type = std::uint32_t;
+    using view_type = std::string_view;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    // Where we begin, and where any byte not in a keyword sends us.
+    static constexpr state_type start = 0;
+
+private:
+    std::uint16_t m_columns[256]; // Which column of `m_table` each byte uses.
+    size_type m_ncolumns;
+    dyarray<state_type> m_table; // `m_ncolumns` transitions per state.
+    dyarray<size_type> m_output; // Keyword that ends at each state, or `npos`.
+    dyarray<state_type> m_next; // Next state down the failure links with an output.
+    dyarray<size_type> m_lengths; // Length of each keyword.
+
+public:
+    multi_matcher(std::initializer_list<view_type> keywords) : m_ncolumns{1} {
+        build(keywords.begin(), keywords.size());
+    }
+
+    multi_matcher(const view_type *p_keywords, size_type n_count) : m_ncolumns{1} {
+        build(p_keywords, n_count);
+    }
+
+    multi_matcher(const char *const *p_keywords, size_type n_count) : m_ncolumns{1} {
+        dyarray<view_type> keywords;
+        for (size_type i = 0; i < n_count; i++) {
+            keywords.push_back(view_type(p_keywords[i]));
+        }
+        build(keywords.data(), n_count);
+    }
+
+    /* -*- STREAMING METHODS -*- */
+
+    // Where we end up after reading `ch` while in `state`.
+    state_type step(state_type state, char ch) const {
+        size_type n_column = m_columns[static_cast<unsigned char>(ch)];
+        return m_table.data()[state * m_ncolumns + n_column];
+    }
+
+    // Whether at least one keyword ends at `state`.
+    bool matched(state_type state) const {
+        return m_output.data()[state] != npos || m_next.data()[state] != start;
+    }
+
+    /**
+     * @brief   Calls `on_match(keyword)` for every keyword that ends at `state`,
+     *          longest first. `keyword` is its index in the constructor's list.
+     */
+    template<class Callback>
+    void for_each_match(state_type state, Callback on_match) const {
+        if (m_output.data()[state] == npos) {
+            state = m_next.data()[state];
+        }
+        while (state != start) {
+            on_match(m_output.data()[state]);
+            state = m_next.data()[state];
+        }
+    }
+
+    /* -*- WHOLE BUFFER METHODS -*- */
+
+    /**
+     * @brief   Calls `on_match(keyword, offset)` for every match in `text`, in
+     *          the order they end. `offset` is where the match starts.
+     *
+     * @return  The state we ended in. Pass it back in as `state` to carry on
+     *          with the next chunk, matches across the boundary included.
+     *          Those get a "negative" offset, i.e. one that wrapped around.
+     */
+    template<class Callback>
+    state_type scan(view_type text, Callback on_match, state_type state = start) const {
+        const char *p_data = text.data();
+        for (size_type i = 0; i < text.size(); i++) {
+            state = step(state, p_data[i]);
+            if (matched(state)) {
+                for_each_match(state, [&](size_type n_keyword) {
+                    on_match(n_keyword, i + 1 - m_lengths.data()[n_keyword]);
+                });
+            }
+        }
+        return state;
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    // How many keywords we were built from, ignored ones included.
+    size_type size() const {
+        return m_lengths.length();
+    }
+
+    size_type keyword_length(size_type n_keyword) const {
+        return m_lengths.data()[n_keyword];
+    }
+
+    // Number of states in the automaton, i.e. trie nodes plus the root.
+    size_type states() const {
+        return m_output.length();
+    }
+
+private:
+    // Appends a fresh state with no transitions or outputs, returns its index.
+    state_type add_state() {
+        for (size_type i = 0; i < m_ncolumns; i++) {
+            m_table.push_back(start);
+        }
+        m_output.push_back(npos);
+        m_next.push_back(start);
+        return static_cast<state_type>(m_output.length() - 1);
+    }
+
+    state_type &transition(state_type state, size_type n_column) {
+        return m_table.data()[state * m_ncolumns + n_column];
+    }
+
+    void build(const view_type *p_keywords, size_type n_count) {
+        // Give each byte used by any keyword its own column.
+        for (size_type i = 0; i < 256; i++) {
+            m_columns[i] = 0;
+        }
+        for (size_type i = 0; i < n_count; i++) {
+            for (char ch : p_keywords[i]) {
+                std::uint16_t &n_column = m_columns[static_cast<unsigned char>(ch)];
+                if (n_column == 0) {
+                    n_column = static_cast<std::uint16_t>(m_ncolumns++);
+                }
+            }
+        }
+
+        // Plain trie first. Nothing ever goes back to `start`, so until
+        // we fill in the failure transitions that means "no child".
+        add_state();
+        for (size_type i = 0; i < n_count; i++) {
+            view_type keyword = p_keywords[i];
+            m_lengths.push_back(keyword.size());
+            if (keyword.empty()) {
+                continue;
+            }
+            state_type state = start;
+            for (char ch : keyword) {
+                size_type n_column = m_columns[static_cast<unsigned char>(ch)];
+                if (transition(state, n_column) == start) {
+                    state_type n_child = add_state();
+                    transition(state, n_column) = n_child;
+                }
+                state = transition(state, n_column);
+            }
+            if (m_output.data()[state] == npos) {
+                m_output.data()[state] = i;
+            }
+        }
+
+        // Breadth first, so a state's failure state is always done before it.
+        // Our own failure links are only needed while building.
+        dyarray<state_type> fail;
+        dyarray<state_type> queue;
+        for (size_type i = 0; i < states(); i++) {
+            fail.push_back(start);
+        }
+        queue.push_back(start);
+        for (size_type n_head = 0; n_head < queue.length(); n_head++) {
+            state_type state = queue.data()[n_head];
+            for (size_type n_column = 0; n_column < m_ncolumns; n_column++) {
+                state_type n_child = transition(state, n_column);
+                state_type n_fallback = (state == start) ? start : transition(fail.data()[state], n_column);
+                if (n_child == start) {
+                    transition(state, n_column) = n_fallback;
+                    continue;
+                }
+                // Column 0 is never in a keyword, so it never has children.
+                fail.data()[n_child] = n_fallback;
+                m_next.data()[n_child] = (m_output.data()[n_fallback] != npos)
+                    ? n_fallback
+                    : m_next.data()[n_fallback];
+                queue.push_back(n_child);
+            }
+        }
+    }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fwrite, std::fflush */
+#include <cstring> /* std::memcpy */
+#include <memory> /* std::unique_ptr */
+#include <string_view> /* std::string_view */
+#include <type_traits> /* std::is_integral_v, std::is_signed_v, std::make_unsigned_t */
+
+/**
+ * Windows has no `write(2)`, so there we go through the `stdout` and `stderr`
+ * streams instead. You can also define this yourself to test that on POSIX.
+ */
+#if defined(_WIN32) && !defined(CRIM_OUT_BUFFER_USE_STDIO)
+#define CRIM_OUT_BUFFER_USE_STDIO
+#endif
+
+#ifndef CRIM_OUT_BUFFER_USE_STDIO
+#include <cerrno> /* errno, EINTR */
+#include <unistd.h> /* write */
+#endif
+
+#include "utility.tcc"
+
+namespace crim {
+    class out_buffer;
+};
+
+/**
+ * @brief   Output that piles up in one big buffer and goes out with a single
+ *          `write(2)` when it's full, when you `flush()`, or when we're
+ *          destroyed. For solvers that echo every line of a big input, where
+ *          `printf` spends its time formatting and locking `stdout`.
+ *
+ *          Integers are formatted 2 digits at a time from a table, after
+ *          working out their length with `crim::count_digits10`, so each one
+ *          goes straight into place without a temporary.
+ *
+ * @warning We bypass `stdout`, so anything `printf`'d to the same file
+ *          descriptor can come out in the wrong order. Use one or the other,
+ *          or `std::fflush(stdout)` and `flush()` when switching.
+ */
+class crim::out_buffer {
+public:
+    using size_type = std::size_t;
+    using view_type = std::string_view;
+
+    // Big enough that a whole solver's output is usually one `write`.
+    static constexpr size_type DEFAULT_CAPACITY = 1024 * 1024;
+
+private:
+    std::unique_ptr<char[]> m_pbuffer;
+    size_type m_nlength;
+    size_type m_ncapacity;
+    int m_nfd;
+    bool m_bfailed; // A flush went wrong, so everything after is dropped.
+
+public:
+    /**
+     * @brief   Writes to file descriptor `n_fd`, 1 being `stdout` and 2 being
+     *          `stderr`. Allocates `n_capacity` bytes once, up front.
+     */
+    explicit out_buffer(int n_fd = 1, size_type n_capacity = DEFAULT_CAPACITY)
+        : m_pbuffer{new char[(n_capacity < 64) ? 64 : n_capacity]}
+        , m_nlength{0}
+        , m_ncapacity{(n_capacity < 64) ? 64 : n_capacity}
+        , m_nfd{n_fd}
+        , m_bfailed{false}
+    {}
+
+    out_buffer(const out_buffer &other) = delete;
+    out_buffer &operator=(const out_buffer &other) = delete;
+
+    ~out_buffer() {
+        flush();
+    }
+
+    /* -*- WRITING -*- */
+
+    out_buffer &put(char ch) {
+        if (m_nlength == m_ncapacity) {
+            flush();
+        }
+        m_pbuffer[m_nlength++] = ch;
+        return *this;
+    }
+
+    // Anything bigger than the whole buffer skips it and goes straight out.
+    out_buffer &write(view_type text) {
+        if (text.size() > m_ncapacity - m_nlength) {
+            flush();
+            if (text.size() > m_ncapacity) {
+                write_all(text.data(), text.size());
+                return *this;
+            }
+        }
+        std::memcpy(m_pbuffer.get() + m_nlength, text.data(), text.size());
+        m_nlength += text.size();
+        return *this;
+    }
+
+    /**
+     * @brief   Any integer type, in base 10, with a `'-'` if it's negative.
+     *          Same text as `printf("%i")` and friends would give.
+     */
+    template<class IntT>
+    out_buffer &write_int(IntT value) {
+        static_assert(std::is_integral_v<IntT>, "crim::out_buffer::write_int: need an integer");
+        using UIntT = std::make_unsigned_t<IntT>;
+        UIntT n_unsigned = static_cast<UIntT>(value);
+        if constexpr (std::is_signed_v<IntT>) {
+            if (value < 0) {
+                put('-');
+                // Unsigned negation, so `INT_MIN` and friends come out fine.
+                n_unsigned = UIntT(0) - n_unsigned;
+            }
+        }
+        // 20 digits is as long as `unsigned long long` gets.
+        if (m_ncapacity - m_nlength < 20) {
+            flush();
+        }
+        m_nlength += format_uint(m_pbuffer.get() + m_nlength, n_unsigned);
+        return *this;
+    }
+
+    /**
+     * @brief   Everything so far goes out now, however many `write` calls that
+     *          takes. We keep the buffer for whatever comes next.
+     *
+     * @return  `false` if this or an earlier flush couldn't write everything.
+     */
+    bool flush() {
+        if (m_nlength > 0) {
+            write_all(m_pbuffer.get(), m_nlength);
+            m_nlength = 0;
+        }
+        return !m_bfailed;
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    size_type length() const {
+        return m_nlength;
+    }
+
+    size_type capacity() const {
+        return m_ncapacity;
+    }
+
+    /**
+     * @brief   Writes `n_value` in base 10 to `p_dest`, which must have room
+     *          for `crim::count_digits10(n_value)` characters. No nul.
+     *
+     * @return  How many characters were written.
+     *
+     * @note    Fills in from the back since that's where the lowest digits go,
+     *          2 at a time from `"00010203...99"`, so half as many divisions.
+     */
+    static size_type format_uint(char *p_dest, unsigned long long n_value) noexcept {
+        static constexpr char DIGIT_PAIRS[] =
+            "00010203040506070809" "10111213141516171819" "20212223242526272829"
+            "30313233343536373839" "40414243444546474849" "50515253545556575859"
+            "60616263646566676869" "70717273747576777879" "80818283848586878889"
+            "90919293949596979899";
+        size_type n_digits = count_digits10(n_value);
+        char *p_iter = p_dest + n_digits;
+        while (n_value >= 100) {
+            size_type n_pair = static_cast<size_type>(n_value % 100) * 2;
+            n_value /= 100;
+            p_iter -= 2;
+            std::memcpy(p_iter, DIGIT_PAIRS + n_pair, 2);
+        }
+        if (n_value >= 10) {
+            p_iter -= 2;
+            std::memcpy(p_iter, DIGIT_PAIRS + n_value * 2, 2);
+        } else {
+            *--p_iter = static_cast<char>('0' + n_value);
+        }
+        return n_digits;
+    }
+
+private:
+    void write_all(const char *p_data, size_type n_length) {
+        if (m_bfailed) {
+            return;
+        }
+#ifdef CRIM_OUT_BUFFER_USE_STDIO
+        std::FILE *p_stream = (m_nfd == 2) ? stderr : stdout;
+        if (std::fwrite(p_data, 1, n_length, p_stream) != n_length || std::fflush(p_stream) != 0) {
+            m_bfailed = true;
+        }
+#else
+        // Pipes and terminals may take less than we asked, so keep going.
+        while (n_length > 0) {
+            ssize_t n_written = ::write(m_nfd, p_data, n_length);
+            if (n_written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                m_bfailed = true;
+                return;
+            }
+            p_data += n_written;
+            n_length -= static_cast<size_type>(n_written);
+        }
+#endif
+    }
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <atomic> /* std::atomic */
+#include <chrono> /* std::chrono::steady_clock */
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fprintf */
+#include <cstring> /* std::memchr */
+#include <functional> /* std::plus */
+#include <optional> /* std::optional */
+#include <string_view> /* std::string_view */
+#include <thread> /* std::thread */
+#include <utility> /* std::move */
+#include <vector> /* std::vector */
+
+#include "dyarray.tcc"
+#include "trace.hpp"
+
+namespace crim {
+    struct thread_stats;
+    class parallel_lines;
+};
+
+/**
+ * @brief   What one worker of `crim::parallel_lines` got through.
+ */
+struct crim::thread_stats {
+    std::size_t chunks = 0;
+    std::size_t lines = 0;
+    std::size_t bytes = 0;
+    double seconds = 0.0; // From starting up to running out of chunks.
+};
+
+/**
+ * @brief   Map-reduce over the lines of one big buffer, e.g. the contents of a
+ *          `crim::mapped_file`, on as many threads as you like.
+ *
+ *          The buffer is cut into chunks of about `chunk_size()` bytes, always
+ *          right after a line ending, so no line is ever split. Workers grab the
+ *          next chunk off a shared counter until there are none left, which
+ *          keeps them all busy even if some lines are slower than others.
+ *
+ *          Each chunk gets its own partial result, and those are combined in
+ *          file order at the end. So you get the exact same answer no matter
+ *          the thread count, even if `combine` isn't commutative. It does have
+ *          to be associative for that answer to match a plain serial loop.
+ *
+ * @note    Lines end at LF, CRLF or a lone CR, exactly like
+ *          `crim::mapped_file::readline`, so serial code reading lines that
+ *          way gets the same lines.
+ *
+ * @warning Kernels run on other threads, so they must not throw and must not
+ *          touch shared state without their own locking.
+ */
+class crim::parallel_lines {
+public:
+    using size_type = std::size_t;
+    using view_type = std::string_view;
+
+    // Fits in L2 on anything recent, and still gives thousands of chunks per GB.
+    static constexpr size_type DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+private:
+    view_type m_text;
+    size_type m_nthreads;
+    size_type m_nchunksize;
+    dyarray<size_type> m_offsets; // Where each chunk starts, plus the end.
+    dyarray<thread_stats> m_stats; // One per thread, from the last run.
+
+public:
+    /**
+     * @brief   Splits `text` up front. With `n_threads` of 0 we use every core
+     *          `std::thread::hardware_concurrency()` knows about.
+     */
+    explicit parallel_lines(view_type text, size_type n_threads = 0, size_type n_chunksize = DEFAULT_CHUNK_SIZE)
+        : m_text{text}
+        , m_nthreads{n_threads}
+        , m_nchunksize{(n_chunksize == 0) ? DEFAULT_CHUNK_SIZE : n_chunksize}
+    {
+        if (m_nthreads == 0) {
+            m_nthreads = std::thread::hardware_concurrency();
+        }
+        m_nthreads = (m_nthreads == 0) ? 1 : m_nthreads;
+        split();
+    }
+
+    /**
+     * @brief   Calls `on_line(line)` for every line and folds the results with
+     *          `combine(acc, value)`, one partial per chunk starting from its
+     *          first line. Then folds the chunks together, in order, starting
+     *          from `init`. `combine` defaults to `+`.
+     *
+     * @note    `init` is only folded in once, like a serial loop would, so it
+     *          doesn't have to be the identity of `combine`.
+     */
+    template<class ResultT, class LineFn, class CombineFn = std::plus<>>
+    ResultT map_reduce(ResultT init, LineFn on_line, CombineFn combine = CombineFn{}) {
+        size_type n_chunks = chunks();
+        size_type n_workers = (m_nthreads < n_chunks) ? m_nthreads : n_chunks;
+        n_workers = (n_workers == 0) ? 1 : n_workers;
+        // Only written once per chunk, so neighbours on other workers don't
+        // keep stealing each other's cache lines. Chunks without any lines
+        // have nothing to fold in. Not `std::vector`, where `bool` partials
+        // would share bytes between threads.
+        dyarray<ResultT> partials;
+        dyarray<unsigned char> has_partial;
+        for (size_type i = 0; i < n_chunks; i++) {
+            partials.push_back(init);
+            has_partial.push_back(0);
+        }
+        std::atomic<size_type> next_chunk{0};
+
+        m_stats = dyarray<thread_stats>();
+        for (size_type i = 0; i < n_workers; i++) {
+            m_stats.push_back(thread_stats{});
+        }
+        auto worker = [&](size_type n_worker) {
+            // Same goes for the stats, which only go in `m_stats` at the end.
+            thread_stats stats;
+            if (n_worker != 0) {
+                crim_trace_thread_name("crim::parallel_lines worker");
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (;;) {
+                size_type n_chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (n_chunk >= n_chunks) {
+                    break;
+                }
+                crim_trace_scope("chunk");
+                view_type chunk = this->chunk(n_chunk);
+                std::optional<ResultT> acc;
+                stats.lines += for_each_line(chunk, [&](view_type line) {
+                    if (acc) {
+                        *acc = combine(*acc, on_line(line));
+                    } else {
+                        acc.emplace(on_line(line));
+                    }
+                });
+                if (acc) {
+                    partials.data()[n_chunk] = std::move(*acc);
+                    has_partial.data()[n_chunk] = 1;
+                }
+                stats.bytes += chunk.size();
+                stats.chunks++;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            stats.seconds = elapsed.count();
+            m_stats.data()[n_worker] = stats;
+        };
+
+        // The calling thread is worker 0, so 1 thread means no threads at all.
+        std::vector<std::thread> threads;
+        for (size_type i = 1; i < n_workers; i++) {
+            threads.emplace_back(worker, i);
+        }
+        worker(0);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        ResultT total = init;
+        for (size_type i = 0; i < n_chunks; i++) {
+            if (has_partial.data()[i]) {
+                total = combine(total, partials.data()[i]);
+            }
+        }
+        return total;
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    size_type threads() const {
+        return m_nthreads;
+    }
+
+    size_type chunk_size() const {
+        return m_nchunksize;
+    }
+
+    size_type chunks() const {
+        return m_offsets.length() - 1;
+    }
+
+    // The `n_chunk`'th chunk, line endings included. No bounds checking.
+    view_type chunk(size_type n_chunk) const {
+        const size_type *p_offsets = m_offsets.data();
+        return m_text.substr(p_offsets[n_chunk], p_offsets[n_chunk + 1] - p_offsets[n_chunk]);
+    }
+
+    // Per-thread numbers from the last `map_reduce`, one entry per worker.
+    const dyarray<thread_stats> &stats() const {
+        return m_stats;
+    }
+
+    /**
+     * @brief   One line per worker with its share of the work and throughput,
+     *          then the totals. Throughput is per second spent working.
+     */
+    void print_stats(std::FILE *stream) const {
+        thread_stats total;
+        double n_slowest = 0.0;
+        for (size_type i = 0; i < m_stats.length(); i++) {
+            const thread_stats &stats = m_stats.data()[i];
+            std::fprintf(stream, "thread %3zu: %6zu chunks %10zu lines %8.1f MB %8.3f s %8.1f MB/s\n",
+                i, stats.chunks, stats.lines, stats.bytes / (1024.0 * 1024.0), stats.seconds,
+                throughput(stats.bytes, stats.seconds));
+            total.chunks += stats.chunks;
+            total.lines += stats.lines;
+            total.bytes += stats.bytes;
+            n_slowest = (stats.seconds > n_slowest) ? stats.seconds : n_slowest;
+        }
+        std::fprintf(stream, "total     : %6zu chunks %10zu lines %8.1f MB %8.3f s %8.1f MB/s\n",
+            total.chunks, total.lines, total.bytes / (1024.0 * 1024.0), n_slowest,
+            throughput(total.bytes, n_slowest));
+    }
+
+    /**
+     * @brief   Calls `on_line(line)` for every line in `text`, with line
+     *          endings stripped. Also usable on its own for serial code.
+     *
+     * @return  How many lines there were.
+     */
+    template<class Callback>
+    static size_type for_each_line(view_type text, Callback on_line) {
+        const char *p_iter = text.data();
+        const char *p_end = p_iter + text.size();
+        // Next `'\n'`, only looked for again once we're past it. No line runs
+        // past it, so a `'\r'` is only ever looked for up to there.
+        const char *p_newline = find(p_iter, p_end, '\n');
+        size_type n_lines = 0;
+        while (p_iter < p_end) {
+            if (p_newline < p_iter) {
+                p_newline = find(p_iter, p_end, '\n');
+            }
+            const char *p_stop = find(p_iter, p_newline, '\r');
+            on_line(view_type(p_iter, static_cast<size_type>(p_stop - p_iter)));
+            n_lines++;
+            // Consume the line ending too: 1 char for LF or lone CR, 2 for CRLF.
+            p_iter = (p_stop + 1 == p_newline) ? p_newline + 1 : p_stop + 1;
+        }
+        return n_lines;
+    }
+
+private:
+    static double throughput(size_type n_bytes, double n_seconds) {
+        return (n_seconds > 0.0) ? (n_bytes / (1024.0 * 1024.0)) / n_seconds : 0.0;
+    }
+
+    // First `c` in `[p_iter, p_end)`, or `p_end` if there's none.
+    static const char *find(const char *p_iter, const char *p_end, char c) {
+        const void *p_found = std::memchr(p_iter, c, static_cast<size_type>(p_end - p_iter));
+        return (p_found == nullptr) ? p_end : static_cast<const char *>(p_found);
+    }
+
+    // Chunk boundaries go right after the first line ending at or past each
+    // target, a CRLF counting as one.
+    void split() {
+        const char *p_data = m_text.data();
+        size_type n_size = m_text.size();
+        size_type n_offset = 0;
+        m_offsets.push_back(0);
+        while (n_offset < n_size) {
+            size_type n_target = n_offset + m_nchunksize;
+            if (n_target >= n_size) {
+                n_offset = n_size;
+            } else {
+                const char *p_iter = p_data + n_target;
+                const char *p_end = p_data + n_size;
+                while (p_iter < p_end && *p_iter != '\n' && *p_iter != '\r') {
+                    p_iter++;
+                }
+                if (p_iter < p_end && *p_iter++ == '\r' && p_iter < p_end && *p_iter == '\n') {
+                    p_iter++;
+                }
+                n_offset = static_cast<size_type>(p_iter - p_data);
+            }
+            m_offsets.push_back(n_offset);
+        }
+    }
+};
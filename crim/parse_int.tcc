@@ -0,0 +1,332 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uint64_t */
+#include <cstring> /* std::memcpy */
+#include <limits> /* std::numeric_limits */
+#include <string_view> /* std::string_view */
+#include <type_traits> /* std::is_signed_v, std::make_unsigned_t */
+
+#include "impl/simd_char.hpp"
+
+/**
+ * @brief   Base 10 integer parsing for `char` text, 8 digits at a time.
+ *
+ *          Made for inputs that are mostly numbers, like the seed maps in
+ *          `2023/05-seeds` or the sequences in `2023/09-mirage`. There's no
+ *          locale, no allocation and no `errno`, just pointers in and out.
+ *
+ * @note    Want other bases or wide characters? `crim::basic_string_view`
+ *          still has `to_integer`, which does those one digit at a time.
+ */
+namespace crim {
+    template<class UIntT>
+    const char *parse_uint(const char *p_first, const char *p_last, UIntT &value) noexcept;
+
+    template<class IntT>
+    const char *parse_int(const char *p_first, const char *p_last, IntT &value) noexcept;
+
+    template<class UIntT>
+    bool parse_uint(std::string_view text, UIntT &value) noexcept;
+
+    template<class IntT>
+    bool parse_int(std::string_view text, IntT &value) noexcept;
+
+    template<class Container>
+    std::size_t extract_all_ints(std::string_view text, Container &out);
+};
+
+/**
+ * BEGIN: IMPLEMENTATION DETAILS -*---------------------------------------------
+ */
+
+namespace crim::impl::swar {
+    // `sizeof(UIntT)` bytes at `p_data`, first byte lowest whatever the CPU.
+    template<class UIntT>
+    UIntT load_little(const char *p_data) noexcept
+    {
+        UIntT n_value;
+        std::memcpy(&n_value, p_data, sizeof(n_value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        n_value = (sizeof(n_value) == 8) ? __builtin_bswap64(n_value) : __builtin_bswap32(n_value);
+#endif
+        return n_value;
+    }
+
+    /**
+     * @brief   Up to 8 bytes of `[p_first, p_last)` as one little-endian word,
+     *          first byte lowest. Past the end is filled with `'\0'`, which
+     *          isn't a digit, so a short read looks like a number that ends.
+     *
+     * @note    Fixed size copies are single loads, a variable one is a call to
+     *          `memcpy`. So short views, e.g. one token, use 2 loads that
+     *          overlap in the middle instead.
+     */
+    inline std::uint64_t load8(const char *p_first, const char *p_last) noexcept
+    {
+        std::size_t n_length = static_cast<std::size_t>(p_last - p_first);
+        if (n_length >= 8) {
+            return load_little<std::uint64_t>(p_first);
+        } else if (n_length >= 4) {
+            std::uint64_t n_low = load_little<std::uint32_t>(p_first);
+            std::uint64_t n_high = load_little<std::uint32_t>(p_last - 4);
+            return n_low | (n_high << (8 * (n_length - 4)));
+        } else if (n_length > 0) {
+            const unsigned char *p_bytes = reinterpret_cast<const unsigned char *>(p_first);
+            return p_bytes[0]
+                | (static_cast<std::uint64_t>(p_bytes[n_length / 2]) << (8 * (n_length / 2)))
+                | (static_cast<std::uint64_t>(p_bytes[n_length - 1]) << (8 * (n_length - 1)));
+        }
+        return 0;
+    }
+
+    /**
+     * @brief   How many of the 8 bytes in `n_word`, counting from the lowest,
+     *          are digits before the first non-digit.
+     *
+     * @note    XOR with `'0'` turns digits into 0-9. Adding 0x76 then sets the
+     *          top bit of any byte that was over 9. That add can carry into
+     *          the next byte up, but only out of a byte that's already flagged,
+     *          and we only care about the lowest flag anyway.
+     */
+    inline unsigned digit_count(std::uint64_t n_word) noexcept
+    {
+        std::uint64_t n_values = n_word ^ 0x3030303030303030ull;
+        std::uint64_t n_flags = ((n_values + 0x7676767676767676ull) | n_values) & 0x8080808080808080ull;
+        if (n_flags == 0) {
+            return 8;
+        }
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long n_index;
+        _BitScanForward64(&n_index, n_flags);
+        return static_cast<unsigned>(n_index) / 8;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(n_flags)) / 8;
+#endif
+    }
+
+    /**
+     * @brief   Value of the first `n_digits` (1 to 8) bytes of `n_word`, which
+     *          must all be digits. 3 multiplies instead of 8.
+     *
+     *          Shifting up first lines the digits up with the ones place, so
+     *          bytes past the number become leading zeros. Then neighbouring
+     *          pairs merge into 2 digits, those into 4, and those into 8.
+     */
+    inline std::uint64_t digits_value(std::uint64_t n_word, unsigned n_digits) noexcept
+    {
+        std::uint64_t n_values = (n_word ^ 0x3030303030303030ull) << (8 * (8 - n_digits));
+        n_values = ((n_values * 10) + (n_values >> 8)) & 0x00FF00FF00FF00FFull;
+        n_values = ((n_values * 100) + (n_values >> 16)) & 0x0000FFFF0000FFFFull;
+        n_values = ((n_values * 10000) + (n_values >> 32)) & 0x00000000FFFFFFFFull;
+        return n_values;
+    }
+
+    inline constexpr std::uint64_t POWERS_OF_10[9] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
+
+    /**
+     * @brief   Reads the run of digits at `p_first`, if it's no bigger than
+     *          `n_limit`.
+     *
+     * @return  Past the last digit, or `nullptr` if there were no digits at all
+     *          or the number went over `n_limit`.
+     */
+    inline const char *parse_digits(const char *p_first, const char *p_last,
+        std::uint64_t n_limit, std::uint64_t &n_result) noexcept
+    {
+        std::uint64_t n_word = load8(p_first, p_last);
+        unsigned n_digits = digit_count(n_word);
+        if (n_digits == 0) {
+            return nullptr;
+        }
+        // Most numbers are done in this one go, and 8 digits can't overflow.
+        std::uint64_t n_value = digits_value(n_word, n_digits);
+        const char *p_iter = p_first + n_digits;
+        if (n_value > n_limit) {
+            return nullptr;
+        }
+        while (n_digits == 8 && p_iter < p_last) {
+            n_word = load8(p_iter, p_last);
+            n_digits = digit_count(n_word);
+            if (n_digits == 0) {
+                break;
+            }
+            std::uint64_t n_chunk = digits_value(n_word, n_digits);
+            std::uint64_t n_scale = POWERS_OF_10[n_digits];
+            if (n_value < 10000000000ull) {
+                // Can't wrap: 10^10 * 10^8 is still well under 2^64.
+                n_value = n_value * n_scale + n_chunk;
+                if (n_value > n_limit) {
+                    return nullptr;
+                }
+            } else {
+                // Past 18 digits, so dividing is worth it to not wrap around.
+                if (n_value > (n_limit - n_chunk) / n_scale) {
+                    return nullptr;
+                }
+                n_value = n_value * n_scale + n_chunk;
+            }
+            p_iter += n_digits;
+        }
+        n_result = n_value;
+        return p_iter;
+    }
+
+    inline bool is_digit(char ch) noexcept
+    {
+        return static_cast<unsigned char>(ch - '0') <= 9;
+    }
+
+    /**
+     * @brief   First digit in `[p_first, p_last)`, or `p_last` if none. Skips
+     *          16 bytes at a time where SSE2 is around, since most text
+     *          between numbers is just a space or two but some isn't.
+     */
+    inline const char *find_digit(const char *p_first, const char *p_last) noexcept
+    {
+        const char *p_iter = p_first;
+#if defined(CRIM_CHAR_TRAITS_USE_SIMD)
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        while (p_last - p_iter >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_iter));
+            // Digits become 0-9, everything else wraps around to 10-255.
+            __m128i values = _mm_sub_epi8(chunk, zero);
+            __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(values, nine), values);
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(digits));
+            if (mask != 0) {
+                return p_iter + simd::first_bit(mask);
+            }
+            p_iter += 16;
+        }
+#endif
+        while (p_iter < p_last && !is_digit(*p_iter)) {
+            p_iter++;
+        }
+        return p_iter;
+    }
+};
+
+/**
+ * END: IMPLEMENTATION DETAILS -*-----------------------------------------------
+ */
+
+/**
+ * @brief   Reads a run of digits starting right at `p_first`, no sign and no
+ *          leading whitespace, like `std::from_chars`.
+ *
+ * @return  Past the last digit, or `nullptr` if there were no digits or the
+ *          number doesn't fit in `UIntT`. `value` is only written on success.
+ */
+template<class UIntT>
+const char *crim::parse_uint(const char *p_first, const char *p_last, UIntT &value) noexcept
+{
+    static_assert(!std::is_signed_v<UIntT> && sizeof(UIntT) <= sizeof(std::uint64_t),
+        "crim::parse_uint: use crim::parse_int for signed types");
+    if (p_first >= p_last) {
+        return nullptr;
+    }
+    std::uint64_t n_result = 0;
+    const char *p_end = impl::swar::parse_digits(p_first, p_last, std::numeric_limits<UIntT>::max(), n_result);
+    if (p_end != nullptr) {
+        value = static_cast<UIntT>(n_result);
+    }
+    return p_end;
+}
+
+/**
+ * @brief   Same as `crim::parse_uint`, but allows a leading `'-'` or `'+'`
+ *          like `to_integer` does.
+ */
+template<class IntT>
+const char *crim::parse_int(const char *p_first, const char *p_last, IntT &value) noexcept
+{
+    if constexpr (!std::is_signed_v<IntT>) {
+        return parse_uint(p_first, p_last, value);
+    } else {
+        using UIntT = std::make_unsigned_t<IntT>;
+        bool b_negative = false;
+        if (p_first < p_last && (*p_first == '-' || *p_first == '+')) {
+            b_negative = (*p_first == '-');
+            p_first++;
+        }
+        if (p_first >= p_last) {
+            return nullptr;
+        }
+        // Negative numbers get 1 more than positive ones in two's complement.
+        UIntT n_limit = static_cast<UIntT>(std::numeric_limits<IntT>::max()) + b_negative;
+        std::uint64_t n_result = 0;
+        const char *p_end = impl::swar::parse_digits(p_first, p_last, n_limit, n_result);
+        if (p_end != nullptr) {
+            UIntT n_unsigned = static_cast<UIntT>(n_result);
+            value = b_negative ? static_cast<IntT>(UIntT(0) - n_unsigned) : static_cast<IntT>(n_unsigned);
+        }
+        return p_end;
+    }
+}
+
+/**
+ * @brief   Parses all of `text` as one number.
+ *
+ * @return  `false` if anything is left over, otherwise same as the pointer
+ *          version. `value` is only written on success.
+ */
+template<class UIntT>
+bool crim::parse_uint(std::string_view text, UIntT &value) noexcept
+{
+    const char *p_last = text.data() + text.size();
+    return parse_uint(text.data(), p_last, value) == p_last;
+}
+
+template<class IntT>
+bool crim::parse_int(std::string_view text, IntT &value) noexcept
+{
+    const char *p_last = text.data() + text.size();
+    return parse_int(text.data(), p_last, value) == p_last;
+}
+
+/**
+ * @brief   Appends every integer in `text` to `out`, in order, as
+ *          `Container::value_type`. Anything that isn't a digit separates
+ *          numbers. For signed types a `'-'` right before a number makes it
+ *          negative, so `"x=-3,y=4"` gives -3 and 4.
+ *
+ * @return  How many numbers were appended.
+ *
+ * @note    `out` only needs `push_back`, so `crim::dyarray` and `std::vector`
+ *          both work. Numbers too big for the value type are skipped.
+ */
+template<class Container>
+std::size_t crim::extract_all_ints(std::string_view text, Container &out)
+{
+    using IntT = typename Container::value_type;
+    const char *p_first = text.data();
+    const char *p_last = p_first + text.size();
+    const char *p_iter = p_first;
+    std::size_t n_count = 0;
+    for (;;) {
+        p_iter = impl::swar::find_digit(p_iter, p_last);
+        if (p_iter == p_last) {
+            break;
+        }
+        IntT value;
+        const char *p_sign = p_iter;
+        if constexpr (std::is_signed_v<IntT>) {
+            p_sign = (p_iter > p_first && p_iter[-1] == '-') ? p_iter - 1 : p_iter;
+        }
+        const char *p_end = parse_int(p_sign, p_last, value);
+        if (p_end != nullptr) {
+            out.push_back(value);
+            n_count++;
+            p_iter = p_end;
+        } else {
+            // Too big, so skip the whole thing rather than half of it.
+            while (p_iter < p_last && impl::swar::is_digit(*p_iter)) {
+                p_iter++;
+            }
+        }
+    }
+    return n_count;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "base_dyarray.tcc"
+
+namespace crim {
+    template<
+        class ElemT, size_t N, class AllocT = crim::allocator<ElemT>
+    > class small_dyarray;
+};
+
+/**
+ * @brief   A `crim::dyarray` that keeps its first `N` elements inside itself,
+ *          usually on the stack. It only goes to the allocator once you push
+ *          more than that, after which it grows like any other dyarray.
+ *
+ *          Good for the many tiny arrays of a line-by-line solution, e.g. the
+ *          handful of digits on one line, where a heap block per line is most
+ *          of the work.
+ *
+ * @tparam  ElemT   Desired type of the buffer's elements.
+ * @tparam  N       How many elements fit before we spill to the heap.
+ * @tparam  AllocT  Desired allocator, only used once we spill.
+ *
+ * @note    Moving a small array that hasn't spilled moves each element, so it's
+ *          as slow as copying `N` elements. It's also not trivially relocatable
+ *          since `m_pbuffer` may point into ourselves.
+ */
+template<class ElemT, size_t N, class AllocT>
+class crim::small_dyarray
+    : public crim::base_dyarray<crim::small_dyarray<ElemT, N, AllocT>, ElemT, AllocT> {
+private:
+    using base = base_dyarray<small_dyarray<ElemT, N, AllocT>, ElemT, AllocT>;
+    friend base; // So it can see the inline storage hooks below.
+
+    static_assert(N > 0, "Use crim::dyarray if you don't want inline storage!");
+
+    alignas(ElemT) unsigned char m_plocal[N * sizeof(ElemT)];
+
+    // Shadows `base::local_buffer()`.
+    ElemT *local_buffer() {
+        return reinterpret_cast<ElemT *>(m_plocal);
+    }
+
+    // Shadows `base::local_capacity()`.
+    static constexpr size_t local_capacity() {
+        return N;
+    }
+
+public:
+    // Empty, but can already hold `N` elements without allocating.
+    small_dyarray() : small_dyarray(AllocT()) {}
+
+    explicit small_dyarray(const AllocT &alloc) : base(alloc) {
+        base::reset();
+    }
+
+    small_dyarray(std::initializer_list<ElemT> list, const AllocT &alloc = AllocT())
+    : small_dyarray(alloc) {
+        base::append_range(list.begin(), list.end());
+    }
+
+    small_dyarray(const small_dyarray &src)
+    : small_dyarray(std::allocator_traits<AllocT>::select_on_container_copy_construction(src.m_malloc)) {
+        base::append_range(src.begin(), src.end());
+    }
+
+    // We share `src`'s allocator, so a spilled buffer can always be stolen.
+    small_dyarray(small_dyarray &&src) noexcept : small_dyarray(src.m_malloc) {
+        base::move(std::forward<base>(src));
+    }
+
+    // Our inline storage is about to go, so don't let the base class see it.
+    ~small_dyarray() {
+        base::destroy_buffer();
+        base::m_pbuffer = nullptr;
+    }
+
+    small_dyarray &operator=(const small_dyarray &src) {
+        return base::copy(src);
+    }
+
+    small_dyarray &operator=(small_dyarray &&src) noexcept(base::is_nothrow_move_assignable) {
+        return base::move(std::forward<base>(src));
+    }
+
+    // True if we've outgrown the inline storage.
+    bool spilled() const {
+        return base::m_pbuffer != reinterpret_cast<const ElemT *>(m_plocal);
+    }
+};
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <limits> /* std::numeric_limits */
+#include <stdexcept> /* std::out_of_range */
+#include <string_view> /* std::basic_string_view */
+#include <type_traits> /* std::is_signed_v, std::make_unsigned_t */
+
+#include "logerror.hpp"
+#include "type_traits.tcc"
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::basic_string_view<T>", func, info)
+
+namespace crim {
+    template<class CharT, class Traits = crim::char_traits<CharT>>
+    class basic_string_view;
+
+    using string_view = basic_string_view<char>;
+    using wstring_view = basic_string_view<wchar_t>;
+};
+
+/**
+ * BEGIN: STRING VIEW IMPLEMENTATION -*-----------------------------------------
+ */
+
+/**
+ * @brief   Read-only pointer and length pair into somebody else's characters,
+ *          e.g. a line of a `crim::mapped_file` or a `crim::cstring`.
+ *
+ *          Slicing, trimming and splitting just hand out narrower views, so
+ *          a parser can chew through a whole input without a single heap
+ *          allocation. Everything goes through `Traits`, i.e. our very own
+ *          `crim::impl::char_traits`, so `char` gets `memchr` and friends.
+ *
+ * @note    Unlike `std::string_view::substr`, out of range positions get
+ *          clamped rather than thrown at you. Only `at()` throws.
+ *
+ * @warning We're not nul terminated! Print us with `"%.*s"`.
+ */
+template<class CharT, class Traits>
+class crim::basic_string_view {
+public:
+    using value_type = CharT;
+    using traits_type = Traits;
+    using size_type = std::size_t;
+    using pointer = const CharT *;
+    using const_pointer = const CharT *;
+    using const_reference = const CharT &;
+    using const_iterator = const CharT *;
+
+    // Like `std::string::npos`: "not found" or "until the very end".
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+    const_pointer m_pdata;
+    size_type m_nlength;
+
+public:
+    /* -*- CONSTRUCTORS -*- */
+
+    constexpr basic_string_view() noexcept
+        : m_pdata{nullptr}
+        , m_nlength{0}
+    {}
+
+    constexpr basic_string_view(const_pointer p_data, size_type n_length) noexcept
+        : m_pdata{p_data}
+        , m_nlength{n_length}
+    {}
+
+    // Nul terminated `p_literal`, which we don't own so it must outlive us.
+    basic_string_view(const_pointer p_literal) noexcept
+        : basic_string_view(p_literal, traits_type::length(p_literal))
+    {}
+
+    // So we can look at lines from `crim::mapped_file` and `crim::line_index`.
+    constexpr basic_string_view(std::basic_string_view<CharT> view) noexcept
+        : basic_string_view(view.data(), view.length())
+    {}
+
+    constexpr operator std::basic_string_view<CharT>() const noexcept
+    {
+        return std::basic_string_view<CharT>(m_pdata, m_nlength);
+    }
+
+    /* -*- DATA ACCESS -*- */
+
+    constexpr const_pointer data() const noexcept
+    {
+        return m_pdata;
+    }
+
+    constexpr size_type length() const noexcept
+    {
+        return m_nlength;
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return m_nlength;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return m_nlength == 0;
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return m_pdata;
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return m_pdata + m_nlength;
+    }
+
+    // No bounds checking, see `at()` for that.
+    constexpr const_reference operator[](size_type n_index) const noexcept
+    {
+        return m_pdata[n_index];
+    }
+
+    /**
+     * @brief       Read-only element access.
+     *
+     * @exception   `std::out_of_range` if `n_index` if out of bounds.
+     */
+    const_reference at(size_type n_index) const
+    {
+        if (n_index >= m_nlength) {
+            crim_logerror("at", "Requested an invalid index!");
+            throw std::out_of_range("See log message.");
+        }
+        return m_pdata[n_index];
+    }
+
+    constexpr const_reference front() const noexcept
+    {
+        return m_pdata[0];
+    }
+
+    constexpr const_reference back() const noexcept
+    {
+        return m_pdata[m_nlength - 1];
+    }
+
+    /* -*- SLICING -*- */
+
+    /**
+     * @brief   Inspired by Lua's `string.sub`, but 0-based: the characters from
+     *          `n_start` up to but not including `n_stop`. Both get clamped.
+     */
+    constexpr basic_string_view slice(size_type n_start, size_type n_stop = npos) const noexcept
+    {
+        n_stop = (n_stop < m_nlength) ? n_stop : m_nlength;
+        n_start = (n_start < n_stop) ? n_start : n_stop;
+        return basic_string_view(m_pdata + n_start, n_stop - n_start);
+    }
+
+    // Like `std::string_view::substr`, but `n_start` gets clamped too.
+    constexpr basic_string_view substr(size_type n_start, size_type n_count = npos) const noexcept
+    {
+        n_start = (n_start < m_nlength) ? n_start : m_nlength;
+        size_type n_left = m_nlength - n_start;
+        return basic_string_view(m_pdata + n_start, (n_count < n_left) ? n_count : n_left);
+    }
+
+    constexpr void remove_prefix(size_type n_count) noexcept
+    {
+        n_count = (n_count < m_nlength) ? n_count : m_nlength;
+        m_pdata += n_count;
+        m_nlength -= n_count;
+    }
+
+    constexpr void remove_suffix(size_type n_count) noexcept
+    {
+        m_nlength -= (n_count < m_nlength) ? n_count : m_nlength;
+    }
+
+    /* -*- SEARCHING -*- */
+
+    // Index of the first `ch` at or after `n_start`, else `npos`.
+    size_type find(CharT ch, size_type n_start = 0) const noexcept
+    {
+        if (n_start >= m_nlength) {
+            return npos;
+        }
+        const_pointer p_found = traits_type::find(m_pdata + n_start, m_nlength - n_start, ch);
+        return (p_found == nullptr) ? npos : static_cast<size_type>(p_found - m_pdata);
+    }
+
+    // Index of the first `needle` at or after `n_start`, else `npos`.
+    size_type find(basic_string_view needle, size_type n_start = 0) const noexcept
+    {
+        if (needle.empty()) {
+            return (n_start <= m_nlength) ? n_start : npos;
+        } else if (n_start >= m_nlength) {
+            return npos;
+        }
+        const_pointer p_found = traits_type::search(m_pdata + n_start, m_nlength - n_start,
+            needle.data(), needle.length());
+        return (p_found == nullptr) ? npos : static_cast<size_type>(p_found - m_pdata);
+    }
+
+    // Index of the last `ch`, else `npos`.
+    size_type rfind(CharT ch) const noexcept
+    {
+        for (size_type i = m_nlength; i > 0; i--) {
+            if (traits_type::eq(m_pdata[i - 1], ch)) {
+                return i - 1;
+            }
+        }
+        return npos;
+    }
+
+    bool contains(CharT ch) const noexcept
+    {
+        return find(ch) != npos;
+    }
+
+    bool starts_with(basic_string_view prefix) const noexcept
+    {
+        return m_nlength >= prefix.length()
+            && compare_n(m_pdata, prefix.data(), prefix.length()) == 0;
+    }
+
+    bool starts_with(CharT ch) const noexcept
+    {
+        return m_nlength > 0 && traits_type::eq(m_pdata[0], ch);
+    }
+
+    bool ends_with(basic_string_view suffix) const noexcept
+    {
+        return m_nlength >= suffix.length()
+            && compare_n(end() - suffix.length(), suffix.data(), suffix.length()) == 0;
+    }
+
+    bool ends_with(CharT ch) const noexcept
+    {
+        return m_nlength > 0 && traits_type::eq(m_pdata[m_nlength - 1], ch);
+    }
+
+    /* -*- TRIMMING -*- */
+
+    // Spaces, tabs and line endings.
+    static constexpr bool is_space(CharT ch) noexcept
+    {
+        return ch == CharT(' ') || ch == CharT('\t') || ch == CharT('\n')
+            || ch == CharT('\r') || ch == CharT('\v') || ch == CharT('\f');
+    }
+
+    constexpr basic_string_view trim_left() const noexcept
+    {
+        size_type n_start = 0;
+        while (n_start < m_nlength && is_space(m_pdata[n_start])) {
+            n_start++;
+        }
+        return basic_string_view(m_pdata + n_start, m_nlength - n_start);
+    }
+
+    constexpr basic_string_view trim_right() const noexcept
+    {
+        size_type n_stop = m_nlength;
+        while (n_stop > 0 && is_space(m_pdata[n_stop - 1])) {
+            n_stop--;
+        }
+        return basic_string_view(m_pdata, n_stop);
+    }
+
+    constexpr basic_string_view trim() const noexcept
+    {
+        return trim_left().trim_right();
+    }
+
+    /* -*- SPLITTING -*- */
+
+    /**
+     * @brief   Cuts off everything up to the first `delim` and hands it back,
+     *          leaving us with whatever came after it. If there's no `delim`,
+     *          you get all of us and we end up empty.
+     *
+     * @note    Handy for `"Game 1: 3 blue; 4 red"` style lines where each part
+     *          has a different delimiter.
+     */
+    basic_string_view split_first(CharT delim) noexcept
+    {
+        size_type n_found = find(delim);
+        basic_string_view head = slice(0, n_found);
+        remove_prefix((n_found == npos) ? npos : n_found + 1);
+        return head;
+    }
+
+    class split_iterator;
+    class split_range;
+
+    /**
+     * @brief   Every piece between `delim`s, for use with range-based for loops.
+     *          `"a,,b"` gives `"a"`, `""` then `"b"`, just like Python would.
+     */
+    constexpr split_range split(CharT delim) const noexcept
+    {
+        return split_range(*this, delim);
+    }
+
+    /* -*- COMPARISON -*- */
+
+    int compare(basic_string_view other) const noexcept
+    {
+        size_type n_common = (m_nlength < other.m_nlength) ? m_nlength : other.m_nlength;
+        int n_result = compare_n(m_pdata, other.m_pdata, n_common);
+        if (n_result != 0) {
+            return n_result;
+        }
+        return (m_nlength < other.m_nlength) ? -1 : (m_nlength > other.m_nlength);
+    }
+
+    // Hidden friends, so `view == "red"` converts the literal for us.
+    friend bool operator==(basic_string_view lhs, basic_string_view rhs) noexcept
+    {
+        return lhs.m_nlength == rhs.m_nlength
+            && compare_n(lhs.m_pdata, rhs.m_pdata, lhs.m_nlength) == 0;
+    }
+
+    friend bool operator!=(basic_string_view lhs, basic_string_view rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(basic_string_view lhs, basic_string_view rhs) noexcept
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    /* -*- NUMERIC CONVERSION -*- */
+
+    /**
+     * @brief   Parses all of us as an integer in `base`, with an optional sign
+     *          for signed `IntT`. Digits past 9 may be upper or lower case.
+     *
+     * @return  `false` if we're empty, have anything that's not a digit, or
+     *          don't fit in `IntT`. `value` is untouched in that case.
+     */
+    template<class IntT>
+    bool to_integer(IntT &value, int base = 10) const noexcept
+    {
+        using UIntT = std::make_unsigned_t<IntT>;
+        size_type i = 0;
+        bool b_negative = false;
+        if constexpr (std::is_signed_v<IntT>) {
+            if (m_nlength > 0 && (m_pdata[0] == CharT('-') || m_pdata[0] == CharT('+'))) {
+                b_negative = (m_pdata[0] == CharT('-'));
+                i++;
+            }
+        }
+        if (i == m_nlength) {
+            return false;
+        }
+        // Negative numbers get 1 more than positive ones in two's complement.
+        UIntT n_limit = static_cast<UIntT>(std::numeric_limits<IntT>::max()) + b_negative;
+        UIntT n_result = 0;
+        for (/* Empty */; i < m_nlength; i++) {
+            int n_digit = digit_value(m_pdata[i]);
+            if (n_digit < 0 || n_digit >= base) {
+                return false;
+            }
+            // Would `n_result * base + n_digit` go past `n_limit`?
+            UIntT n_ubase = static_cast<UIntT>(base);
+            if (n_result > (n_limit - static_cast<UIntT>(n_digit)) / n_ubase) {
+                return false;
+            }
+            n_result = n_result * n_ubase + static_cast<UIntT>(n_digit);
+        }
+        value = b_negative ? static_cast<IntT>(UIntT(0) - n_result) : static_cast<IntT>(n_result);
+        return true;
+    }
+
+private:
+    // `Traits::compare` might be `memcmp`, which doesn't like `nullptr`.
+    static int compare_n(const_pointer p_lhs, const_pointer p_rhs, size_type n_count) noexcept
+    {
+        return (n_count == 0) ? 0 : traits_type::compare(p_lhs, p_rhs, n_count);
+    }
+
+    // 0-9 for digits, 10-35 for letters either case, -1 for anything else.
+    static constexpr int digit_value(CharT ch) noexcept
+    {
+        if (ch >= CharT('0') && ch <= CharT('9')) {
+            return static_cast<int>(ch - CharT('0'));
+        } else if (ch >= CharT('a') && ch <= CharT('z')) {
+            return static_cast<int>(ch - CharT('a')) + 10;
+        } else if (ch >= CharT('A') && ch <= CharT('Z')) {
+            return static_cast<int>(ch - CharT('A')) + 10;
+        }
+        return -1;
+    }
+};
+
+/**
+ * @brief   Walks a view one `delim`-separated piece at a time. Each step is a
+ *          `find()`, nothing is copied.
+ */
+template<class CharT, class Traits>
+class crim::basic_string_view<CharT, Traits>::split_iterator {
+private:
+    basic_string_view m_rest; // Everything after the current piece.
+    basic_string_view m_piece; // What we dereference to.
+    CharT m_delim;
+    bool m_bmore; // Is there another piece in `m_rest`, even an empty one?
+    bool m_bdone; // Past the last piece, i.e. equal to `end()`.
+
+public:
+    constexpr split_iterator() noexcept
+        : m_rest{}
+        , m_piece{}
+        , m_delim{}
+        , m_bmore{false}
+        , m_bdone{true}
+    {}
+
+    split_iterator(basic_string_view text, CharT delim) noexcept
+        : m_rest{text}
+        , m_piece{}
+        , m_delim{delim}
+        , m_bmore{true}
+        , m_bdone{false}
+    {
+        advance();
+    }
+
+    constexpr basic_string_view operator*() const noexcept
+    {
+        return m_piece;
+    }
+
+    constexpr const basic_string_view *operator->() const noexcept
+    {
+        return &m_piece;
+    }
+
+    split_iterator &operator++() noexcept
+    {
+        advance();
+        return *this;
+    }
+
+    friend bool operator==(const split_iterator &lhs, const split_iterator &rhs) noexcept
+    {
+        if (lhs.m_bdone || rhs.m_bdone) {
+            return lhs.m_bdone == rhs.m_bdone;
+        }
+        return lhs.m_piece.data() == rhs.m_piece.data() && lhs.m_bmore == rhs.m_bmore;
+    }
+
+    friend bool operator!=(const split_iterator &lhs, const split_iterator &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    void advance() noexcept
+    {
+        if (!m_bmore) {
+            m_bdone = true;
+            return;
+        }
+        size_type n_found = m_rest.find(m_delim);
+        if (n_found == npos) {
+            m_piece = m_rest;
+            m_bmore = false;
+        } else {
+            m_piece = m_rest.slice(0, n_found);
+            m_rest.remove_prefix(n_found + 1);
+        }
+    }
+};
+
+template<class CharT, class Traits>
+class crim::basic_string_view<CharT, Traits>::split_range {
+private:
+    basic_string_view m_text;
+    CharT m_delim;
+
+public:
+    constexpr split_range(basic_string_view text, CharT delim) noexcept
+        : m_text{text}
+        , m_delim{delim}
+    {}
+
+    split_iterator begin() const noexcept
+    {
+        return split_iterator(m_text, m_delim);
+    }
+
+    split_iterator end() const noexcept
+    {
+        return split_iterator();
+    }
+};
+
+/**
+ * END: STRING VIEW IMPLEMENTATION -*-------------------------------------------
+ */
+
+#undef crim_logerror
@@ -0,0 +1,450 @@
+#pragma once
+
+#include <atomic> /* std::atomic */
+#include <climits> /* CHAR_BIT */
+#include <cstddef> /* std::size_t */
+#include <cstdio> /* std::FILE, std::fprintf */
+#include <cstdlib> /* std::malloc, std::free, std::realloc */
+#include <cstring> /* std::memcpy */
+#include <mutex> /* std::mutex, std::lock_guard */
+#include <new> /* std::bad_alloc */
+
+#include "logerror.hpp"
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::thread_cache", func, info)
+
+namespace crim {
+    class thread_cache;
+};
+
+/**
+ * BEGIN: THREAD CACHE IMPLEMENTATION -*----------------------------------------
+ */
+
+/**
+ * @brief   Small allocations are rounded up to a power of 2 size class, from
+ *          16 to 2048 bytes. Each thread keeps a "magazine" of free blocks per
+ *          class, so most allocations and frees are just a pointer swap on a
+ *          `thread_local` list and never take a lock.
+ *
+ *          When a magazine runs dry we grab a whole batch from that class's
+ *          central free list, which is guarded by a mutex. When it gets too
+ *          full we give a batch back, so memory freed by one thread can be
+ *          reused by the others.
+ *
+ *          Anything bigger than the largest class goes to `std::malloc`.
+ *
+ * @note    Selected for `crim::allocator` by defining the macro
+ *          `CRIM_ALLOCATOR_USE_THREAD_CACHE` before including `memory.tcc`.
+ *          Define `CRIM_THREAD_CACHE_REPORT_AT_EXIT` to get `report()` for free.
+ *
+ * @warning Callers must pass the same size to `deallocate()` they gave to
+ *          `allocate()`, since blocks have no header to tell us their class.
+ *          Spans are never given back to the system, same as most mallocs.
+ */
+class crim::thread_cache {
+public:
+    static constexpr std::size_t min_shift = 4;
+    static constexpr std::size_t min_size = std::size_t(1) << min_shift;
+    static constexpr std::size_t max_size = 2048;
+    static constexpr std::size_t class_count = 8; // 16, 32, 64, ..., 2048
+    static constexpr std::size_t batch_size = 32; // Blocks moved per refill/flush.
+    static constexpr std::size_t span_size = 64 * 1024; // Carved into 1 class.
+
+    // Counters for a single thread. Only that thread ever writes to them.
+    struct stats {
+        std::size_t thread_id; // 0 for whoever used the cache first, etc.
+        std::size_t allocs; // Small allocations.
+        std::size_t hits; // Small allocations served without a lock.
+        std::size_t frees; // Small deallocations.
+        std::size_t refills; // Batches taken from the central lists.
+        std::size_t flushes; // Batches given back to the central lists.
+        std::size_t large; // Allocations passed on to `std::malloc`.
+
+        double hit_rate() const noexcept
+        {
+            return (allocs == 0) ? 0.0 : static_cast<double>(hits) / allocs;
+        }
+    };
+
+private:
+    // Free blocks store the pointer to the next free block in themselves.
+    struct node {
+        node *next;
+    };
+
+    // One thread's free blocks for one size class.
+    struct magazine {
+        node *head;
+        std::size_t count;
+    };
+
+    // Shared free blocks for one size class.
+    struct central_list {
+        std::mutex lock;
+        node *head;
+        node *spans; // Every span we carved, so they're still reachable.
+    };
+
+    // Stats of threads that already exited, so `report()` can still see them.
+    // Past the first 64 they're all added up into `others` instead, so pools
+    // that keep making threads still count towards the totals.
+    struct registry {
+        std::mutex lock;
+        stats exited[64];
+        std::size_t count;
+        stats others;
+        std::size_t n_merged; // How many threads went into `others`.
+        std::atomic<std::size_t> next_id;
+    };
+
+    struct local {
+        magazine mags[class_count];
+        stats counters;
+
+        local() noexcept
+            : mags{}
+            , counters{}
+        {
+            counters.thread_id = get_registry().next_id++;
+            cache_ptr() = this;
+        }
+
+        // Give everything back so other threads can use it, then log our stats.
+        ~local()
+        {
+            for (std::size_t i = 0; i < class_count; i++) {
+                if (mags[i].head != nullptr) {
+                    flush(i, mags[i], mags[i].count);
+                }
+            }
+            cache_ptr() = nullptr;
+            is_destroyed() = true;
+            registry &reg = get_registry();
+            std::lock_guard<std::mutex> guard(reg.lock);
+            if (reg.count < sizeof(reg.exited) / sizeof(reg.exited[0])) {
+                reg.exited[reg.count++] = counters;
+            } else {
+                reg.others.allocs += counters.allocs;
+                reg.others.hits += counters.hits;
+                reg.others.frees += counters.frees;
+                reg.others.refills += counters.refills;
+                reg.others.flushes += counters.flushes;
+                reg.others.large += counters.large;
+                reg.n_merged++;
+            }
+        }
+    };
+
+public:
+    /**
+     * @brief   `n_bytes` of memory aligned to at least 16 bytes.
+     *
+     * @exception   `std::bad_alloc` if `std::malloc` fails on us.
+     */
+    static void *allocate(std::size_t n_bytes)
+    {
+        local *p_cache = this_thread();
+        if (n_bytes > max_size) {
+            if (p_cache != nullptr) {
+                p_cache->counters.large++;
+            }
+            void *p_memory = std::malloc(n_bytes);
+            if (p_memory == nullptr) {
+                crim_logerror("allocate", "Failed to allocate memory!");
+                throw std::bad_alloc();
+            }
+            return p_memory;
+        }
+        std::size_t n_class = class_of(n_bytes);
+        // e.g. static destructors running after this thread's cache is gone.
+        if (p_cache == nullptr) {
+            magazine mag{nullptr, 0};
+            refill(n_class, mag, 1);
+            return mag.head;
+        }
+        local &cache = *p_cache;
+        magazine &mag = cache.mags[n_class];
+        cache.counters.allocs++;
+        if (mag.head != nullptr) {
+            cache.counters.hits++;
+        } else {
+            cache.counters.refills++;
+            refill(n_class, mag, batch_size);
+        }
+        node *p_node = mag.head;
+        mag.head = p_node->next;
+        mag.count--;
+        return p_node;
+    }
+
+    /**
+     * @brief   `n_bytes` must be the same as what was passed to `allocate()`.
+     */
+    static void deallocate(void *p_memory, std::size_t n_bytes) noexcept
+    {
+        if (p_memory == nullptr) {
+            return;
+        } else if (n_bytes > max_size) {
+            std::free(p_memory);
+            return;
+        }
+        std::size_t n_class = class_of(n_bytes);
+        node *p_node = static_cast<node *>(p_memory);
+        p_node->next = nullptr;
+        local *p_cache = this_thread();
+        if (p_cache == nullptr) {
+            magazine mag{p_node, 1};
+            flush(n_class, mag, 1);
+            return;
+        }
+        local &cache = *p_cache;
+        magazine &mag = cache.mags[n_class];
+        p_node->next = mag.head;
+        mag.head = p_node;
+        mag.count++;
+        cache.counters.frees++;
+        // Keep a batch around for ourselves, the rest goes back.
+        if (mag.count >= batch_size * 2) {
+            cache.counters.flushes++;
+            flush(n_class, mag, batch_size);
+        }
+    }
+
+    /**
+     * @brief   Sizes in the same class don't need to move at all. Big blocks go
+     *          through `std::realloc`, everything else is allocate-copy-free.
+     *
+     * @exception   `std::bad_alloc`, in which case `p_memory` is untouched.
+     */
+    static void *reallocate(void *p_memory, std::size_t n_oldbytes, std::size_t n_newbytes)
+    {
+        if (n_oldbytes > max_size && n_newbytes > max_size) {
+            void *p_newmemory = std::realloc(p_memory, n_newbytes);
+            if (p_newmemory == nullptr) {
+                crim_logerror("reallocate", "Failed to reallocate memory!");
+                throw std::bad_alloc();
+            }
+            return p_newmemory;
+        } else if (n_oldbytes <= max_size && n_newbytes <= max_size 
+            && class_of(n_oldbytes) == class_of(n_newbytes)) {
+            return p_memory;
+        }
+        void *p_newmemory = allocate(n_newbytes);
+        std::memcpy(p_newmemory, p_memory, (n_oldbytes < n_newbytes) ? n_oldbytes : n_newbytes);
+        deallocate(p_memory, n_oldbytes);
+        return p_newmemory;
+    }
+
+    // Counters for the calling thread so far.
+    static stats local_stats() noexcept
+    {
+        local *p_cache = this_thread();
+        return (p_cache == nullptr) ? stats{} : p_cache->counters;
+    }
+
+    /**
+     * @brief   Prints the hit rate of every thread that already exited, then
+     *          of the calling thread.
+     */
+    static void report(std::FILE *stream)
+    {
+        registry &reg = get_registry();
+        std::fprintf(stream, "crim::thread_cache:\n");
+        {
+            std::lock_guard<std::mutex> guard(reg.lock);
+            for (std::size_t i = 0; i < reg.count; i++) {
+                print_stats(stream, reg.exited[i]);
+            }
+            if (reg.n_merged > 0) {
+                std::fprintf(stream, "\t%zu more threads, added up:\n", reg.n_merged);
+                print_stats(stream, reg.others, "others");
+            }
+        }
+        // At exit, the main thread's cache is already gone and logged.
+        local *p_cache = this_thread();
+        if (p_cache != nullptr) {
+            print_stats(stream, p_cache->counters);
+        }
+    }
+
+private:
+    /**
+     * @brief   Rounds `n_bytes` up to its size class, i.e. the index of the
+     *          next power of 2 starting at `min_size`.
+     */
+    static std::size_t class_of(std::size_t n_bytes) noexcept
+    {
+        if (n_bytes <= min_size) {
+            return 0;
+        }
+#if defined(__GNUC__) || defined(__clang__)
+        // Bit length of `n_bytes - 1`, so exact powers of 2 aren't rounded up.
+        std::size_t n_length = sizeof(unsigned long long) * CHAR_BIT 
+            - __builtin_clzll(static_cast<unsigned long long>(n_bytes - 1));
+        return n_length - min_shift;
+#else
+        std::size_t n_class = 0;
+        for (std::size_t n_size = min_size; n_size < n_bytes; n_size <<= 1) {
+            n_class++;
+        }
+        return n_class;
+#endif
+    }
+
+    static constexpr std::size_t size_of(std::size_t n_class) noexcept
+    {
+        return min_size << n_class;
+    }
+
+    /**
+     * @brief   These are never destroyed on purpose. Static destructors that run
+     *          after ours could still free memory that belongs to them.
+     */
+    static central_list &get_central(std::size_t n_class) noexcept
+    {
+        static central_list *p_lists = new central_list[class_count]();
+        return p_lists[n_class];
+    }
+
+    static registry &get_registry() noexcept
+    {
+        static registry *p_reg = new_registry();
+        return *p_reg;
+    }
+
+    static registry *new_registry()
+    {
+        registry *p_reg = new registry();
+#if defined(CRIM_THREAD_CACHE_REPORT_AT_EXIT)
+        // Thread-local destructors, including the main thread's, run first.
+        std::atexit([]() {
+            thread_cache::report(stderr);
+        });
+#endif
+        return p_reg;
+    }
+
+    // Set once this thread's cache was destroyed, it's a trivial type so it
+    // outlives the cache itself.
+    static bool &is_destroyed() noexcept
+    {
+        thread_local bool b_destroyed = false;
+        return b_destroyed;
+    }
+
+    /**
+     * @brief   Trivial types don't need the `thread_local` init guard, so the
+     *          fast path only ever reads this pointer.
+     */
+    static local *&cache_ptr() noexcept
+    {
+        thread_local local *p_cache = nullptr;
+        return p_cache;
+    }
+
+    // `nullptr` once this thread's cache was destroyed.
+    static local *this_thread() noexcept
+    {
+        local *p_cache = cache_ptr();
+        if (p_cache == nullptr && !is_destroyed()) {
+            p_cache = init_cache();
+        }
+        return p_cache;
+    }
+
+    static local *init_cache() noexcept
+    {
+        thread_local local cache;
+        return &cache;
+    }
+
+    /**
+     * @brief   Moves up to `n_count` blocks from the central list into `mag`,
+     *          carving a brand new span if the central list is empty.
+     *
+     * @exception   `std::bad_alloc` if we couldn't get a new span.
+     */
+    static void refill(std::size_t n_class, magazine &mag, std::size_t n_count)
+    {
+        central_list &central = get_central(n_class);
+        std::lock_guard<std::mutex> guard(central.lock);
+        if (central.head == nullptr) {
+            carve_span(n_class, central);
+        }
+        // Splice the first batch of the central list onto the magazine.
+        node *p_first = central.head;
+        node *p_last = p_first;
+        std::size_t n_moved = 1;
+        for (/* Empty */; n_moved < n_count && p_last->next != nullptr; n_moved++) {
+            p_last = p_last->next;
+        }
+        central.head = p_last->next;
+        p_last->next = mag.head;
+        mag.head = p_first;
+        mag.count += n_moved;
+    }
+
+    // Gives the first `n_count` blocks of `mag` back to the central list.
+    static void flush(std::size_t n_class, magazine &mag, std::size_t n_count) noexcept
+    {
+        node *p_first = mag.head;
+        node *p_last = p_first;
+        for (std::size_t i = 1; i < n_count; i++) {
+            p_last = p_last->next;
+        }
+        mag.head = p_last->next;
+        mag.count -= n_count;
+
+        central_list &central = get_central(n_class);
+        std::lock_guard<std::mutex> guard(central.lock);
+        p_last->next = central.head;
+        central.head = p_first;
+    }
+
+    /**
+     * @brief   The first block of every span links it into `central.spans` and
+     *          is never handed out. The rest are pushed onto `central.head`.
+     */
+    static void carve_span(std::size_t n_class, central_list &central)
+    {
+        char *p_span = static_cast<char *>(std::malloc(span_size));
+        if (p_span == nullptr) {
+            crim_logerror("refill", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        node *p_header = reinterpret_cast<node *>(p_span);
+        p_header->next = central.spans;
+        central.spans = p_header;
+
+        std::size_t n_size = size_of(n_class);
+        for (std::size_t n_offset = span_size - n_size; n_offset >= n_size; n_offset -= n_size) {
+            node *p_node = reinterpret_cast<node *>(p_span + n_offset);
+            p_node->next = central.head;
+            central.head = p_node;
+        }
+    }
+
+    // `name` is for `others`, which doesn't have a thread ID of its own.
+    static void print_stats(std::FILE *stream, const stats &counters, const char *name = nullptr)
+    {
+        if (name != nullptr) {
+            std::fprintf(stream, "\t%s: ", name);
+        } else {
+            std::fprintf(stream, "\tthread %zu: ", counters.thread_id);
+        }
+        std::fprintf(stream,
+            "%zu allocs, %zu frees, %.2f%% hits, "
+            "%zu refills, %zu flushes, %zu large\n",
+            counters.allocs, counters.frees,
+            counters.hit_rate() * 100.0, counters.refills, counters.flushes,
+            counters.large);
+    }
+};
+
+/**
+ * END: THREAD CACHE IMPLEMENTATION -*------------------------------------------
+ */
+
+#undef crim_logerror
@@ -0,0 +1,560 @@
+#pragma once
+
+#include <atomic> /* std::atomic */
+#include <condition_variable> /* std::condition_variable */
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uint64_t */
+#include <deque> /* std::deque */
+#include <exception> /* std::exception_ptr, std::current_exception, std::rethrow_exception */
+#include <memory> /* std::unique_ptr */
+#include <mutex> /* std::mutex, std::lock_guard, std::unique_lock */
+#include <optional> /* std::optional */
+#include <thread> /* std::thread, std::this_thread::yield */
+#include <type_traits> /* std::invoke_result_t, std::decay_t */
+#include <utility> /* std::move, std::forward */
+#include <vector> /* std::vector */
+
+#include "impl/work_deque.hpp"
+#include "trace.hpp"
+
+namespace crim {
+    class thread_pool;
+
+    template<class T>
+    class task_handle;
+};
+
+namespace crim::impl {
+    struct pool_task;
+
+    template<class T>
+    struct task_result;
+
+    template<class Fn>
+    struct pool_task_impl;
+};
+
+/**
+ * BEGIN: TASKS -*--------------------------------------------------------------
+ */
+
+/**
+ * @brief   One unit of work, type-erased so every deque can hold any of them.
+ *          Shared between the pool and (maybe) a `crim::task_handle`, so it
+ *          counts its owners and deletes itself when the last one lets go.
+ */
+struct crim::impl::pool_task {
+    std::atomic<int> refs;
+    std::atomic<bool> done;
+    void (*run_fn)(pool_task *p_self); // Must not throw, see `pool_task_impl`.
+    void (*destroy_fn)(pool_task *p_self);
+
+    pool_task(void (*p_run)(pool_task *), void (*p_destroy)(pool_task *), int n_refs)
+        : refs{n_refs}
+        , done{false}
+        , run_fn{p_run}
+        , destroy_fn{p_destroy}
+    {}
+
+    void run() noexcept {
+        run_fn(this);
+        done.store(true, std::memory_order_release);
+    }
+
+    void release() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            destroy_fn(this);
+        }
+    }
+};
+
+// Where a task's return value (or exception) waits for `get()`.
+template<class T>
+struct crim::impl::task_result {
+    std::optional<T> value;
+    std::exception_ptr error;
+
+    template<class Fn>
+    void store(Fn &fn) {
+        value.emplace(fn());
+    }
+
+    T take() {
+        return std::move(*value);
+    }
+};
+
+template<>
+struct crim::impl::task_result<void> {
+    std::exception_ptr error;
+
+    template<class Fn>
+    void store(Fn &fn) {
+        fn();
+    }
+
+    void take() {}
+};
+
+template<class Fn>
+struct crim::impl::pool_task_impl : crim::impl::pool_task {
+    using result_type = std::invoke_result_t<Fn &>;
+
+    Fn fn;
+    task_result<result_type> result;
+
+    pool_task_impl(Fn &&f, int n_refs) : pool_task(run_impl, destroy_impl, n_refs), fn{std::move(f)} {}
+
+    // Exceptions are caught here and rethrown by `get()`, like `std::future`.
+    static void run_impl(pool_task *p_self) {
+        auto *p_task = static_cast<pool_task_impl *>(p_self);
+        try {
+            p_task->result.store(p_task->fn);
+        } catch (...) {
+            p_task->result.error = std::current_exception();
+        }
+    }
+
+    static void destroy_impl(pool_task *p_self) {
+        delete static_cast<pool_task_impl *>(p_self);
+    }
+};
+
+/**
+ * END: TASKS -*----------------------------------------------------------------
+ */
+
+/**
+ * BEGIN: THREAD POOL -*--------------------------------------------------------
+ */
+
+/**
+ * @brief   Fixed set of worker threads, each with its own Chase-Lev deque.
+ *
+ *          Tasks submitted from a worker go on that worker's own deque, so
+ *          recursive fork-join code stays on one core until someone's idle.
+ *          Tasks from any other thread go on a shared queue. Idle workers
+ *          first check their own deque, then the shared queue, then steal
+ *          from a random victim, and only then go to sleep.
+ *
+ *          Waiting on a `task_handle` or a `parallel_for` doesn't block: the
+ *          waiting thread runs other tasks in the meantime. So it's fine to
+ *          wait from inside a task, it won't deadlock the pool.
+ *
+ * @note    The destructor finishes every task that was already submitted.
+ */
+class crim::thread_pool {
+public:
+    using size_type = std::size_t;
+    using task_type = impl::pool_task;
+
+private:
+    struct worker {
+        impl::work_deque<task_type> deque;
+        std::uint64_t n_rng; // Picks steal victims, see `next_victim()`.
+        std::thread thread;
+    };
+
+    // Which pool and worker the current thread is, if any.
+    struct worker_id {
+        thread_pool *p_pool;
+        size_type n_index;
+    };
+
+    static inline thread_local worker_id tl_self = {nullptr, 0};
+
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    std::mutex m_injectlock; // Guards `m_inject`.
+    std::deque<task_type *> m_inject; // Tasks from threads outside the pool.
+
+    std::atomic<size_type> m_npending; // Submitted but not yet picked up.
+    std::atomic<size_type> m_nrunning; // Picked up but not finished.
+    std::atomic<size_type> m_nsleeping;
+    std::mutex m_sleeplock;
+    std::condition_variable m_wakeup;
+    std::atomic<bool> m_bstop;
+
+public:
+    /**
+     * @brief   Starts `n_threads` workers, or one per core if that's 0.
+     */
+    explicit thread_pool(size_type n_threads = 0)
+        : m_npending{0}
+        , m_nrunning{0}
+        , m_nsleeping{0}
+        , m_bstop{false}
+    {
+        if (n_threads == 0) {
+            n_threads = std::thread::hardware_concurrency();
+        }
+        n_threads = (n_threads == 0) ? 1 : n_threads;
+        for (size_type i = 0; i < n_threads; i++) {
+            m_workers.emplace_back(new worker());
+            m_workers.back()->n_rng = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        // Only start once every deque exists, since they steal from each other.
+        for (size_type i = 0; i < n_threads; i++) {
+            m_workers[i]->thread = std::thread(&thread_pool::worker_main, this, i);
+        }
+    }
+
+    thread_pool(const thread_pool &other) = delete;
+    thread_pool &operator=(const thread_pool &other) = delete;
+
+    ~thread_pool() {
+        wait_idle();
+        {
+            std::lock_guard<std::mutex> guard(m_sleeplock);
+            m_bstop.store(true);
+        }
+        m_wakeup.notify_all();
+        for (auto &p_worker : m_workers) {
+            p_worker->thread.join();
+        }
+    }
+
+    /* -*- SUBMITTING WORK -*- */
+
+    /**
+     * @brief   Runs `fn()` on the pool at some point.
+     *
+     * @return  A handle to wait on and get the result from. It's fine to drop
+     *          it, the task still runs, but you then have no way of knowing when.
+     */
+    template<class Fn>
+    auto submit(Fn &&fn) -> task_handle<std::invoke_result_t<std::decay_t<Fn> &>> {
+        using impl_type = impl::pool_task_impl<std::decay_t<Fn>>;
+        // One reference for us until it has run, one for the handle.
+        auto *p_task = new impl_type(std::decay_t<Fn>(std::forward<Fn>(fn)), 2);
+        enqueue(p_task);
+        return task_handle<std::invoke_result_t<std::decay_t<Fn> &>>(this, p_task);
+    }
+
+    /**
+     * @brief   Calls `fn(i)` for every `i` in `[n_begin, n_end)`, spread over
+     *          the pool, and returns once they've all finished.
+     *
+     *          The range is halved over and over, each half becoming its own
+     *          task, until pieces are `n_grain` long. Idle workers steal the
+     *          biggest remaining halves, so uneven work still evens out.
+     *
+     * @param n_grain   Smallest piece worth its own task. With 0 we pick one
+     *                  so each worker gets about 8 pieces, which is usually
+     *                  plenty to balance without the tasks costing anything.
+     *
+     * @exception   Rethrows the first exception thrown by `fn`, once every
+     *              other piece is done. Pieces that haven't started yet are
+     *              skipped.
+     */
+    template<class Fn>
+    void parallel_for(size_type n_begin, size_type n_end, Fn fn, size_type n_grain = 0) {
+        if (n_begin >= n_end) {
+            return;
+        }
+        size_type n_count = n_end - n_begin;
+        if (n_grain == 0) {
+            size_type n_pieces = size() * 8;
+            n_grain = (n_count + n_pieces - 1) / n_pieces;
+        }
+        loop_state<Fn> state{fn, n_grain, {1}, {false}, nullptr};
+        split_range(state, n_begin, n_end);
+        wait_until([&state]() {
+            return state.n_remaining.load(std::memory_order_acquire) == 0;
+        });
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    }
+
+    /**
+     * @brief   Blocks until nothing is queued or running that we know of.
+     *          Tasks submitted meanwhile by other threads count too.
+     */
+    void wait_idle() {
+        wait_until([this]() {
+            // `m_npending` first, see `execute()`.
+            return m_npending.load(std::memory_order_seq_cst) == 0 && m_nrunning.load(std::memory_order_seq_cst) == 0;
+        });
+    }
+
+    /* -*- DATA ACCESS METHODS -*- */
+
+    size_type size() const noexcept {
+        return m_workers.size();
+    }
+
+    /**
+     * @brief   Index of the calling thread in this pool, or `size()` if it's
+     *          not one of our workers.
+     */
+    size_type current_worker() const noexcept {
+        return (tl_self.p_pool == this) ? tl_self.n_index : size();
+    }
+
+    /**
+     * @brief   Runs one queued task on the calling thread, if there is one.
+     *          This is how waiting threads make themselves useful.
+     */
+    bool run_one() {
+        task_type *p_task = find_task();
+        if (p_task == nullptr) {
+            return false;
+        }
+        execute(p_task);
+        return true;
+    }
+
+    /**
+     * @brief   Runs other tasks until `done()` is true, so waiting on work we
+     *          submitted never ties up a thread the pool could use.
+     */
+    template<class Predicate>
+    void wait_until(Predicate done) {
+        size_type n_idle = 0;
+        while (!done()) {
+            if (run_one()) {
+                n_idle = 0;
+            } else if (++n_idle > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    // Shared by every piece of one `parallel_for`, which lives on its stack.
+    template<class Fn>
+    struct loop_state {
+        Fn &fn;
+        size_type n_grain;
+        std::atomic<size_type> n_remaining; // Pieces not finished yet.
+        std::atomic<bool> b_failed;
+        std::exception_ptr error; // Only written by whoever set `b_failed`.
+    };
+
+    /**
+     * @brief   Hands off the upper halves of `[n_begin, n_end)` as tasks until
+     *          what's left is one grain, then runs that here.
+     */
+    template<class Fn>
+    void split_range(loop_state<Fn> &state, size_type n_begin, size_type n_end) {
+        while (n_end - n_begin > state.n_grain) {
+            size_type n_middle = n_begin + (n_end - n_begin) / 2;
+            state.n_remaining.fetch_add(1, std::memory_order_relaxed);
+            auto half = [this, &state, n_middle, n_end]() {
+                split_range(state, n_middle, n_end);
+            };
+            using impl_type = impl::pool_task_impl<decltype(half)>;
+            // Nobody holds a handle to these, the pool is the only owner.
+            enqueue(new impl_type(std::move(half), 1));
+            n_end = n_middle;
+        }
+        if (!state.b_failed.load(std::memory_order_relaxed)) {
+            try {
+                for (size_type i = n_begin; i < n_end; i++) {
+                    state.fn(i);
+                }
+            } catch (...) {
+                if (!state.b_failed.exchange(true)) {
+                    state.error = std::current_exception();
+                }
+            }
+        }
+        state.n_remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void enqueue(task_type *p_task) {
+        // Count it before anyone can see it, or a thief could run it and
+        // decrement first, wrapping the counter around for a moment.
+        m_npending.fetch_add(1, std::memory_order_seq_cst);
+        if (tl_self.p_pool == this) {
+            m_workers[tl_self.n_index]->deque.push(p_task);
+        } else {
+            std::lock_guard<std::mutex> guard(m_injectlock);
+            m_inject.push_back(p_task);
+        }
+        // Pairs with the check in `worker_main()`: one of us sees the other.
+        if (m_nsleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> guard(m_sleeplock);
+            m_wakeup.notify_one();
+        }
+    }
+
+    void execute(task_type *p_task) {
+        // Both `seq_cst`, so whoever sees the task leave `m_npending` in
+        // `wait_idle()` also sees it in `m_nrunning`, not just on x86.
+        m_nrunning.fetch_add(1, std::memory_order_seq_cst);
+        m_npending.fetch_sub(1, std::memory_order_seq_cst);
+        p_task->run();
+        p_task->release();
+        m_nrunning.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Own deque, then the shared queue, then everybody else's deques.
+    task_type *find_task() {
+        size_type n_self = current_worker();
+        if (n_self < size()) {
+            task_type *p_task = m_workers[n_self]->deque.pop();
+            if (p_task != nullptr) {
+                return p_task;
+            }
+        }
+        if (m_npending.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> guard(m_injectlock);
+            if (!m_inject.empty()) {
+                task_type *p_task = m_inject.front();
+                m_inject.pop_front();
+                return p_task;
+            }
+        }
+        size_type n_start = next_victim(n_self);
+        for (size_type i = 0; i < size(); i++) {
+            size_type n_victim = (n_start + i) % size();
+            if (n_victim == n_self) {
+                continue;
+            }
+            task_type *p_task = m_workers[n_victim]->deque.steal();
+            if (p_task != nullptr) {
+                return p_task;
+            }
+        }
+        return nullptr;
+    }
+
+    // xorshift64 per worker, so we don't all pile onto the same victim.
+    size_type next_victim(size_type n_self) {
+        if (n_self >= size()) {
+            return 0;
+        }
+        std::uint64_t &n_rng = m_workers[n_self]->n_rng;
+        n_rng ^= n_rng << 13;
+        n_rng ^= n_rng >> 7;
+        n_rng ^= n_rng << 17;
+        return static_cast<size_type>(n_rng % size());
+    }
+
+    void worker_main(size_type n_index) {
+        tl_self = worker_id{this, n_index};
+        crim_trace_thread_name("crim::thread_pool worker");
+        size_type n_idle = 0;
+        for (;;) {
+            if (run_one()) {
+                n_idle = 0;
+                continue;
+            }
+            // Spin a little first, new work often shows up right away.
+            if (++n_idle < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleeplock);
+            m_nsleeping.fetch_add(1, std::memory_order_seq_cst);
+            m_wakeup.wait(lock, [this]() {
+                return m_npending.load(std::memory_order_seq_cst) > 0 || m_bstop.load();
+            });
+            m_nsleeping.fetch_sub(1, std::memory_order_relaxed);
+            if (m_bstop.load() && m_npending.load() == 0) {
+                break;
+            }
+            n_idle = 0;
+        }
+        tl_self = worker_id{nullptr, 0};
+    }
+};
+
+/**
+ * @brief   What `crim::thread_pool::submit` gives back, a bit like a
+ *          `std::future`. Move-only, and `get()` can only be called once.
+ */
+template<class T>
+class crim::task_handle {
+private:
+    using task_type = impl::pool_task;
+    using result_type = impl::task_result<T>;
+
+    thread_pool *m_ppool;
+    task_type *m_ptask;
+    result_type *m_presult; // Lives inside `*m_ptask`.
+
+public:
+    task_handle() noexcept : m_ppool{nullptr}, m_ptask{nullptr}, m_presult{nullptr} {}
+
+    template<class ImplT>
+    task_handle(thread_pool *p_pool, ImplT *p_task) noexcept
+        : m_ppool{p_pool}
+        , m_ptask{p_task}
+        , m_presult{&p_task->result}
+    {}
+
+    task_handle(const task_handle &other) = delete;
+    task_handle &operator=(const task_handle &other) = delete;
+
+    task_handle(task_handle &&other) noexcept : task_handle() {
+        swap(other);
+    }
+
+    task_handle &operator=(task_handle &&other) noexcept {
+        if (this != &other) {
+            reset();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~task_handle() {
+        reset();
+    }
+
+    // Whether we still refer to a task, i.e. `get()` hasn't been called.
+    bool valid() const noexcept {
+        return m_ptask != nullptr;
+    }
+
+    bool ready() const noexcept {
+        return m_ptask != nullptr && m_ptask->done.load(std::memory_order_acquire);
+    }
+
+    // Runs other tasks from the pool until ours is done.
+    void wait() {
+        m_ppool->wait_until([this]() {
+            return ready();
+        });
+    }
+
+    /**
+     * @brief   Waits, then hands over the result and lets go of the task.
+     *
+     * @exception   Whatever the task threw, if it did.
+     */
+    T get() {
+        wait();
+        task_handle keep_alive(std::move(*this));
+        if (keep_alive.m_presult->error) {
+            std::rethrow_exception(keep_alive.m_presult->error);
+        }
+        return keep_alive.m_presult->take();
+    }
+
+private:
+    void reset() noexcept {
+        if (m_ptask != nullptr) {
+            m_ptask->release();
+        }
+        m_ppool = nullptr;
+        m_ptask = nullptr;
+        m_presult = nullptr;
+    }
+
+    void swap(task_handle &other) noexcept {
+        std::swap(m_ppool, other.m_ppool);
+        std::swap(m_ptask, other.m_ptask);
+        std::swap(m_presult, other.m_presult);
+    }
+};
+
+/**
+ * END: THREAD POOL -*----------------------------------------------------------
+ */
@@ -0,0 +1,390 @@
+#pragma once
+
+#include "logerror.hpp"
+
+/**
+ * Define this before including us to have `crim_trace_scope()` record how
+ * long every scope took, on every thread, and write it all out at exit as
+ * Chrome trace event JSON. Open it in `chrome://tracing` or ui.perfetto.dev.
+ *
+ * It goes to `crim_trace.json` in the current directory, or wherever the
+ * `CRIM_TRACE_FILE` environment variable says.
+ *
+ * Without it `crim_trace_scope()` and `crim_trace_thread_name()` are nothing
+ * at all, so you can leave them in your code for free.
+ */
+#if defined(CRIM_TRACE)
+
+#include <atomic> /* std::atomic */
+#include <chrono> /* std::chrono::steady_clock */
+#include <cstddef> /* std::size_t */
+#include <cstdint> /* std::uint32_t, std::uint64_t */
+#include <cstdio> /* std::FILE, std::fopen, std::fprintf */
+#include <cstdlib> /* std::atexit, std::getenv, std::malloc */
+#include <cstring> /* std::memset */
+#include <new> /* std::bad_alloc */
+
+// Windows has no `mmap`, so blocks just come from `std::malloc` there.
+#if !defined(_WIN32)
+#include <sys/mman.h> /* mmap, MAP_POPULATE */
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CRIM_TRACE_USE_TSC
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> /* __rdtsc */
+#else
+#include <x86intrin.h> /* __rdtsc */
+#endif
+#endif
+
+#define crim_logerror(func, info) \
+    crim_logerror_nofunc("crim::tracer", func, info)
+
+namespace crim {
+    struct trace_site;
+
+    class tracer;
+
+    class trace_zone;
+};
+
+/**
+ * @brief   Times everything from here to the end of the enclosing scope as 1
+ *          zone called `name`, which must be a string literal. Zones nest.
+ *
+ * @note    The zone also remembers its `__FILE__` and `__LINE__`, using the
+ *          same literal as `crim_loginfo`, so nothing is formatted until exit.
+ */
+#define crim_trace_scope(name)                                                 \
+    static constexpr crim::trace_site crim_concat(crim_trace_site_, __LINE__){ \
+        name, crim_loginfo(__LINE__)                                           \
+    };                                                                         \
+    crim::trace_zone crim_concat(crim_trace_zone_, __LINE__){                  \
+        crim_concat(crim_trace_site_, __LINE__)                                \
+    }
+
+/**
+ * @brief   Shows this thread as `name` instead of a number. `name` must live
+ *          until exit, e.g. a string literal.
+ */
+#define crim_trace_thread_name(name) \
+    crim::tracer::set_thread_name(name)
+
+/**
+ * BEGIN: TRACER IMPLEMENTATION -*----------------------------------------------
+ */
+
+// Where a zone is, made once per `crim_trace_scope()` at compile time.
+struct crim::trace_site {
+    const char *name;
+    const char *site; // e.g. `"crim/parallel_lines.hpp:116"`.
+};
+
+/**
+ * @brief   Every thread appends finished zones to its own log, a list of big
+ *          blocks that are never moved or freed. Nobody else ever writes to
+ *          it, so there are no locks, only a release store of the count that
+ *          lets the exit handler see the zones up to there.
+ *
+ *          Timestamps come from the CPU's timestamp counter where there is
+ *          one, which is a lot cheaper than `steady_clock`, and are turned
+ *          into microseconds only when writing the JSON.
+ *
+ * @note    Logs outlive their threads, so zones from threads that already
+ *          finished still make it into the trace.
+ */
+class crim::tracer {
+public:
+    // Kept small, since every page of these has to be mapped in.
+    struct event {
+        const trace_site *site;
+        std::uint64_t begin; // In ticks, see `now()`.
+        std::uint64_t end;
+    };
+
+    static std::uint64_t now() noexcept
+    {
+#if defined(CRIM_TRACE_USE_TSC)
+        // No fences, we want cheap more than we want exact to the cycle.
+        return __rdtsc();
+#else
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Adds a finished zone to this thread's log.
+    static void record(const trace_site &site, std::uint64_t n_begin, std::uint64_t n_end)
+    {
+        thread_log *p_log = local();
+        if (p_log == nullptr) {
+            p_log = new_log();
+        }
+        block *p_block = p_log->last;
+        std::size_t n_count = p_block->count.load(std::memory_order_relaxed);
+        if (n_count == block::capacity) {
+            p_block = grow(p_log);
+            n_count = 0;
+        }
+        p_block->events[n_count] = event{&site, n_begin, n_end};
+        p_block->count.store(n_count + 1, std::memory_order_release);
+    }
+
+    static void set_thread_name(const char *name)
+    {
+        thread_log *p_log = local();
+        if (p_log == nullptr) {
+            p_log = new_log();
+        }
+        p_log->name.store(name, std::memory_order_release);
+    }
+
+    /**
+     * @brief   Writes every zone recorded so far, from every thread, to `path`
+     *          as Chrome trace event JSON. Called for you at exit.
+     *
+     * @return  How many events were written, zones and thread names, or -1 if
+     *          `path` couldn't be opened.
+     */
+    static long write(const char *path)
+    {
+        std::FILE *p_file = std::fopen(path, "w");
+        if (p_file == nullptr) {
+            crim_logerror("write", "Could not open the trace file!");
+            return -1;
+        }
+        // Zones can start before the first log exists, so start from the
+        // earliest one instead.
+        std::uint64_t n_start = ~std::uint64_t(0);
+        for_each_event([&n_start](const thread_log &, const event &e) {
+            n_start = (e.begin < n_start) ? e.begin : n_start;
+        });
+        double n_usperticks = microseconds_per_tick();
+
+        long n_events = 0;
+        std::fprintf(p_file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        for (thread_log *p_log = logs().load(std::memory_order_acquire); p_log != nullptr; p_log = p_log->next) {
+            const char *name = p_log->name.load(std::memory_order_acquire);
+            if (name != nullptr) {
+                std::fprintf(p_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                    (n_events++ == 0) ? "" : ",\n", p_log->tid);
+                write_string(p_file, name);
+                std::fprintf(p_file, "}}");
+            }
+        }
+        for_each_event([&](const thread_log &log, const event &e) {
+            std::fprintf(p_file, "%s{\"name\":", (n_events++ == 0) ? "" : ",\n");
+            write_string(p_file, e.site->name);
+            std::fprintf(p_file, ",\"cat\":\"crim\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"site\":",
+                log.tid, static_cast<double>(e.begin - n_start) * n_usperticks,
+                static_cast<double>(e.end - e.begin) * n_usperticks);
+            write_string(p_file, e.site->site);
+            std::fprintf(p_file, "}}");
+        });
+        std::fprintf(p_file, "\n]}\n");
+        std::fclose(p_file);
+        return n_events;
+    }
+
+private:
+    struct block {
+        static constexpr std::size_t capacity = 8192; // 192K of zones, so don't trace every line.
+
+        std::atomic<std::size_t> count; // Only the owning thread writes this.
+        std::atomic<block *> next;
+        event events[capacity];
+    };
+
+    struct thread_log {
+        thread_log *next; // Next in the list of every log.
+        std::uint32_t tid;
+        std::atomic<const char *> name;
+        block *first;
+        block *last; // Only the owning thread looks at this.
+    };
+
+    // When the first log was made, to know how fast `now()` ticks at exit.
+    struct epoch {
+        std::uint64_t ticks;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    static thread_log *&local() noexcept
+    {
+        static thread_local thread_log *p_log = nullptr;
+        return p_log;
+    }
+
+    static std::atomic<thread_log *> &logs() noexcept
+    {
+        static std::atomic<thread_log *> head{nullptr};
+        return head;
+    }
+
+    static const epoch &start() noexcept
+    {
+        static const epoch e{now(), std::chrono::steady_clock::now()};
+        return e;
+    }
+
+    template<class Callback>
+    static void for_each_event(Callback on_event)
+    {
+        for (thread_log *p_log = logs().load(std::memory_order_acquire); p_log != nullptr; p_log = p_log->next) {
+            for (block *p_block = p_log->first; p_block != nullptr; p_block = p_block->next.load(std::memory_order_acquire)) {
+                std::size_t n_count = p_block->count.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < n_count; i++) {
+                    on_event(*p_log, p_block->events[i]);
+                }
+            }
+        }
+    }
+
+    static double microseconds_per_tick()
+    {
+#if defined(CRIM_TRACE_USE_TSC)
+        // Too short a run can't tell us much, so give it at least 10 ms.
+        const epoch &e = start();
+        using clock = std::chrono::steady_clock;
+        while (clock::now() - e.time < std::chrono::milliseconds(10)) {
+            // Spin.
+        }
+        std::uint64_t n_ticks = now() - e.ticks;
+        std::chrono::duration<double, std::micro> elapsed = clock::now() - e.time;
+        return elapsed.count() / static_cast<double>(n_ticks);
+#else
+        return 1e-3;
+#endif
+    }
+
+    static void write_string(std::FILE *p_file, const char *text)
+    {
+        std::fputc('"', p_file);
+        for (const char *p_iter = text; *p_iter != '\0'; p_iter++) {
+            unsigned char ch = static_cast<unsigned char>(*p_iter);
+            if (ch == '"' || ch == '\\') {
+                std::fputc('\\', p_file);
+                std::fputc(ch, p_file);
+            } else if (ch < 0x20) {
+                std::fprintf(p_file, "\\u%04x", ch);
+            } else {
+                std::fputc(ch, p_file);
+            }
+        }
+        std::fputc('"', p_file);
+    }
+
+    /**
+     * @brief   Every page of the block is already faulted in, so `record()`
+     *          never takes a page fault halfway through a zone. On Linux the
+     *          kernel maps them all in one go, which is cheaper than touching
+     *          them one at a time like we do everywhere else.
+     */
+    static block *new_block()
+    {
+#if defined(_WIN32)
+        void *p_memory = std::malloc(sizeof(block));
+#else
+#if defined(MAP_POPULATE)
+        constexpr int n_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE;
+#else
+        constexpr int n_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+        void *p_memory = mmap(nullptr, sizeof(block), PROT_READ | PROT_WRITE, n_flags, -1, 0);
+        p_memory = (p_memory == MAP_FAILED) ? nullptr : p_memory;
+#endif
+        if (p_memory == nullptr) {
+            crim_logerror("new_block", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        block *p_block = static_cast<block *>(p_memory);
+#if defined(_WIN32) || !defined(MAP_POPULATE)
+        std::memset(p_block->events, 0, sizeof(p_block->events));
+#endif
+        p_block->count.store(0, std::memory_order_relaxed);
+        p_block->next.store(nullptr, std::memory_order_relaxed);
+        return p_block;
+    }
+
+    // Slow paths, kept out of line so `record()` stays small.
+    [[gnu::noinline]] static block *grow(thread_log *p_log)
+    {
+        block *p_block = new_block();
+        p_log->last->next.store(p_block, std::memory_order_release);
+        p_log->last = p_block;
+        return p_block;
+    }
+
+    [[gnu::noinline]] static thread_log *new_log()
+    {
+        static std::atomic<std::uint32_t> next_tid{0};
+        static const bool b_registered = (std::atexit(write_at_exit) == 0);
+        (void)b_registered;
+        start();
+
+        block *p_block = new_block();
+        thread_log *p_log = static_cast<thread_log *>(std::malloc(sizeof(thread_log)));
+        if (p_log == nullptr) {
+            crim_logerror("new_log", "Failed to allocate memory!");
+            throw std::bad_alloc();
+        }
+        p_log->tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+        p_log->name.store(nullptr, std::memory_order_relaxed);
+        p_log->first = p_block;
+        p_log->last = p_block;
+        p_log->next = logs().load(std::memory_order_relaxed);
+        while (!logs().compare_exchange_weak(p_log->next, p_log, std::memory_order_release, std::memory_order_relaxed)) {
+            // `p_log->next` was reloaded for us, try again.
+        }
+        local() = p_log;
+        return p_log;
+    }
+
+    static void write_at_exit()
+    {
+        const char *path = std::getenv("CRIM_TRACE_FILE");
+        path = (path != nullptr && *path != '\0') ? path : "crim_trace.json";
+        long n_events = write(path);
+        if (n_events >= 0) {
+            std::fprintf(stderr, "crim::tracer: wrote %ld events to %s\n", n_events, path);
+        }
+    }
+};
+
+/**
+ * @brief   What `crim_trace_scope()` declares. Reads the clock when it's made
+ *          and again when it's destroyed, then hands both to `crim::tracer`.
+ */
+class crim::trace_zone {
+private:
+    const trace_site &m_site;
+    std::uint64_t m_nbegin;
+
+public:
+    explicit trace_zone(const trace_site &site) noexcept
+        : m_site{site}
+        , m_nbegin{tracer::now()}
+    {}
+
+    trace_zone(const trace_zone &) = delete;
+    trace_zone &operator=(const trace_zone &) = delete;
+
+    ~trace_zone()
+    {
+        tracer::record(m_site, m_nbegin, tracer::now());
+    }
+};
+
+/**
+ * END: TRACER IMPLEMENTATION -*------------------------------------------------
+ */
+
+#undef crim_logerror
+
+#else
+
+#define crim_trace_scope(name) static_cast<void>(0)
+#define crim_trace_thread_name(name) static_cast<void>(0)
+
+#endif
@@ -0,0 +1,510 @@
+#pragma once
+
+#include <cstddef> /* std::size_t */
+#include <memory> /* std::allocator_traits */
+#include <type_traits> /* std::enable_if_t */
+
+#include "logerror.hpp"
+#include "memory.tcc"
+
+/**
+ * Define this before including us to have `crim::tracking_allocator` count
+ * everything its inner allocator does, per call site, and print it all to
+ * `stderr` when the program exits.
+ *
+ * Without it `crim::tracking_allocator<Inner>` is just another name for
+ * `Inner` and `crim_track_allocations()` is nothing at all, so you can leave
+ * both in your code for free.
+ */
+#if defined(CRIM_TRACK_ALLOCATIONS)
+#include <algorithm> /* std::sort */
+#include <atomic> /* std::atomic */
+#include <chrono> /* std::chrono::steady_clock */
+#include <cstdio> /* std::FILE, std::fprintf */
+#include <cstdlib> /* std::atexit */
+#include <mutex> /* std::mutex, std::lock_guard */
+#include <unordered_map> /* std::unordered_map */
+#include <vector> /* std::vector */
+
+#include "bitmanip.hpp"
+#endif
+
+namespace crim {
+#if defined(CRIM_TRACK_ALLOCATIONS)
+    class alloc_site;
+
+    class alloc_scope;
+
+    template<class Inner>
+    struct tracking_allocator;
+#else
+    template<class Inner>
+    using tracking_allocator = Inner;
+#endif
+};
+
+#if defined(CRIM_TRACK_ALLOCATIONS)
+
+/**
+ * @brief   Every `crim::tracking_allocator` call made from here until the end
+ *          of the enclosing scope is put down to this line, e.g.
+ *          `"2023/01-trebuchet/cpp/part1.cpp:42"`. Scopes nest, the innermost
+ *          one wins.
+ *
+ * @note    Uses the same `__FILE__` and `__LINE__` literal as `crim_loginfo`,
+ *          so a call site costs 1 static object and nothing is formatted.
+ */
+#define crim_track_allocations()                                               \
+    static crim::alloc_site crim_concat(crim_alloc_site_, __LINE__){           \
+        crim_loginfo(__LINE__)                                                 \
+    };                                                                         \
+    crim::alloc_scope crim_concat(crim_alloc_scope_, __LINE__){                \
+        crim_concat(crim_alloc_site_, __LINE__)                                \
+    }
+
+/**
+ * BEGIN: ALLOCATION SITE IMPLEMENTATION -*-------------------------------------
+ */
+
+/**
+ * @brief   Counters for everything allocated from 1 call site, no matter which
+ *          thread or which `crim::tracking_allocator` did it. Every site ever
+ *          constructed is kept in a process-wide list for `report()`.
+ *
+ *          Memory is always put down to the site that allocated it, even if
+ *          it's freed or grown from somewhere else, so what's still live at
+ *          exit tells you where your leaks came from.
+ *
+ * @note    Trivially destructible, so it's still fine to use from static
+ *          destructors and from the report at exit.
+ */
+class crim::alloc_site {
+public:
+    // Bucket `i` counts requests of `2^(i - 1) + 1` up to `2^i` bytes.
+    static constexpr std::size_t n_buckets = 8 * sizeof(std::size_t) + 1;
+
+    struct stats {
+        const char *name;
+        std::size_t allocs; // Calls to `allocate()`.
+        std::size_t frees; // Calls to `deallocate()`.
+        std::size_t reallocs; // Calls to `reallocate()`, if the allocator has one.
+        std::size_t bytes; // Total of every request, including new sizes from `reallocate()`.
+        std::size_t live; // Allocated but not yet freed.
+        std::size_t peak; // Most that was ever live at once.
+        std::size_t nanoseconds; // Spent inside the inner allocator.
+        std::size_t histogram[n_buckets]; // Request sizes, see `n_buckets`.
+    };
+
+    explicit alloc_site(const char *p_name) noexcept
+        : m_pname{p_name}
+        , m_pnext{nullptr}
+        , m_nallocs{0}
+        , m_nfrees{0}
+        , m_nreallocs{0}
+        , m_nbytes{0}
+        , m_nlive{0}
+        , m_npeak{0}
+        , m_nnanoseconds{0}
+        , m_histogram{}
+    {
+        std::atomic<alloc_site *> &head = sites();
+        m_pnext = head.load();
+        while (!head.compare_exchange_weak(m_pnext, this)) {
+            // `m_pnext` was reloaded for us, try again.
+        }
+    }
+
+    alloc_site(const alloc_site &) = delete;
+    alloc_site &operator=(const alloc_site &) = delete;
+
+    /**
+     * @brief   The innermost `crim_track_allocations()` on this thread, or the
+     *          catch-all site if there isn't one.
+     */
+    static alloc_site &current() noexcept
+    {
+        alloc_site *p_site = innermost();
+        return (p_site != nullptr) ? *p_site : unattributed();
+    }
+
+    void on_allocate(std::size_t n_bytes, std::size_t n_nanoseconds) noexcept
+    {
+        m_nallocs.fetch_add(1, std::memory_order_relaxed);
+        add_request(n_bytes, n_nanoseconds);
+        add_live(n_bytes);
+    }
+
+    void on_deallocate(std::size_t n_bytes, std::size_t n_nanoseconds) noexcept
+    {
+        m_nfrees.fetch_add(1, std::memory_order_relaxed);
+        m_nnanoseconds.fetch_add(n_nanoseconds, std::memory_order_relaxed);
+        m_nlive.fetch_sub(n_bytes, std::memory_order_relaxed);
+    }
+
+    void on_reallocate(std::size_t n_oldbytes, std::size_t n_newbytes, std::size_t n_nanoseconds) noexcept
+    {
+        m_nreallocs.fetch_add(1, std::memory_order_relaxed);
+        add_request(n_newbytes, n_nanoseconds);
+        m_nlive.fetch_sub(n_oldbytes, std::memory_order_relaxed);
+        add_live(n_newbytes);
+    }
+
+    stats get_stats() const noexcept
+    {
+        stats s{
+            m_pname, m_nallocs.load(), m_nfrees.load(), m_nreallocs.load(), m_nbytes.load(),
+            m_nlive.load(), m_npeak.load(), m_nnanoseconds.load(), {}
+        };
+        for (std::size_t i = 0; i < n_buckets; i++) {
+            s.histogram[i] = m_histogram[i].load();
+        }
+        return s;
+    }
+
+    /**
+     * @brief   Every site that allocated anything, most bytes first, each with
+     *          the sizes it asked for. Called for you at exit.
+     */
+    static void report(std::FILE *stream)
+    {
+        std::vector<stats> all;
+        stats total{"total", 0, 0, 0, 0, 0, 0, 0, {}};
+        for (alloc_site *p_site = sites().load(); p_site != nullptr; p_site = p_site->m_pnext) {
+            stats s = p_site->get_stats();
+            if (s.allocs + s.reallocs == 0) {
+                continue;
+            }
+            total.allocs += s.allocs;
+            total.frees += s.frees;
+            total.reallocs += s.reallocs;
+            total.bytes += s.bytes;
+            total.live += s.live;
+            total.nanoseconds += s.nanoseconds;
+            all.push_back(s);
+        }
+        std::sort(all.begin(), all.end(), [](const stats &lhs, const stats &rhs) {
+            return lhs.bytes > rhs.bytes;
+        });
+
+        std::fprintf(stream, "crim::tracking_allocator: %zu call sites, %.3f ms in the allocators\n",
+            all.size(), static_cast<double>(total.nanoseconds) / 1e6);
+        std::fprintf(stream, "%-40s %10s %10s %10s %14s %14s %14s %10s\n",
+            "site", "allocs", "frees", "reallocs", "bytes", "peak live", "live now", "ms");
+        for (const stats &s : all) {
+            std::fprintf(stream, "%-40s %10zu %10zu %10zu %14zu %14zu %14zu %10.3f\n",
+                s.name, s.allocs, s.frees, s.reallocs, s.bytes, s.peak, s.live,
+                static_cast<double>(s.nanoseconds) / 1e6);
+            std::fprintf(stream, "\tsizes:");
+            for (std::size_t i = 0; i < n_buckets; i++) {
+                if (s.histogram[i] != 0) {
+                    std::fprintf(stream, " <=2^%zu: %zu", i, s.histogram[i]);
+                }
+            }
+            std::fprintf(stream, "\n");
+        }
+        std::fprintf(stream, "%-40s %10zu %10zu %10zu %14zu %14s %14zu %10.3f\n",
+            total.name, total.allocs, total.frees, total.reallocs, total.bytes, "",
+            total.live, static_cast<double>(total.nanoseconds) / 1e6);
+    }
+
+private:
+    friend class crim::alloc_scope;
+
+    const char *m_pname;
+    alloc_site *m_pnext; // Next in the list of every site.
+    std::atomic<std::size_t> m_nallocs;
+    std::atomic<std::size_t> m_nfrees;
+    std::atomic<std::size_t> m_nreallocs;
+    std::atomic<std::size_t> m_nbytes;
+    std::atomic<std::size_t> m_nlive;
+    std::atomic<std::size_t> m_npeak;
+    std::atomic<std::size_t> m_nnanoseconds;
+    std::atomic<std::size_t> m_histogram[n_buckets];
+
+    // Newest first. The first site made also sets up the report at exit.
+    static std::atomic<alloc_site *> &sites() noexcept
+    {
+        static std::atomic<alloc_site *> head{nullptr};
+        return head;
+    }
+
+    static alloc_site *&innermost() noexcept
+    {
+        static thread_local alloc_site *p_innermost = nullptr;
+        return p_innermost;
+    }
+
+    static alloc_site &unattributed() noexcept
+    {
+        static alloc_site site{"(outside crim_track_allocations)"};
+        static const bool b_registered = (std::atexit(report_at_exit) == 0);
+        (void)b_registered;
+        return site;
+    }
+
+    static void report_at_exit()
+    {
+        report(stderr);
+    }
+
+    void add_request(std::size_t n_bytes, std::size_t n_nanoseconds) noexcept
+    {
+        m_nbytes.fetch_add(n_bytes, std::memory_order_relaxed);
+        m_nnanoseconds.fetch_add(n_nanoseconds, std::memory_order_relaxed);
+        std::size_t n_bucket = (n_bytes <= 1) ? 0 : crim::bit::length(n_bytes - 1);
+        m_histogram[n_bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void add_live(std::size_t n_bytes) noexcept
+    {
+        std::size_t n_live = m_nlive.fetch_add(n_bytes, std::memory_order_relaxed) + n_bytes;
+        std::size_t n_peak = m_npeak.load(std::memory_order_relaxed);
+        while (n_live > n_peak && !m_npeak.compare_exchange_weak(n_peak, n_live, std::memory_order_relaxed)) {
+            // `n_peak` was reloaded for us, try again.
+        }
+    }
+};
+
+/**
+ * @brief   Makes `site` the current one on this thread until we're destroyed.
+ *          Use `crim_track_allocations()` rather than making these yourself.
+ */
+class crim::alloc_scope {
+private:
+    alloc_site *m_pprevious;
+
+public:
+    explicit alloc_scope(alloc_site &site) noexcept
+        : m_pprevious{alloc_site::innermost()}
+    {
+        // Make sure the report at exit is set up before anything is counted.
+        alloc_site::unattributed();
+        alloc_site::innermost() = &site;
+    }
+
+    alloc_scope(const alloc_scope &) = delete;
+    alloc_scope &operator=(const alloc_scope &) = delete;
+
+    ~alloc_scope()
+    {
+        alloc_site::innermost() = m_pprevious;
+    }
+};
+
+/**
+ * END: ALLOCATION SITE IMPLEMENTATION -*---------------------------------------
+ */
+
+/**
+ * BEGIN: TRACKING ALLOCATOR IMPLEMENTATION -*----------------------------------
+ */
+
+/**
+ * @brief   Wraps another allocator, passing every call through unchanged while
+ *          counting it against the current `crim_track_allocations()` site.
+ *          The inner allocator sees exactly the same requests it would have
+ *          otherwise, so e.g. `crim::pool_allocator` still hands out slots.
+ *
+ *          Which site allocated what is kept in a side table keyed on the
+ *          pointer, so frees and growths go to the right site. That table
+ *          and the clock reads around every call are what tracking costs,
+ *          but only the inner allocator's own time is reported.
+ *
+ * @tparam  Inner   Any allocator. `reallocate()` is only there if it has one.
+ *
+ * @note    Same size as `Inner`, since we only inherit from it.
+ */
+template<class Inner>
+struct crim::tracking_allocator : private Inner {
+private:
+    using inner_traits = std::allocator_traits<Inner>;
+    using clock = std::chrono::steady_clock;
+
+public:
+    using value_type = typename inner_traits::value_type;
+    using size_type = std::size_t;
+    using propagate_on_container_copy_assignment = typename inner_traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment = typename inner_traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename inner_traits::propagate_on_container_swap;
+    using is_always_equal = typename inner_traits::is_always_equal;
+
+    template<class OtherT>
+    struct rebind {
+        using other = tracking_allocator<typename inner_traits::template rebind_alloc<OtherT>>;
+    };
+
+    /* -*- CONSTRUCTORS -*- */
+
+    tracking_allocator() = default;
+
+    explicit tracking_allocator(const Inner &inner)
+        : Inner(inner)
+    {}
+
+    // Converting copy-constructor, e.g. for `std::allocator_traits::rebind`.
+    template<class OtherInner>
+    tracking_allocator(const tracking_allocator<OtherInner> &other)
+        : Inner(other.inner())
+    {}
+
+    const Inner &inner() const noexcept
+    {
+        return *this;
+    }
+
+    size_type max_size() const noexcept
+    {
+        return inner_traits::max_size(inner());
+    }
+
+    /* -*- ALLOCATION -*- */
+
+    value_type *allocate(size_type n_count)
+    {
+        alloc_site &site = alloc_site::current();
+        clock::time_point start = clock::now();
+        value_type *p_memory = inner_traits::allocate(as_inner(), n_count);
+        std::size_t n_nanoseconds = elapsed(start);
+        if (p_memory != nullptr) {
+            owners().insert(p_memory, &site);
+        }
+        site.on_allocate(n_count * sizeof(value_type), n_nanoseconds);
+        return p_memory;
+    }
+
+    void deallocate(value_type *p_memory, size_type n_count) noexcept
+    {
+        alloc_site &site = owners().erase(p_memory);
+        clock::time_point start = clock::now();
+        inner_traits::deallocate(as_inner(), p_memory, n_count);
+        site.on_deallocate(n_count * sizeof(value_type), elapsed(start));
+    }
+
+    /**
+     * @brief   Only there if `Inner` has it, see `crim::has_reallocate`. Still
+     *          counted against whoever allocated `p_memory` in the first place.
+     */
+    template<class InnerT = Inner, class = std::enable_if_t<has_reallocate<InnerT>::value>>
+    value_type *reallocate(value_type *p_memory, size_type n_oldcount, size_type n_newcount)
+    {
+        if (p_memory == nullptr) {
+            return allocate(n_newcount);
+        }
+        alloc_site &site = owners().erase(p_memory);
+        clock::time_point start = clock::now();
+        value_type *p_newmemory;
+        try {
+            p_newmemory = as_inner().reallocate(p_memory, n_oldcount, n_newcount);
+        } catch (...) {
+            // `p_memory` is untouched, so it's still ours.
+            owners().insert(p_memory, &site);
+            throw;
+        }
+        std::size_t n_nanoseconds = elapsed(start);
+        if (p_newmemory != nullptr) {
+            owners().insert(p_newmemory, &site);
+        }
+        site.on_reallocate(n_oldcount * sizeof(value_type), n_newcount * sizeof(value_type), n_nanoseconds);
+        return p_newmemory;
+    }
+
+    /* -*- COMPARISON -*- */
+
+    // Equal when the inner allocators are. Friends so `std` containers find
+    // them through ADL.
+    template<class OtherInner>
+    friend bool operator==(const tracking_allocator &lhs, const tracking_allocator<OtherInner> &rhs) noexcept
+    {
+        return lhs.inner() == rhs.inner();
+    }
+
+    template<class OtherInner>
+    friend bool operator!=(const tracking_allocator &lhs, const tracking_allocator<OtherInner> &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    Inner &as_inner() noexcept
+    {
+        return *this;
+    }
+
+    static std::size_t elapsed(clock::time_point start) noexcept
+    {
+        return static_cast<std::size_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - start
+        ).count());
+    }
+
+    /**
+     * @brief   Who allocated each live pointer, split by pointer so threads
+     *          rarely wait on each other.
+     *
+     * @note    Leaked on purpose so frees from static destructors, which may
+     *          run after ours would have, still find it.
+     */
+    class owner_table {
+    private:
+        static constexpr std::size_t n_shards = 64;
+
+        struct shard {
+            std::mutex lock;
+            std::unordered_map<const void *, alloc_site *> owners;
+        };
+
+        shard m_shards[n_shards];
+
+        shard &shard_of(const void *p_memory) noexcept
+        {
+            // Low bits are mostly alignment, so mix the pointer a bit first.
+            std::size_t n_hash = reinterpret_cast<std::size_t>(p_memory);
+            n_hash ^= n_hash >> 17;
+            n_hash *= 0x9E3779B97F4A7C15ULL;
+            return m_shards[(n_hash >> 32) % n_shards];
+        }
+
+    public:
+        void insert(const void *p_memory, alloc_site *p_site)
+        {
+            shard &s = shard_of(p_memory);
+            std::lock_guard<std::mutex> guard(s.lock);
+            s.owners[p_memory] = p_site;
+        }
+
+        // Memory from before tracking started, e.g. a moved-in buffer, has no owner.
+        alloc_site &erase(const void *p_memory) noexcept
+        {
+            shard &s = shard_of(p_memory);
+            std::lock_guard<std::mutex> guard(s.lock);
+            auto it = s.owners.find(p_memory);
+            if (it == s.owners.end()) {
+                return alloc_site::current();
+            }
+            alloc_site *p_site = it->second;
+            s.owners.erase(it);
+            return *p_site;
+        }
+    };
+
+    static owner_table &owners()
+    {
+        static owner_table *p_table = new owner_table();
+        return *p_table;
+    }
+};
+
+// Nothing of our own to point at, so we move however `Inner` does.
+template<class Inner>
+struct crim::is_trivially_relocatable<crim::tracking_allocator<Inner>>
+    : crim::is_trivially_relocatable<Inner> {};
+
+/**
+ * END: TRACKING ALLOCATOR IMPLEMENTATION -*------------------------------------
+ */
+
+#else
+
+#define crim_track_allocations() static_cast<void>(0)
+
+#endif
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits> /* std::is_trivially_copyable */
+
 /**
  * @brief       `#pragma region` isn't recognized by GCC I think. 
  *              So ignore the pragma as it's not used at compile-time.
@@ -128,6 +130,36 @@ struct crim::remove_reference<T&&> {
  * END: remove_reference  -*----------------------------------------------------
  */
 
+/**
+ * BEGIN: is_trivially_relocatable -*-------------------------------------------
+ */
+
+namespace crim {
+    template<class T>
+    struct is_trivially_relocatable;
+};
+
+/**
+ * @brief   Whether moving a `T` to a new address then destroying the old one is
+ *          the same as just copying its bytes over, i.e. a `memcpy`/`realloc`.
+ *          Containers use this to grow their buffers without calling a single
+ *          move-constructor or destructor.
+ *
+ *          Trivially copyable types always are. Types that don't point into
+ *          themselves usually are too, e.g. `crim::cstring` and `crim::string`,
+ *          but they have to opt in by specializing this in their own headers.
+ *
+ * @warning Never opt in types that keep pointers to their own members! 
+ */
+template<class T>
+struct crim::is_trivially_relocatable 
+    : crim::bool_constant<std::is_trivially_copyable<T>::value> 
+{};
+
+/**
+ * END: is_trivially_relocatable -*---------------------------------------------
+ */
+
 namespace crim {
     /**
      * @brief   Templated helper type alias for ease of use.
@@ -143,6 +175,9 @@ namespace crim {
      */
     template<class T>
     using remove_reference_t = typename remove_reference<T>::type;
+
+    template<class T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
 }
 
 #ifdef __GNUC__
@@ -3,6 +3,7 @@
 /**
  * Ironic, but I believe most of these are compiler builtins so what can you do? 
  */
+#include <cstdint> /* std::uint64_t */
 #include <type_traits> /* std::is_* family */
 
 #include "type_traits.tcc"
@@ -25,6 +26,8 @@ namespace crim {
 
     template<typename IntT>
     size_t count_digits(IntT value, int base = 10);
+
+    inline size_t count_digits10(std::uint64_t value) noexcept;
 };
 
 // If value is a reference, we can't use decltype(value) 
@@ -88,6 +91,11 @@ template<typename IntT>
 size_t crim::count_digits(IntT value, int base)
 {
     ensure_integral_and_positive(value);
+    if (base == 10) {
+        // Same as the loop below, which says 0 has no digits.
+        std::uint64_t n_value = static_cast<std::uint64_t>(value);
+        return count_digits10(n_value) - (n_value == 0);
+    }
     size_t count{0};
     while (value > 0) {
         value /= base;
@@ -95,3 +103,31 @@ size_t crim::count_digits(IntT value, int base)
     }
     return count;
 }
+
+/**
+ * @brief   How many characters `value` takes when printed in base 10, so 1 for
+ *          0. No loop and no division, which `count_digits` needs for the rest.
+ *
+ * @note    The highest set bit gives a guess that is either right or one too
+ *          many, since every power of 2 lies between 2 powers of 10. 1233/4096
+ *          is just under log10(2). One comparison against the table fixes it.
+ */
+inline size_t crim::count_digits10(std::uint64_t value) noexcept
+{
+    static constexpr std::uint64_t POWERS_OF_10[20] = {
+        0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+        1000000000, 10000000000ull, 100000000000ull, 1000000000000ull,
+        10000000000000ull, 100000000000000ull, 1000000000000000ull,
+        10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+        10000000000000000000ull,
+    };
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long n_highest;
+    _BitScanReverse64(&n_highest, value | 1);
+    size_t n_bits = static_cast<size_t>(n_highest) + 1;
+#else
+    size_t n_bits = 64 - static_cast<size_t>(__builtin_clzll(value | 1));
+#endif
+    size_t n_guess = (n_bits * 1233) >> 12;
+    return n_guess + (value >= POWERS_OF_10[n_guess]);
+}